@@ -15,37 +15,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #include "Huff_Trie.h"
 #include "bit_buffer.h"
 
-/* ------------------------------------ Internal functions ---------------------------------------------- */
-
-/*
- * This function compares two Trie nodes based on their weight. It is designed to be used
- * by the priority queue to order the nodes from the lowest to the highest weight. This ordering
- * is crucial for the construction of the Huffman tree, ensuring that nodes with lower frequencies (weights)
- * are combined earlier, adhering to the Huffman coding algorithm's requirements.
- *
- * @param a A void pointer to the first Trie node to be compared.
- * @param b A void pointer to the second Trie node to be compared.
- * @return An integer less than, equal to, or greater than zero if the first argument is considered
- *         to be respectively less than, equal to, or greater than the second. Specifically:
- *         - Returns a negative value if the weight of the first node is less than the weight of the second.
- *         - Returns zero if the weights are equal.
- *         - Returns a positive value if the weight of the first node is greater than the weight of the second.
- *
- * Note: This function is intended to be used as a callback by the priority queue implementation. Both
- *       parameters are expected to be pointers to Trie nodes, and the function does not perform any
- *       type checking on these inputs. It is the caller's responsibility to ensure that the correct
- *       data types are passed to this function.
- */
-static int compare(void *a, void *b) 
-{
-    Trie *node_a = (Trie *)a;
-    Trie *node_b = (Trie *)b;
-
-    return (node_a->weight > node_b->weight) - (node_a->weight < node_b->weight);
-}
+/* ------------------------------------ External functions ---------------------------------------------- */
 
 Trie *trie_create(int weight, int byte) 
 {
@@ -82,14 +56,41 @@ Trie *trie_combine(Trie *left, Trie *right)
     return parent;
 }
 
-Trie *build_huff_trie(int *frequency_table)
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+/*
+ * Builds the Huffman tree from the symbols of a frequency table. Symbols that never occur are left
+ * out unless include_unused is set.
+ */
+static Trie *build_trie(int *frequency_table, bool include_unused)
 {
-    pqueue *pq = pqueue_empty(compare); 
+    // Without a compare function the queue orders by the weights given as keys, without a call per comparison
+    pqueue *pq = pqueue_empty(NULL);
+    int num_symbols = 0;
 
     for (int i = 0; i < 256; i++) {
+        if (frequency_table[i] == 0 && !include_unused) {
+            continue;
+        }
         Trie *node = trie_create(frequency_table[i], i);
     
-        pqueue_insert(pq, node);
+        pqueue_insert_key(pq, node->weight, node);
+        num_symbols++;
+    }
+
+    // A lone symbol still needs a code of one bit, so it gets a parent with a single child
+    if (num_symbols == 1) {
+        Trie *leaf = pqueue_inspect_first(pq);
+        pqueue_delete_first(pq);
+        pqueue_kill(pq);
+
+        Trie *root = trie_create(leaf->weight, -1);
+        if (root == NULL) {
+            trie_kill(leaf);
+            return NULL;
+        }
+        root->left_child = leaf;
+        return root;
     }
 
     while (!pqueue_is_empty(pq)){
@@ -106,12 +107,116 @@ Trie *build_huff_trie(int *frequency_table)
 
         Trie *P_node = trie_combine(A_node, B_node);
 
-        pqueue_insert(pq, P_node);
+        pqueue_insert_key(pq, P_node->weight, P_node);
     }
     pqueue_kill(pq);
     return NULL;
 }
 
+/*
+ * Stores the depth of every leaf below node.
+ */
+static void leaf_depths(const Trie *node, int depth, uint8_t *code_length)
+{
+    if (node->left_child == NULL && node->right_child == NULL) {
+        code_length[node->byte] = (uint8_t)depth;
+        return;
+    }
+    if (node->left_child != NULL) {
+        leaf_depths(node->left_child, depth + 1, code_length);
+    }
+    if (node->right_child != NULL) {
+        leaf_depths(node->right_child, depth + 1, code_length);
+    }
+}
+
+/*
+ * Adds a leaf for byte at the end of a path of length bits, most significant bit first, creating the
+ * inner nodes on the way.
+ *
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+static int insert_code(Trie *root, uint64_t code, int length, int byte)
+{
+    Trie *node = root;
+
+    for (int i = length - 1; i >= 0; i--) {
+        Trie **child = (code >> i) & 1 ? &node->right_child : &node->left_child;
+        if (*child == NULL) {
+            *child = trie_create(0, i == 0 ? byte : -1);
+            if (*child == NULL) {
+                return -1;
+            }
+        }
+        node = *child;
+    }
+    return 0;
+}
+
+/* ------------------------------------ External functions ---------------------------------------------- */
+
+Trie *build_huff_trie(int *frequency_table)
+{
+    return build_trie(frequency_table, false);
+}
+
+Trie *build_legacy_huff_trie(int *frequency_table)
+{
+    return build_trie(frequency_table, true);
+}
+
+void trie_code_lengths(const Trie *root, uint8_t *code_length)
+{
+    memset(code_length, 0, 256);
+    if (root != NULL) {
+        leaf_depths(root, 0, code_length);
+    }
+}
+
+bool canonical_lengths_valid(const uint8_t *code_length)
+{
+    // Each code of length n takes 2^(32 - n) of the 2^32 places at depth 32
+    uint64_t used = 0;
+    bool any = false;
+
+    for (int i = 0; i < 256; i++) {
+        if (code_length[i] > TRIE_MAX_CANONICAL_LENGTH) {
+            return false;
+        }
+        if (code_length[i] > 0) {
+            used += (uint64_t)1 << (TRIE_MAX_CANONICAL_LENGTH - code_length[i]);
+            any = true;
+        }
+    }
+    return any && used <= (uint64_t)1 << TRIE_MAX_CANONICAL_LENGTH;
+}
+
+Trie *build_canonical_huff_trie(const uint8_t *code_length)
+{
+    Trie *root = trie_create(0, -1);
+    uint64_t code = 0;
+    int previous_length = 0;
+
+    if (root == NULL) {
+        return NULL;
+    }
+    for (int length = 1; length <= TRIE_MAX_CANONICAL_LENGTH; length++) {
+        for (int i = 0; i < 256; i++) {
+            if (code_length[i] != length) {
+                continue;
+            }
+            code <<= length - previous_length;
+            previous_length = length;
+            if (insert_code(root, code, length, i) != 0) {
+                trie_kill(root);
+                return NULL;
+            }
+            code++;
+        }
+    }
+    return root;
+}
+
 void trie_kill(Trie *trie) 
 {
     if (trie != NULL) {
@@ -19,9 +19,12 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "pqueue.h"
 #include "bit_buffer.h"
 
+#define TRIE_MAX_CANONICAL_LENGTH 32  ///< The longest code of a canonical tree. A tree built from 64 KiB has codes of at most 24 bits.
+
 /**
  * @brief Structure representing a node in the Huffman tree.
  * 
@@ -70,14 +73,66 @@ Trie *trie_combine(Trie *left, Trie *right);
  * Constructs the Huffman tree using a frequency table of characters. The tree is built by 
  * creating leaf nodes for each character and combining the nodes with the lowest frequencies
  * until only one node remains - the root of the Huffman tree.
+ *
+ * Only characters with a frequency above zero get a leaf, so the codes are as short as the real
+ * alphabet allows. If only one character occurs, the root is an internal node with that leaf as its
+ * only (left) child, which gives the character the one-bit code "0". If no character occurs, there
+ * is no tree and NULL is returned.
  * 
  * @warning Memory allocation: It's the caller's responsibility to free allocated memory.
  *
  * @param frequency_table Array of 256 integers representing the frequency of each byte/character.
- * @return Pointer to the root of the constructed Huffman tree.
+ * @return Pointer to the root of the constructed Huffman tree, or NULL if the table is empty.
  */
 Trie *build_huff_trie(int *frequency_table);
 
+/**
+ * @brief Builds the Huffman tree the way format versions 1 and 2 did.
+ *
+ * Like build_huff_trie(), but every one of the 256 characters gets a leaf, also the ones with a
+ * frequency of zero. Files written by older versions can only be decoded with this tree.
+ *
+ * @warning Memory allocation: It's the caller's responsibility to free allocated memory.
+ *
+ * @param frequency_table Array of 256 integers representing the frequency of each byte/character.
+ * @return Pointer to the root of the constructed Huffman tree.
+ */
+Trie *build_legacy_huff_trie(int *frequency_table);
+
+/**
+ * @brief Stores the code length of every character in a Huffman tree.
+ *
+ * @param root Pointer to the root of the tree. May be NULL for an empty tree.
+ * @param code_length Array of 256 lengths where the depth of each character's leaf is stored, 0 for
+ *        characters that have no leaf.
+ */
+void trie_code_lengths(const Trie *root, uint8_t *code_length);
+
+/**
+ * @brief Checks that code lengths describe a prefix code that build_canonical_huff_trie() can build.
+ *
+ * At least one character must have a code, no code may be longer than TRIE_MAX_CANONICAL_LENGTH,
+ * and the codes must fit in a binary tree (the Kraft sum is at most 1). The codes do not have to
+ * fill the tree.
+ *
+ * @param code_length Array of 256 code lengths, 0 for characters without a code.
+ * @return true if the lengths are valid.
+ */
+bool canonical_lengths_valid(const uint8_t *code_length);
+
+/**
+ * @brief Builds the canonical Huffman tree for a set of code lengths.
+ *
+ * The codes are handed out in order of length and, within a length, of character, so the lengths
+ * alone describe the tree. This is how a block carries its own tree in a few bytes.
+ *
+ * @warning Memory allocation: It's the caller's responsibility to free allocated memory.
+ *
+ * @param code_length Array of 256 code lengths, checked with canonical_lengths_valid().
+ * @return Pointer to the root of the tree, or NULL if memory allocation fails.
+ */
+Trie *build_canonical_huff_trie(const uint8_t *code_length);
+
 /**
  * @brief Recursively frees memory allocated for the Huffman tree.
  * 
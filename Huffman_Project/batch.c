@@ -0,0 +1,514 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         batch.c
+ * Description:  Encodes or decodes a whole directory or manifest of files in one process. The files are
+ *               handed out one at a time to a fixed pool of worker threads which share the code tables and
+ *               keep their own bit buffer and stdio buffers between files.
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "batch.h"
+#include "bit_buffer.h"
+#include "encode_decode.h"
+
+#define STDIO_BUFFER_SIZE (64 * 1024)
+
+/*
+ * One file in the batch.
+ *
+ * @elem in_path   Path to the input file.
+ * @elem out_path  Path to the output file.
+ * @elem stats     Byte counts of the file, filled in by the worker.
+ * @elem result    0 if the file was processed successfully.
+ * @elem duplicate True if another job has the same output path, or the output path is the input of
+ *                 a job. Such jobs are not run at all.
+ */
+typedef struct batch_job {
+    char *in_path;
+    char *out_path;
+    codec_stats stats;
+    int result;
+    bool duplicate;
+} batch_job;
+
+/*
+ * State shared by all workers. next_job is the index of the next job to hand out and is
+ * protected by job_mut.
+ */
+typedef struct batch_pool {
+    batch_job *jobs;
+    int num_jobs;
+    int next_job;
+    bool encode;
+    const huff_codec *codec;
+    pthread_mutex_t job_mut;
+} batch_pool;
+
+/*
+ * An input file by its device and inode, so that differently spelled paths to it compare equal.
+ */
+typedef struct file_id {
+    dev_t dev;
+    ino_t ino;
+    const batch_job *job;
+} file_id;
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+/*
+ * Appends a path to a growing array of paths.
+ *
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+static int add_path(char ***paths, int *count, int *capacity, const char *path)
+{
+    if (*count == *capacity) {
+        int new_capacity = *capacity == 0 ? 64 : *capacity * 2;
+        char **grown = realloc(*paths, new_capacity * sizeof(char *));
+        if (grown == NULL) {
+            return -1;
+        }
+        *paths = grown;
+        *capacity = new_capacity;
+    }
+
+    (*paths)[*count] = strdup(path);
+    if ((*paths)[*count] == NULL) {
+        return -1;
+    }
+    (*count)++;
+    return 0;
+}
+
+static int compare_paths(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/*
+ * Collects the input paths of the batch. A directory contributes all its regular files, sorted by
+ * name; any other file is read as a manifest with one path per line. Empty lines are skipped.
+ *
+ * @return The array of paths, or NULL on failure. The number of paths is stored in count.
+ */
+static char **collect_inputs(const char *source, int *count)
+{
+    char **paths = NULL;
+    int capacity = 0;
+    struct stat s;
+
+    *count = 0;
+    if (stat(source, &s) != 0) {
+        perror(source);
+        return NULL;
+    }
+
+    if (S_ISDIR(s.st_mode)) {
+        if (batch_list_directory(source, &paths, count, &capacity) != 0) {
+            for (int i = 0; i < *count; i++) {
+                free(paths[i]);
+            }
+            free(paths);
+            return NULL;
+        }
+    } else {
+        FILE *manifest = fopen(source, "r");
+        if (manifest == NULL) {
+            perror(source);
+            return NULL;
+        }
+
+        char *line = NULL;
+        size_t line_capacity = 0;
+        ssize_t length;
+        bool failed = false;
+        while (!failed && (length = getline(&line, &line_capacity, manifest)) != -1) {
+            while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+                line[--length] = '\0';
+            }
+            if (length > 0 && add_path(&paths, count, &capacity, line) != 0) {
+                fprintf(stderr, "Failed to allocate memory for the paths in %s\n", source);
+                failed = true;
+            }
+        }
+        if (!failed && ferror(manifest)) {
+            perror(source);
+            failed = true;
+        }
+        free(line);
+        fclose(manifest);
+
+        // A batch of only part of the manifest would look like a complete one
+        if (failed) {
+            for (int i = 0; i < *count; i++) {
+                free(paths[i]);
+            }
+            free(paths);
+            return NULL;
+        }
+    }
+
+    if (*count == 0) {
+        fprintf(stderr, "No input files found in %s\n", source);
+        free(paths);
+        return NULL;
+    }
+    return paths;
+}
+
+/*
+ * Builds the output path of an input file: the file name of the input placed in out_dir, with ".huf"
+ * appended when encoding and removed when decoding.
+ */
+static char *make_out_path(const char *in_path, const char *out_dir, bool encode)
+{
+    const char *name = strrchr(in_path, '/');
+    name = name == NULL ? in_path : name + 1;
+
+    size_t name_length = strlen(name);
+    const char *suffix = encode ? ".huf" : ".out";
+    if (!encode && name_length > 4 && strcmp(name + name_length - 4, ".huf") == 0) {
+        name_length -= 4;
+        suffix = "";
+    }
+
+    size_t length = strlen(out_dir) + name_length + strlen(suffix) + 2;
+    char *out_path = malloc(length);
+    if (out_path != NULL) {
+        snprintf(out_path, length, "%s/%.*s%s", out_dir, (int)name_length, name, suffix);
+    }
+    return out_path;
+}
+
+static int compare_out_paths(const void *a, const void *b)
+{
+    return strcmp((*(batch_job * const *)a)->out_path, (*(batch_job * const *)b)->out_path);
+}
+
+/*
+ * Marks the jobs whose output path is shared with another job, since the workers would write the
+ * same file at the same time. Inputs with the same file name in different directories, or an input
+ * listed twice, end up like this. None of the jobs sharing a path is run, as no one of them is more
+ * right than the others.
+ *
+ * @return The number of jobs marked, or -1 if memory allocation fails.
+ */
+static int mark_duplicate_outputs(batch_job *jobs, int num_jobs)
+{
+    batch_job **sorted = malloc(num_jobs * sizeof(batch_job *));
+    if (sorted == NULL) {
+        return -1;
+    }
+
+    int num_sorted = 0;
+    for (int i = 0; i < num_jobs; i++) {
+        if (jobs[i].out_path != NULL) {
+            sorted[num_sorted++] = &jobs[i];
+        }
+    }
+    qsort(sorted, num_sorted, sizeof(batch_job *), compare_out_paths);
+
+    int marked = 0;
+    for (int i = 0; i < num_sorted; ) {
+        int end = i + 1;
+        while (end < num_sorted && strcmp(sorted[end]->out_path, sorted[i]->out_path) == 0) {
+            end++;
+        }
+        for (int j = i; end - i > 1 && j < end; j++) {
+            fprintf(stderr, "%s: output %s is shared with %s, not written\n", sorted[j]->in_path,
+                    sorted[j]->out_path, sorted[j == i ? i + 1 : i]->in_path);
+            sorted[j]->duplicate = true;
+            marked++;
+        }
+        i = end;
+    }
+    free(sorted);
+    return marked;
+}
+
+static int compare_file_ids(const void *a, const void *b)
+{
+    const file_id *x = a;
+    const file_id *y = b;
+    if (x->dev != y->dev) {
+        return x->dev < y->dev ? -1 : 1;
+    }
+    return (x->ino > y->ino) - (x->ino < y->ino);
+}
+
+/*
+ * Marks the jobs whose output file is the input of a job, as when the output directory is the
+ * source directory and holds both x.txt and x.txt.huf. Writing the output would destroy an input
+ * that may still be read. Outputs that do not exist yet cannot be inputs, so only existing ones
+ * are compared, by file and not by path.
+ *
+ * @return The number of jobs marked, or -1 if memory allocation fails.
+ */
+static int mark_outputs_that_are_inputs(batch_job *jobs, int num_jobs)
+{
+    file_id *inputs = malloc(num_jobs * sizeof(file_id));
+    if (inputs == NULL) {
+        return -1;
+    }
+
+    int num_inputs = 0;
+    struct stat s;
+    for (int i = 0; i < num_jobs; i++) {
+        if (stat(jobs[i].in_path, &s) == 0) {
+            inputs[num_inputs++] = (file_id){s.st_dev, s.st_ino, &jobs[i]};
+        }
+    }
+    qsort(inputs, num_inputs, sizeof(file_id), compare_file_ids);
+
+    int marked = 0;
+    for (int i = 0; i < num_jobs; i++) {
+        if (jobs[i].out_path == NULL || jobs[i].duplicate || stat(jobs[i].out_path, &s) != 0) {
+            continue;
+        }
+        file_id key = {s.st_dev, s.st_ino, NULL};
+        file_id *input = bsearch(&key, inputs, num_inputs, sizeof(file_id), compare_file_ids);
+        if (input != NULL) {
+            fprintf(stderr, "%s: output %s is the input %s, not written\n", jobs[i].in_path, jobs[i].out_path,
+                    input->job->in_path);
+            jobs[i].duplicate = true;
+            marked++;
+        }
+    }
+    free(inputs);
+    return marked;
+}
+
+/*
+ * Processes one job with the worker's own buffers.
+ */
+static int run_job(batch_pool *pool, batch_job *job, bit_buffer *buffer, char *in_buf, char *out_buf)
+{
+    if (job->duplicate) {
+        return 1;  // Reported before the workers started
+    }
+    if (job->out_path == NULL) {
+        fprintf(stderr, "Failed to allocate memory for output path of %s\n", job->in_path);
+        return 1;
+    }
+
+    FILE *input = fopen(job->in_path, "rb");
+    if (input == NULL) {
+        perror(job->in_path);
+        return 1;
+    }
+
+    FILE *output = fopen(job->out_path, "wb");
+    if (output == NULL) {
+        perror(job->out_path);
+        fclose(input);
+        return 1;
+    }
+
+    setvbuf(input, in_buf, _IOFBF, STDIO_BUFFER_SIZE);
+    setvbuf(output, out_buf, _IOFBF, STDIO_BUFFER_SIZE);
+
+    int result;
+    bool reported = false;
+    if (pool->encode) {
+        result = encode_stream(input, output, pool->codec, buffer, &job->stats);
+    } else {
+        decode_status status = decode_stream(input, output, pool->codec, &job->stats);
+        if (status != DECODE_OK && status != DECODE_IO_ERROR) {
+            fprintf(stderr, "%s: %s\n", job->in_path, decode_status_message(status));
+            reported = true;
+        }
+        result = status == DECODE_OK ? 0 : -1;
+    }
+
+    // Close before the stdio buffers are handed to the next file
+    fclose(input);
+    if (fclose(output) != 0) {
+        result = -1;
+    }
+
+    if (result != 0) {
+        if (reported) {
+            return 1;
+        }
+        fprintf(stderr, "Failed to %s %s\n", pool->encode ? "encode" : "decode", job->in_path);
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Worker thread: takes jobs until there are none left.
+ */
+static void *batch_worker(void *args)
+{
+    batch_pool *pool = args;
+    bit_buffer *buffer = bit_buffer_empty();
+    char *in_buf = malloc(STDIO_BUFFER_SIZE);
+    char *out_buf = malloc(STDIO_BUFFER_SIZE);
+
+    if (in_buf == NULL || out_buf == NULL) {
+        fprintf(stderr, "Failed to allocate memory for worker buffers\n");
+        free(in_buf);
+        free(out_buf);
+        bit_buffer_free(buffer);
+        return NULL;
+    }
+
+    while (true) {
+        pthread_mutex_lock(&pool->job_mut);
+        int index = pool->next_job++;
+        pthread_mutex_unlock(&pool->job_mut);
+
+        if (index >= pool->num_jobs) {
+            break;
+        }
+        pool->jobs[index].result = run_job(pool, &pool->jobs[index], buffer, in_buf, out_buf);
+    }
+
+    free(in_buf);
+    free(out_buf);
+    bit_buffer_free(buffer);
+    return NULL;
+}
+
+/* ------------------------------------ External functions ---------------------------------------------- */
+
+int batch_list_directory(const char *dir_path, char ***paths, int *count, int *capacity)
+{
+    struct stat s;
+    int first = *count;
+    int result = 0;
+
+    DIR *dir = opendir(dir_path);
+    if (dir == NULL) {
+        perror(dir_path);
+        return -1;
+    }
+
+    struct dirent *entry;
+    while (result == 0 && (entry = readdir(dir)) != NULL) {
+        size_t length = strlen(dir_path) + strlen(entry->d_name) + 2;
+        char *path = malloc(length);
+        if (path == NULL) {
+            result = -1;
+            break;
+        }
+        snprintf(path, length, "%s/%s", dir_path, entry->d_name);
+
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            // Not entries of the directory itself
+        } else if (stat(path, &s) != 0) {
+            perror(path);
+        } else if (S_ISREG(s.st_mode)) {
+            result = add_path(paths, count, capacity, path);
+        } else {
+            fprintf(stderr, "%s: %s, skipped\n", path, S_ISDIR(s.st_mode) ? "directory" : "not a regular file");
+        }
+        free(path);
+    }
+    closedir(dir);
+    if (*count > first) {
+        qsort(*paths + first, *count - first, sizeof(char *), compare_paths);
+    }
+    return result;
+}
+
+int batch_run(bool encode, const char *source, const char *out_dir, int num_workers, const huff_codec *codec)
+{
+    int num_paths;
+    char **paths = collect_inputs(source, &num_paths);
+    if (paths == NULL) {
+        return 1;
+    }
+
+    batch_pool pool = {
+        .jobs = calloc(num_paths, sizeof(batch_job)),
+        .num_jobs = num_paths,
+        .next_job = 0,
+        .encode = encode,
+        .codec = codec,
+    };
+    if (pool.jobs == NULL) {
+        fprintf(stderr, "Failed to allocate memory for batch jobs\n");
+        for (int i = 0; i < num_paths; i++) {
+            free(paths[i]);
+        }
+        free(paths);
+        return 1;
+    }
+
+    for (int i = 0; i < num_paths; i++) {
+        pool.jobs[i].in_path = paths[i];
+        pool.jobs[i].out_path = make_out_path(paths[i], out_dir, encode);
+        pool.jobs[i].result = 1;  // Stays failed unless a worker gets to it
+    }
+    free(paths);
+    if (mark_duplicate_outputs(pool.jobs, pool.num_jobs) < 0 ||
+        mark_outputs_that_are_inputs(pool.jobs, pool.num_jobs) < 0) {
+        fprintf(stderr, "Failed to allocate memory for checking the output paths\n");
+        for (int i = 0; i < pool.num_jobs; i++) {
+            free(pool.jobs[i].in_path);
+            free(pool.jobs[i].out_path);
+        }
+        free(pool.jobs);
+        return 1;
+    }
+    pthread_mutex_init(&pool.job_mut, NULL);
+
+    if (num_workers > num_paths) {
+        num_workers = num_paths;
+    }
+    pthread_t *workers = malloc(num_workers * sizeof(pthread_t));
+    int started = 0;
+    if (workers != NULL) {
+        for (; started < num_workers; started++) {
+            if (pthread_create(&workers[started], NULL, batch_worker, &pool) != 0) {
+                break;
+            }
+        }
+    }
+    if (started == 0) {
+        // No threads could be started, do the work in this thread instead
+        batch_worker(&pool);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    free(workers);
+    pthread_mutex_destroy(&pool.job_mut);
+
+    // Sum up the statistics of all files
+    long long total_in = 0;
+    long long total_out = 0;
+    int failed = 0;
+    for (int i = 0; i < pool.num_jobs; i++) {
+        if (pool.jobs[i].result != 0) {
+            failed++;
+        } else {
+            total_in += pool.jobs[i].stats.bytes_in;
+            total_out += pool.jobs[i].stats.bytes_out;
+        }
+        free(pool.jobs[i].in_path);
+        free(pool.jobs[i].out_path);
+    }
+    free(pool.jobs);
+
+    printf("\n%d files %s with %d workers, %d failed.\n", pool.num_jobs - failed,
+           encode ? "encoded" : "decoded", started == 0 ? 1 : started, failed);
+    printf("%lld bytes read, %lld bytes written.\n\n", total_in, total_out);
+
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+/**
+ * @defgroup Batch
+ * @brief Encoding or decoding many files in one process on a fixed pool of worker threads.
+ *
+ * Batch mode takes either a directory, whose regular files are all processed, or a manifest file
+ * listing one path per line. The code tables are built once and shared by all workers, and each
+ * worker reuses its own bit buffer and stdio buffers for every file it processes. The byte counts
+ * of all files are summed and printed when the batch is done.
+ *
+ * Encoded files are written to the output directory as the input file name with ".huf" appended.
+ * Decoded files get the ".huf" suffix removed, or ".out" appended if there is no such suffix.
+ * Inputs that would get the same output path, like a/x.txt and b/x.txt in one manifest, are
+ * reported as failed and none of them is written. So is an input whose output would overwrite
+ * another input, like x.txt when x.txt.huf is encoded in the same batch into its own directory.
+ *
+ * @section Author
+ *  - Author: Abdiaziz Ibrahim Adam
+ * @since Datum
+ *  - 18 October 2026
+ * @{
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdbool.h>
+#include "encode_decode.h"
+
+/**
+ * @brief Appends the paths of all regular files in a directory, sorted by name, to an array of paths.
+ *
+ * Subdirectories are not descended into, and they and any other entries that are not regular files
+ * are reported as skipped.
+ *
+ * @warning Memory allocation: It's the caller's responsibility to free the paths and the array.
+ *
+ * @param dir_path Path to the directory.
+ * @param paths Pointer to the array of paths, NULL for an empty array. It is grown as needed.
+ * @param count Pointer to the number of paths in the array.
+ * @param capacity Pointer to the number of paths the array has room for.
+ * @return 0 on success, -1 if the directory could not be read or memory allocation failed. The paths
+ *         added before a failure stay in the array.
+ */
+int batch_list_directory(const char *dir_path, char ***paths, int *count, int *capacity);
+
+/**
+ * @brief Encodes or decodes all files named by a directory or manifest.
+ *
+ * @param encode True to encode the files, false to decode them.
+ * @param source Path to a directory or to a manifest file with one input path per line.
+ * @param out_dir Path to an existing directory where the results are written.
+ * @param num_workers The number of worker threads. Fewer are started if there are fewer files.
+ * @param codec The codec shared by all workers.
+ * @return 0 if every file was processed successfully, otherwise 1.
+ */
+int batch_run(bool encode, const char *source, const char *out_dir, int num_workers, const huff_codec *codec);
+
+#endif /* BATCH_H */
+
+/** @} */
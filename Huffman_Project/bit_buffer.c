@@ -30,6 +30,7 @@
 
 #include "bit_buffer.h"
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 /* A structure used to handle the resources connected to the bit
@@ -44,6 +45,9 @@
  *                      the array.
  * @elem next_remove    A "pointer" (the index of the bit) to the bit
  *                      that is next to be removed from the array.
+ * @elem view           True if the array belongs to the caller, see
+ *                      bit_buffer_view(). The array of a view is never
+ *                      written or freed.
  */
 struct bit_buffer {
 	int capacity;
@@ -51,6 +55,7 @@ struct bit_buffer {
 	int size;
 	int next_insert;
 	int next_remove;
+	bool view;
 };
 
 
@@ -60,6 +65,10 @@ static int bit_buffer_get_bit_value(const bit_buffer *const b,
 static void bit_buffer_set_bit_value(bit_buffer *b,
                                      const int bit_in_array,
                                      const int value);
+static unsigned char bit_buffer_peek_byte(const bit_buffer *const b,
+                                          const int bit_no);
+static void bit_buffer_copy_out(const bit_buffer *const b, char *out);
+static void bit_buffer_reserve(bit_buffer *b, const int bits);
 
 
 /* ---------------------- External functions ---------------------- */
@@ -69,14 +78,36 @@ bit_buffer *bit_buffer_copy(const bit_buffer *const b)
 	assert(b);
 	assert(b->array);
 	bit_buffer *res = bit_buffer_empty();
-	for (int i = 0 ; i < bit_buffer_size(b) ; i++) {
-		bit_buffer_insert_bit(res, bit_buffer_inspect_bit(b, i));
-	}
+	bit_buffer_reserve(res, b->size);
+	bit_buffer_copy_out(b, res->array);
+	res->size = b->size;
+	res->next_insert = b->size;
 
 	return res;
 }
 
 
+bit_buffer *bit_buffer_view(const char *const byte_array,
+                            const int bit_offset,
+                            const int size)
+{
+	assert(byte_array);
+	assert(bit_offset >= 0 && size >= 0);
+	bit_buffer *b = malloc(sizeof(*b));
+	assert(b);
+
+	int bytes = (bit_offset + size + 7) / 8;
+	b->capacity = bytes > 0 ? bytes * 8 : 8;
+	b->array = (char *)byte_array;
+	b->size = size;
+	b->next_remove = bit_offset;
+	b->next_insert = (bit_offset + size) % b->capacity;
+	b->view = true;
+
+	return b;
+}
+
+
 bit_buffer *bit_buffer_create(const char *const byte_array,
                               const int size)
 {
@@ -95,6 +126,47 @@ bit_buffer *bit_buffer_create(const char *const byte_array,
 }
 
 
+void bit_buffer_append(bit_buffer *b, const bit_buffer *const src)
+{
+	assert(b);
+	assert(src);
+	assert(!b->view);
+	assert(b != src);
+	int bytes = (src->size + 7) / 8;
+	bit_buffer_reserve(b, b->size + src->size);
+
+	/* The bits after next_insert are zero and the data does not
+	   wrap, so whole bytes of src can be shifted into place */
+	unsigned char *out = (unsigned char *)b->array + b->next_insert / 8;
+	int shift = b->next_insert % 8;
+	if (shift == 0) {
+		bit_buffer_copy_out(src, (char *)out);
+	}
+	else {
+		for (int i = 0 ; i < bytes ; i++) {
+			unsigned char value = bit_buffer_peek_byte(src, i * 8);
+			out[i] = (out[i] & ~(0xff >> shift)) | (value >> shift);
+			out[i + 1] = (unsigned char)(value << (8 - shift));
+		}
+	}
+
+	b->next_insert += src->size;
+	b->size += src->size;
+}
+
+
+void bit_buffer_append_bytes(bit_buffer *b, const char *const byte_array,
+                             const int size)
+{
+	assert(b);
+	struct bit_buffer src = {size > 0 ? size * 8 : 8,
+	                         (char *)byte_array, size * 8, 0, 0, true};
+	if (size > 0) {
+		bit_buffer_append(b, &src);
+	}
+}
+
+
 bit_buffer *bit_buffer_empty()
 {
 	bit_buffer *b = malloc(sizeof(*b));
@@ -106,6 +178,7 @@ bit_buffer *bit_buffer_empty()
 	b->size = 0;
 	b->next_insert = 0;
 	b->next_remove = 0;
+	b->view = false;
 
 	return b;
 }
@@ -115,15 +188,34 @@ void bit_buffer_free(bit_buffer *b)
 {
 	assert(b);
 	assert(b->array);
-	free(b->array);
+	if (!b->view) {
+		free(b->array);
+	}
 	free(b);
 }
 
 
+void bit_buffer_clear(bit_buffer *b)
+{
+	assert(b);
+	assert(b->array);
+	if (b->view) {
+		b->size = 0;
+		b->next_remove = b->next_insert;
+		return;
+	}
+	memset(b->array, 0, b->capacity / 8);
+	b->size = 0;
+	b->next_insert = 0;
+	b->next_remove = 0;
+}
+
+
 void bit_buffer_insert_bit(bit_buffer *b, const int value)
 {
 	assert(b);
 	assert(b->array);
+	assert(!b->view);
 
 	/* Extend the capacity of the buffer if needed */
 	if (bit_buffer_size(b) + 1 == b->capacity) {
@@ -182,7 +274,9 @@ int bit_buffer_remove_bit(bit_buffer *b)
 	assert(b->array);
 	assert(b->size > 0);
 	int value = bit_buffer_get_bit_value(b, b->next_remove);
-	bit_buffer_set_bit_value(b, b->next_remove, false);
+	if (!b->view) {
+		bit_buffer_set_bit_value(b, b->next_remove, false);
+	}
 	b->next_remove = (b->next_remove + 1) % b->capacity;
 	b->size--;
 
@@ -219,15 +313,24 @@ char *bit_buffer_to_byte_array(const bit_buffer *const b)
 {
 	assert(b);
 	assert(b->array);
-	char *res = calloc(b->capacity / 8, sizeof(char));
-	for (int i = 0 ; i < b->capacity / 8 ; i++) {
-		res[i] = b->array[i];
-	}
+	char *res = calloc(b->size / 8 + 1, sizeof(char));
+	assert(res);
+	bit_buffer_copy_out(b, res);
 
 	return res;
 }
 
 
+int bit_buffer_copy_to(const bit_buffer *const b, char *byte_array)
+{
+	assert(b);
+	assert(b->array);
+	bit_buffer_copy_out(b, byte_array);
+
+	return (b->size + 7) / 8;
+}
+
+
 
 /* ---- External functions used for debugging - Not part of API --- */
 
@@ -337,3 +440,98 @@ static void bit_buffer_set_bit_value(bit_buffer *b,
 	/* Copy the updated byte to the buffer */
 	b->array[byte_no] = the_byte;
 }
+
+
+/*
+ * @brief               Returns the 8 bits starting at bit_no, the
+ *                      first one as the most significant bit. Bits
+ *                      past the end of the buffer are 0.
+ *
+ * @param b             The bit buffer.
+ * @param bit_no        The number of the first bit, as in
+ *                      bit_buffer_inspect_bit().
+ * @return              The bits.
+ */
+static unsigned char bit_buffer_peek_byte(const bit_buffer *const b,
+                                          const int bit_no)
+{
+	int first = (bit_no + b->next_remove) % b->capacity;
+	int byte_no = first / 8;
+	int shift = first % 8;
+	unsigned int value = (unsigned char)b->array[byte_no] << 8;
+
+	/* The next byte may be at the start of a circular buffer */
+	if (shift != 0) {
+		value |= (unsigned char)b->array[(byte_no + 1) % (b->capacity / 8)];
+	}
+	unsigned char the_byte = (unsigned char)((value << shift) >> 8);
+
+	int left = b->size - bit_no;
+	if (left < 8) {
+		the_byte &= (unsigned char)(0xff << (8 - left));
+	}
+
+	return the_byte;
+}
+
+
+/*
+ * @brief               Copies the bits of the buffer to (size + 7) / 8
+ *                      bytes, padding the last byte with bits of value
+ *                      0. Byte aligned buffers are copied with memcpy.
+ *
+ * @param b             The bit buffer.
+ * @param out           The array to copy to.
+ * @return              -
+ */
+static void bit_buffer_copy_out(const bit_buffer *const b, char *out)
+{
+	int bytes = (b->size + 7) / 8;
+
+	if (b->next_remove % 8 == 0 &&
+	    b->next_remove + b->size <= b->capacity) {
+		memcpy(out, b->array + b->next_remove / 8, bytes);
+		if (b->size % 8 != 0) {
+			out[bytes - 1] &= (char)(0xff << (8 - b->size % 8));
+		}
+		return;
+	}
+	for (int i = 0 ; i < bytes ; i++) {
+		out[i] = (char)bit_buffer_peek_byte(b, i * 8);
+	}
+}
+
+
+/*
+ * @brief               Makes room for bits bits without wrapping. If
+ *                      needed the array is replaced by a larger one,
+ *                      at least twice the size, holding the bits from
+ *                      its start. The bits after next_insert are 0.
+ *
+ * @param b             The bit buffer. Must not be a view.
+ * @param bits          The number of bits the buffer must hold.
+ * @return              -
+ */
+static void bit_buffer_reserve(bit_buffer *b, const int bits)
+{
+	/* Room for bits and a spare byte, so that insert_bit never has
+	   to grow a buffer whose data ends in the last byte */
+	if (b->next_remove <= b->next_insert &&
+	    b->next_remove + bits + 16 <= b->capacity) {
+		return;
+	}
+
+	int bytes = bits / 8 + 3;
+	if (bytes < b->capacity / 4) {
+		bytes = b->capacity / 4;
+	}
+	char *array = calloc(bytes, sizeof(char));
+	assert(array);
+	bit_buffer_copy_out(b, array);
+	free(b->array);
+
+	b->array = array;
+	b->capacity = bytes * 8;
+	b->next_remove = 0;
+	b->next_insert = b->size;
+}
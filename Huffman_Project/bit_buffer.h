@@ -62,6 +62,51 @@ bit_buffer *bit_buffer_copy(const bit_buffer *const b);
 bit_buffer *bit_buffer_create(const char *const byte_array,
                               const int size);
 
+/**
+ * @brief             Creates a bit buffer that reads the bits of an
+ *                    existing byte array without copying them, for
+ *                    example a memory mapped file. Bits are numbered
+ *                    from the most significant bit of the first byte.
+ *                    The view can be inspected, removed from, copied
+ *                    and appended to other buffers, but not inserted
+ *                    into. The array must stay valid while the view
+ *                    is used and is not freed by bit_buffer_free().
+ *
+ * @param byte_array  The bytes to read.
+ * @param bit_offset  The number of the first bit of the view.
+ * @param size        The number of bits in the view.
+ * @return            The new allocated bit buffer.
+ */
+bit_buffer *bit_buffer_view(const char *const byte_array,
+                            const int bit_offset,
+                            const int size);
+
+/**
+ * @brief             Appends all bits of src to the bit buffer b.
+ *                    Whole bytes are copied at a time, with memcpy
+ *                    when both buffers are byte aligned, so the cost
+ *                    grows with the number of bytes, not bits. The
+ *                    size of b is increased if needed.
+ *
+ * @param b           The bit buffer to append to. Must not be a view.
+ * @param src         The bit buffer whose bits are appended. It is
+ *                    not changed, and must not be b.
+ * @return            -
+ */
+void bit_buffer_append(bit_buffer *b, const bit_buffer *const src);
+
+/**
+ * @brief             Appends all bits of a byte array to the bit
+ *                    buffer, as bit_buffer_append() does.
+ *
+ * @param b           The bit buffer. Must not be a view.
+ * @param byte_array  The bytes to append.
+ * @param size        The number of bytes in the byte_array.
+ * @return            -
+ */
+void bit_buffer_append_bytes(bit_buffer *b, const char *const byte_array,
+                             const int size);
+
 /**
  * @brief             Creates a new empty bit buffer. The user is
  *                    responsible for deallocating the new buffer.
@@ -79,6 +124,16 @@ bit_buffer *bit_buffer_empty();
  */
 void bit_buffer_free(bit_buffer *b);
 
+/**
+ * @brief             Removes all bits from the bit buffer. The
+ *                    capacity of the buffer is kept, so the buffer
+ *                    can be reused without growing it again.
+ *
+ * @param b           The bit buffer.
+ * @return            -
+ */
+void bit_buffer_clear(bit_buffer *b);
+
 /**
  * @brief             Insert a bit (the value) into the given bit
  *                    buffer. The size of the buffer is increased if
@@ -160,6 +215,19 @@ int bit_buffer_size(const bit_buffer *const b);
  */
 char *bit_buffer_to_byte_array(const bit_buffer *const b);
 
+/**
+ * @brief             Copies the bits of the bit buffer to a byte
+ *                    array supplied by the user, as
+ *                    bit_buffer_to_byte_array() does but without
+ *                    allocating memory. The buffer is not changed.
+ *
+ * @param b           The bit buffer.
+ * @param byte_array  Array of at least (bit_buffer_size(b) + 7) / 8
+ *                    bytes where the bits are stored.
+ * @return            The number of bytes written.
+ */
+int bit_buffer_copy_to(const bit_buffer *const b, char *byte_array);
+
 /**
  * @}
  */
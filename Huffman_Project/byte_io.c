@@ -0,0 +1,66 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         byte_io.c
+ * Description:  Reads and writes fixed-width little-endian integers, both to files and to byte arrays.
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "byte_io.h"
+
+int write_u32(FILE *file, uint32_t value)
+{
+    unsigned char bytes[4];
+
+    put_u32(bytes, value);
+    return fwrite(bytes, 1, 4, file) == 4 ? 0 : -1;
+}
+
+int read_u32(FILE *file, uint32_t *value)
+{
+    unsigned char bytes[4];
+
+    if (fread(bytes, 1, 4, file) != 4) {
+        return -1;
+    }
+    *value = get_u32(bytes);
+    return 0;
+}
+
+void put_u32(unsigned char *bytes, uint32_t value)
+{
+    bytes[0] = value & 0xFF;
+    bytes[1] = (value >> 8) & 0xFF;
+    bytes[2] = (value >> 16) & 0xFF;
+    bytes[3] = (value >> 24) & 0xFF;
+}
+
+uint32_t get_u32(const unsigned char *bytes)
+{
+    return (uint32_t)bytes[0]
+         | (uint32_t)bytes[1] << 8
+         | (uint32_t)bytes[2] << 16
+         | (uint32_t)bytes[3] << 24;
+}
+
+size_t skip_bytes(FILE *file, size_t count)
+{
+    unsigned char bytes[4096];
+    size_t skipped = 0;
+
+    while (skipped < count) {
+        size_t chunk = count - skipped < sizeof(bytes) ? count - skipped : sizeof(bytes);
+        size_t n = fread(bytes, 1, chunk, file);
+        skipped += n;
+        if (n < chunk) {
+            break;
+        }
+    }
+    return skipped;
+}
@@ -0,0 +1,67 @@
+/**
+ * @defgroup ByteIO
+ * @brief Helpers for reading and writing fixed-width little-endian integers.
+ *
+ * The table files and the compressed file header store their integer fields in little-endian
+ * byte order so that files written on one machine can be read on any other. These helpers
+ * hide the byte shuffling from the rest of the program.
+ *
+ * @section Author
+ *  - Author: Abdiaziz Ibrahim Adam
+ * @since Datum
+ *  - 18 October 2026
+ * @{
+ */
+
+#ifndef BYTE_IO_H
+#define BYTE_IO_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/**
+ * @brief Writes a 32-bit unsigned integer in little-endian byte order.
+ *
+ * @param file Pointer to a FILE structure opened in write mode.
+ * @param value The value to write.
+ * @return 0 on success, -1 if the write failed.
+ */
+int write_u32(FILE *file, uint32_t value);
+
+/**
+ * @brief Reads a 32-bit unsigned integer stored in little-endian byte order.
+ *
+ * @param file Pointer to a FILE structure opened in read mode.
+ * @param value Pointer to where the read value is stored.
+ * @return 0 on success, -1 if the file ended or a read error occurred.
+ */
+int read_u32(FILE *file, uint32_t *value);
+
+/**
+ * @brief Stores a 32-bit unsigned integer in little-endian byte order in a byte array.
+ *
+ * @param bytes Pointer to at least 4 writable bytes.
+ * @param value The value to store.
+ */
+void put_u32(unsigned char *bytes, uint32_t value);
+
+/**
+ * @brief Loads a 32-bit unsigned integer stored in little-endian byte order from a byte array.
+ *
+ * @param bytes Pointer to at least 4 readable bytes.
+ * @return The loaded value.
+ */
+uint32_t get_u32(const unsigned char *bytes);
+
+/**
+ * @brief Reads and discards bytes, also from files that cannot be seeked.
+ *
+ * @param file Pointer to a FILE structure opened in read mode.
+ * @param count The number of bytes to skip.
+ * @return The number of bytes skipped, less than count if the file ended or a read error occurred.
+ */
+size_t skip_bytes(FILE *file, size_t count);
+
+#endif /* BYTE_IO_H */
+
+/** @} */
@@ -0,0 +1,113 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         checksum.c
+ * Description:  Computes CRC32C checksums, with the SSE4.2 crc32 instruction when the processor has it
+ *               and with a slicing-by-8 lookup table otherwise.
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "checksum.h"
+
+#define CRC32C_POLY 0x82F63B78u // The Castagnoli polynomial, bit-reflected
+
+static uint32_t crc_table[8][256];
+static uint32_t (*crc_update)(uint32_t crc, const unsigned char *data, size_t size);
+static pthread_once_t crc_once = PTHREAD_ONCE_INIT;
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+/*
+ * Software CRC32C that consumes 8 bytes per step using 8 lookup tables.
+ */
+static uint32_t crc32c_sw(uint32_t crc, const unsigned char *data, size_t size)
+{
+    while (size >= 8) {
+        uint32_t low = crc ^ ((uint32_t)data[0] | (uint32_t)data[1] << 8 |
+                              (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24);
+        crc = crc_table[7][low & 0xFF] ^ crc_table[6][(low >> 8) & 0xFF] ^
+              crc_table[5][(low >> 16) & 0xFF] ^ crc_table[4][low >> 24] ^
+              crc_table[3][data[4]] ^ crc_table[2][data[5]] ^
+              crc_table[1][data[6]] ^ crc_table[0][data[7]];
+        data += 8;
+        size -= 8;
+    }
+    while (size-- > 0) {
+        crc = crc_table[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+/*
+ * Hardware CRC32C using the SSE4.2 crc32 instruction, 8 bytes at a time.
+ */
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hw(uint32_t crc, const unsigned char *data, size_t size)
+{
+    uint64_t crc64 = crc;
+
+    while (size >= 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        crc64 = __builtin_ia32_crc32di(crc64, word);
+        data += 8;
+        size -= 8;
+    }
+    crc = (uint32_t)crc64;
+    while (size-- > 0) {
+        crc = __builtin_ia32_crc32qi(crc, *data++);
+    }
+    return crc;
+}
+#endif
+
+/*
+ * Builds the lookup tables and picks the fastest implementation. Runs once.
+ */
+static void crc32c_init(void)
+{
+    for (int i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+        }
+        crc_table[0][i] = crc;
+    }
+    for (int i = 0; i < 256; i++) {
+        for (int k = 1; k < 8; k++) {
+            crc_table[k][i] = (crc_table[k - 1][i] >> 8) ^ crc_table[0][crc_table[k - 1][i] & 0xFF];
+        }
+    }
+
+    crc_update = crc32c_sw;
+#if defined(__GNUC__) && defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        crc_update = crc32c_hw;
+    }
+#endif
+}
+
+/* ------------------------------------ External functions ---------------------------------------------- */
+
+uint32_t crc32c(const void *data, size_t size)
+{
+    pthread_once(&crc_once, crc32c_init);
+    return ~crc_update(~0u, data, size);
+}
+
+uint32_t crc32c_software(const void *data, size_t size)
+{
+    pthread_once(&crc_once, crc32c_init);
+    return ~crc32c_sw(~0u, data, size);
+}
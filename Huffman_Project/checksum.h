@@ -0,0 +1,45 @@
+/**
+ * @defgroup Checksum
+ * @brief CRC32C checksums used to detect corrupt blocks in encoded files.
+ *
+ * CRC32C (the Castagnoli polynomial) is used because modern x86-64 processors compute it in
+ * hardware. On such processors the SSE4.2 crc32 instruction is used, chosen at run time; everywhere
+ * else a table-driven software version (slicing by 8) is used. Both give the same result.
+ *
+ * @section Author
+ *  - Author: Abdiaziz Ibrahim Adam
+ * @since Datum
+ *  - 18 October 2026
+ * @{
+ */
+
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Computes the CRC32C checksum of a byte array.
+ *
+ * @param data Pointer to the bytes to checksum.
+ * @param size The number of bytes.
+ * @return The checksum.
+ */
+uint32_t crc32c(const void *data, size_t size);
+
+/**
+ * @brief Computes the CRC32C checksum of a byte array with the table-driven software version.
+ *
+ * crc32c() uses this version only where the processor has no crc32 instruction. It is exposed so
+ * that the tests can check it against the hardware version on any machine.
+ *
+ * @param data Pointer to the bytes to checksum.
+ * @param size The number of bytes.
+ * @return The checksum.
+ */
+uint32_t crc32c_software(const void *data, size_t size);
+
+#endif /* CHECKSUM_H */
+
+/** @} */
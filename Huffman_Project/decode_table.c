@@ -0,0 +1,248 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         decode_table.c
+ * Description:  Builds lookup tables from a Huffman tree and uses them to decode bits without walking
+ *               the tree for every bit. Invalid codes and truncated input are reported as error codes,
+ *               missing children in the tree are never followed.
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "decode_table.h"
+#include "huff_profile.h"
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+static bool is_leaf(const Trie *node)
+{
+    return node->left_child == NULL && node->right_child == NULL;
+}
+
+/*
+ * Loads whole bytes into the bit word until it holds more than 56 bits or the input is exhausted.
+ */
+static inline void refill(bit_reader *reader)
+{
+    while (reader->count <= 56 && reader->pos < reader->size) {
+        reader->bits |= (uint64_t)reader->data[reader->pos++] << (56 - reader->count);
+        reader->count += 8;
+    }
+}
+
+/*
+ * Drops the next n bits. Past the end of the input the word holds zeros, so count is clamped
+ * at zero and only consumed keeps growing.
+ */
+static inline void consume(bit_reader *reader, int n)
+{
+    reader->bits <<= n;
+    reader->count = reader->count > n ? reader->count - n : 0;
+    reader->consumed += n;
+}
+
+/*
+ * Fills the table entries below a tree node. code holds the depth bits that lead from the root to
+ * the node. Entries below missing children are left invalid.
+ */
+static void fill_entries(decode_table *table, const Trie *node, unsigned int code, int depth)
+{
+    if (node == NULL) {
+        // Remember how many bits lead outside the tree, so they are consumed like in the tree walk
+        int spare_bits = DECODE_TABLE_BITS - depth;
+        for (unsigned int i = code << spare_bits; i < (code + 1) << spare_bits; i++) {
+            table->entries[i].byte = (uint8_t)depth;
+        }
+        return;
+    }
+
+    if (is_leaf(node)) {
+        if (depth == 0) {
+            return; // A root without children has no codes to look up
+        }
+        int spare_bits = DECODE_TABLE_BITS - depth;
+        for (unsigned int i = code << spare_bits; i < (code + 1) << spare_bits; i++) {
+            table->entries[i].node = node;
+            table->entries[i].length = (uint8_t)depth;
+            table->entries[i].byte = (uint8_t)node->byte;
+        }
+        return;
+    }
+
+    if (depth == DECODE_TABLE_BITS) {
+        table->entries[code].node = node; // A long code, finished by walking from here
+        return;
+    }
+
+    fill_entries(table, node->left_child, code << 1, depth + 1);
+    fill_entries(table, node->right_child, (code << 1) | 1, depth + 1);
+}
+
+/*
+ * Finishes a code longer than the table by walking the tree from the entry's node, one checked
+ * step per bit.
+ */
+static int decode_long_code(const decode_entry *entry, bit_reader *reader)
+{
+    const Trie *node = entry->node;
+
+    if (node == NULL) {
+        consume(reader, entry->byte);
+        return -1;
+    }
+    consume(reader, DECODE_TABLE_BITS);
+
+    while (!is_leaf(node)) {
+        refill(reader);
+        int bit = (int)(reader->bits >> 63);
+        consume(reader, 1);
+        node = bit ? node->right_child : node->left_child;
+        if (node == NULL) {
+            return -1;
+        }
+    }
+    return node->byte;
+}
+
+/* ------------------------------------ External functions ---------------------------------------------- */
+
+void bit_reader_init(bit_reader *reader, const unsigned char *data, size_t size)
+{
+    reader->data = data;
+    reader->size = size;
+    reader->pos = 0;
+    reader->bits = 0;
+    reader->count = 0;
+    reader->consumed = 0;
+}
+
+void bit_reader_init_at(bit_reader *reader, const unsigned char *data, size_t size, size_t bit)
+{
+    bit_reader_init(reader, data, size);
+    if (bit >= size * 8) {
+        reader->pos = size;
+        reader->consumed = bit;
+        return;
+    }
+    reader->pos = bit / 8;
+    reader->consumed = reader->pos * 8;
+    refill(reader);
+    consume(reader, (int)(bit % 8));
+}
+
+bool bit_reader_overrun(const bit_reader *reader)
+{
+    return reader->consumed > reader->size * 8;
+}
+
+decode_table *decode_table_create(const Trie *root)
+{
+    decode_table *table = calloc(1, sizeof(decode_table));
+    if (table == NULL) {
+        fprintf(stderr, "Failed to allocate memory for decode table\n");
+        return NULL;
+    }
+
+    table->root = root;
+    if (root != NULL) {
+        fill_entries(table, root, 0, 0);
+    }
+
+    return table;
+}
+
+void decode_table_free(decode_table *table)
+{
+    free(table);
+}
+
+int decode_table_symbol(const decode_table *table, bit_reader *reader)
+{
+    refill(reader);
+    const decode_entry *entry = &table->entries[reader->bits >> (64 - DECODE_TABLE_BITS)];
+
+    if (entry->length != 0) {
+        consume(reader, entry->length);
+        return entry->byte;
+    }
+    return decode_long_code(entry, reader);
+}
+
+decode_status decode_table_run(const decode_table *table, bit_reader *reader, unsigned char *out, size_t size)
+{
+    PROFILE_ONLY(uint64_t probes[PROFILE_MAX_PROBES] = {0};)
+
+    for (size_t i = 0; i < size; i++) {
+        refill(reader);
+        const decode_entry *entry = &table->entries[reader->bits >> (64 - DECODE_TABLE_BITS)];
+
+        if (entry->length != 0) {
+            out[i] = entry->byte;
+            consume(reader, entry->length);
+            PROFILE_ONLY(probes[1]++;)
+        } else {
+            PROFILE_ONLY(size_t start = reader->consumed;)
+            int byte = decode_long_code(entry, reader);
+            if (byte < 0) {
+                return bit_reader_overrun(reader) ? DECODE_TRUNCATED : DECODE_INVALID_CODE;
+            }
+            out[i] = (unsigned char)byte;
+            // One probe of the table, then one per bit walked in the tree
+            PROFILE_ONLY(probes[1 + reader->consumed - start - DECODE_TABLE_BITS]++;)
+        }
+    }
+    PROFILE_ONLY(profile_add_probes(probes);)
+    return bit_reader_overrun(reader) ? DECODE_TRUNCATED : DECODE_OK;
+}
+
+decode_status decode_trie_run(const Trie *root, bit_reader *reader, unsigned char *out, size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        const Trie *node = root;
+
+        if (node == NULL || is_leaf(node)) {
+            return DECODE_INVALID_CODE;
+        }
+        while (!is_leaf(node)) {
+            refill(reader);
+            int bit = (int)(reader->bits >> 63);
+            consume(reader, 1);
+            node = bit ? node->right_child : node->left_child;
+            if (node == NULL) {
+                return bit_reader_overrun(reader) ? DECODE_TRUNCATED : DECODE_INVALID_CODE;
+            }
+        }
+        out[i] = (unsigned char)node->byte;
+    }
+    return bit_reader_overrun(reader) ? DECODE_TRUNCATED : DECODE_OK;
+}
+
+const char *decode_status_message(decode_status status)
+{
+    switch (status) {
+        case DECODE_OK:
+            return "File decoded succesfully.";
+        case DECODE_TABLE_MISMATCH:
+            return "File was encoded with another frequency table or format version.";
+        case DECODE_BAD_CHECKSUM:
+            return "File is corrupt: a block checksum did not match.";
+        case DECODE_BAD_BLOCK:
+            return "File is corrupt: a block header is malformed.";
+        case DECODE_INVALID_CODE:
+            return "File is corrupt: it contains an invalid Huffman code.";
+        case DECODE_TRUNCATED:
+            return "File is truncated.";
+        case DECODE_IO_ERROR:
+            return "Failed to read the input file or write the output file.";
+        case DECODE_NO_MEMORY:
+            return "Out of memory.";
+        case DECODE_OVER_LIMIT:
+            return "File has a block larger than the memory limit allows.";
+    }
+    return "Unknown error.";
+}
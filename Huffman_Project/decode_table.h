@@ -0,0 +1,170 @@
+/**
+ * @defgroup DecodeTable
+ * @brief Table-driven, bounds-checked Huffman decoding.
+ *
+ * Walking the Huffman tree costs one pointer lookup per bit, and a corrupt or malicious input can
+ * lead the walk to a missing child. The decode table removes both problems: it is indexed by the
+ * next DECODE_TABLE_BITS bits of input and gives the decoded byte and its code length directly.
+ * Codes longer than the table are finished by a checked walk from the tree node the table points at.
+ *
+ * All safety checks are built into the table, so the per-symbol hot path only does a lookup and a
+ * shift. Bit patterns that lead outside the tree are marked invalid when the table is built, and
+ * reading past the end of the input is detected once the decoding is done, since missing input
+ * bits read as zeros.
+ *
+ * Errors are reported as decode_status codes.
+ *
+ * @section Author
+ *  - Author: Abdiaziz Ibrahim Adam
+ * @since Datum
+ *  - 18 October 2026
+ * @{
+ */
+
+#ifndef DECODE_TABLE_H
+#define DECODE_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "Huff_Trie.h"
+
+#define DECODE_TABLE_BITS 10  ///< The number of input bits resolved by one table lookup.
+
+/**
+ * @brief Result of decoding a file or a block.
+ */
+typedef enum decode_status {
+    DECODE_OK = 0,          ///< Decoding succeeded.
+    DECODE_TABLE_MISMATCH,  ///< The file was encoded with another frequency table or a newer format.
+    DECODE_BAD_CHECKSUM,    ///< A block checksum did not match its payload.
+    DECODE_BAD_BLOCK,       ///< A block header is malformed or has an unknown type.
+    DECODE_INVALID_CODE,    ///< The input holds a bit pattern that is not a code in the tree.
+    DECODE_TRUNCATED,       ///< The input ended before all data was decoded.
+    DECODE_IO_ERROR,        ///< Reading the input or writing the output failed.
+    DECODE_NO_MEMORY,       ///< Memory allocation failed.
+    DECODE_OVER_LIMIT       ///< A block needs more memory than huff_codec.memory_limit allows.
+} decode_status;
+
+/**
+ * @brief One entry of the decode table.
+ */
+typedef struct decode_entry {
+    const Trie *node;  ///< The leaf reached, or the inner node reached after DECODE_TABLE_BITS bits, or NULL if invalid.
+    uint8_t length;    ///< The code length if a leaf is reached within the table, otherwise 0.
+    uint8_t byte;      ///< The decoded byte if length is not 0, the number of bits leading outside the tree if node is NULL.
+} decode_entry;
+
+/**
+ * @brief A decode table built from a Huffman tree.
+ */
+typedef struct decode_table {
+    const Trie *root;                                ///< The tree the table was built from.
+    decode_entry entries[1 << DECODE_TABLE_BITS];    ///< One entry per DECODE_TABLE_BITS-bit pattern.
+} decode_table;
+
+/**
+ * @brief Reads bits, most significant bit first, from a byte array.
+ *
+ * Up to 64 bits are kept in a word so that a whole table index can be peeked with one shift.
+ */
+typedef struct bit_reader {
+    const unsigned char *data;  ///< The bytes to read.
+    size_t size;                ///< The number of bytes.
+    size_t pos;                 ///< The index of the next byte to load into bits.
+    uint64_t bits;              ///< Loaded bits, aligned to the most significant end.
+    int count;                  ///< The number of loaded bits not yet consumed.
+    size_t consumed;            ///< The total number of bits consumed.
+} bit_reader;
+
+/**
+ * @brief Prepares a bit reader for a byte array.
+ *
+ * @param reader The reader to initialise.
+ * @param data The bytes to read. Must stay valid while the reader is used.
+ * @param size The number of bytes.
+ */
+void bit_reader_init(bit_reader *reader, const unsigned char *data, size_t size);
+
+/**
+ * @brief Prepares a bit reader that starts at a bit offset of a byte array.
+ *
+ * The bits before the offset count as consumed, so consumed stays the bit position in the array.
+ *
+ * @param reader The reader to initialise.
+ * @param data The bytes to read. Must stay valid while the reader is used.
+ * @param size The number of bytes.
+ * @param bit The number of the first bit to read, counted from the most significant bit of data[0].
+ */
+void bit_reader_init_at(bit_reader *reader, const unsigned char *data, size_t size, size_t bit);
+
+/**
+ * @brief Checks whether more bits were consumed than the input holds.
+ *
+ * @param reader The reader.
+ * @return True if the decoder ran past the end of the input.
+ */
+bool bit_reader_overrun(const bit_reader *reader);
+
+/**
+ * @brief Builds the decode table for a Huffman tree.
+ *
+ * @warning Memory allocation: It's the caller's responsibility to free the table with decode_table_free().
+ *
+ * @param root The root of the Huffman tree. Must stay valid as long as the table is used.
+ * @return Pointer to the new table, or NULL if memory allocation fails.
+ */
+decode_table *decode_table_create(const Trie *root);
+
+/**
+ * @brief Frees a decode table.
+ *
+ * @param table The table to free. May be NULL.
+ */
+void decode_table_free(decode_table *table);
+
+/**
+ * @brief Decodes the next byte.
+ *
+ * @param table The decode table.
+ * @param reader The reader positioned at the start of a code.
+ * @return The decoded byte (0-255), or -1 if the input holds an invalid code.
+ */
+int decode_table_symbol(const decode_table *table, bit_reader *reader);
+
+/**
+ * @brief Decodes exactly size bytes.
+ *
+ * @param table The decode table.
+ * @param reader The reader positioned at the start of a code.
+ * @param out Array of at least size bytes where the decoded bytes are stored.
+ * @param size The number of bytes to decode.
+ * @return DECODE_OK, DECODE_INVALID_CODE or DECODE_TRUNCATED.
+ */
+decode_status decode_table_run(const decode_table *table, bit_reader *reader, unsigned char *out, size_t size);
+
+/**
+ * @brief Decodes exactly size bytes by walking the Huffman tree bit by bit.
+ *
+ * This is the reference decoder that the table-driven decoder is checked against. It is much
+ * slower, but just as safe: a missing child is reported instead of followed.
+ *
+ * @param root The root of the Huffman tree.
+ * @param reader The reader positioned at the start of a code.
+ * @param out Array of at least size bytes where the decoded bytes are stored.
+ * @param size The number of bytes to decode.
+ * @return DECODE_OK, DECODE_INVALID_CODE or DECODE_TRUNCATED.
+ */
+decode_status decode_trie_run(const Trie *root, bit_reader *reader, unsigned char *out, size_t size);
+
+/**
+ * @brief Returns a human readable description of a decode status.
+ *
+ * @param status The status.
+ * @return A static string.
+ */
+const char *decode_status_message(decode_status status);
+
+#endif /* DECODE_TABLE_H */
+
+/** @} */
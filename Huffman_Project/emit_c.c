@@ -0,0 +1,148 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         emit_c.c
+ * Description:  Writes the code, length and decode tables of a codec as a C header of static const
+ *               arrays, so that encoders and decoders for a fixed frequency table can be compiled
+ *               against them instead of building the tables at startup.
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "emit_c.h"
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+static bool is_leaf(const Trie *node)
+{
+    return node->left_child == NULL && node->right_child == NULL;
+}
+
+/*
+ * Numbers the inner nodes of the tree in preorder, so that the root is node 0. A tree of at most 256
+ * leaves has at most 255 inner nodes.
+ */
+static int number_nodes(const Trie *node, const Trie **inner, int count)
+{
+    if (node == NULL || is_leaf(node)) {
+        return count;
+    }
+    inner[count++] = node;
+    count = number_nodes(node->left_child, inner, count);
+    return number_nodes(node->right_child, inner, count);
+}
+
+static int node_index(const Trie **inner, int count, const Trie *node)
+{
+    for (int i = 0; i < count; i++) {
+        if (inner[i] == node) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Returns how a child is written in huff_static_tree: its node index, -1 - byte for a leaf, or
+ * EMIT_C_MISSING.
+ */
+static int child_value(const Trie **inner, int count, const Trie *child)
+{
+    if (child == NULL) {
+        return EMIT_C_MISSING;
+    }
+    if (is_leaf(child)) {
+        return -1 - child->byte;
+    }
+    return node_index(inner, count, child);
+}
+
+static void emit_codes(FILE *output, const huff_codec *codec)
+{
+    fprintf(output, "static const uint64_t huff_static_codes[256] = {");
+    for (int i = 0; i < 256; i++) {
+        uint64_t code = 0;
+        for (int j = 0; j < codec->code_length[i]; j++) {
+            code = (code << 1) | (codec->table[i][j] == '1');
+        }
+        fprintf(output, "%s0x%llxu,", i % 8 == 0 ? "\n    " : " ", (unsigned long long)code);
+    }
+    fprintf(output, "\n};\n\n");
+
+    fprintf(output, "static const uint8_t huff_static_lengths[256] = {");
+    for (int i = 0; i < 256; i++) {
+        fprintf(output, "%s%d,", i % 16 == 0 ? "\n    " : " ", codec->code_length[i]);
+    }
+    fprintf(output, "\n};\n\n");
+}
+
+static void emit_lookup(FILE *output, const huff_codec *codec, const Trie **inner, int count)
+{
+    fprintf(output,
+            "/* length > 0: a whole code, decoding to byte.\n"
+            " * next >= 0: a longer code, finished by walking huff_static_tree from node next.\n"
+            " * next < 0: an invalid code whose first byte bits lead outside the tree. */\n");
+    fprintf(output, "static const huff_static_entry huff_static_lookup[1 << HUFF_STATIC_LOOKUP_BITS] = {");
+    for (int i = 0; i < (1 << DECODE_TABLE_BITS); i++) {
+        const decode_entry *entry = &codec->decoder->entries[i];
+        int next = entry->node == NULL ? -1 : entry->length != 0 ? 0 : node_index(inner, count, entry->node);
+        fprintf(output, "%s{%d, %d, %d},", i % 6 == 0 ? "\n    " : " ", entry->length, entry->byte, next);
+    }
+    fprintf(output, "\n};\n\n");
+}
+
+static void emit_tree(FILE *output, const Trie **inner, int count)
+{
+    fprintf(output, "/* The children of each inner node: a node index, -1 - byte for a leaf, or %d if missing. */\n",
+            EMIT_C_MISSING);
+    fprintf(output, "static const int16_t huff_static_tree[HUFF_STATIC_NODES][2] = {\n");
+    for (int i = 0; i < count; i++) {
+        fprintf(output, "    {%d, %d},\n", child_value(inner, count, inner[i]->left_child),
+                child_value(inner, count, inner[i]->right_child));
+    }
+    fprintf(output, "};\n\n");
+}
+
+/* ------------------------------------ External functions ---------------------------------------------- */
+
+int emit_c_tables(FILE *output, const huff_codec *codec, const char *source_name)
+{
+    const Trie *inner[256];
+    int max_length = 0;
+
+    for (int i = 0; i < 256; i++) {
+        if (codec->code_length[i] > max_length) {
+            max_length = codec->code_length[i];
+        }
+    }
+    if (codec->trie == NULL || max_length > EMIT_C_MAX_CODE_LENGTH) {
+        return -1;
+    }
+    int count = number_nodes(codec->trie, inner, 0);
+
+    fprintf(output, "/* Generated by \"huffman -emit-c\" from %s. Do not edit. */\n\n", source_name);
+    fprintf(output, "#ifndef HUFF_STATIC_TABLES_H\n#define HUFF_STATIC_TABLES_H\n\n#include <stdint.h>\n\n");
+    fprintf(output, "#define HUFF_STATIC_TABLE_ID 0x%08xu\n", codec->table_id);
+    fprintf(output, "#define HUFF_STATIC_MAX_CODE_LENGTH %d\n", max_length);
+    fprintf(output, "#define HUFF_STATIC_LOOKUP_BITS %d\n", DECODE_TABLE_BITS);
+    fprintf(output, "#define HUFF_STATIC_NODES %d\n", count);
+    fprintf(output, "#define HUFF_STATIC_MISSING (%d)\n\n", EMIT_C_MISSING);
+    fprintf(output, "typedef struct huff_static_entry {\n"
+                    "    uint8_t length;\n"
+                    "    uint8_t byte;\n"
+                    "    int16_t next;\n"
+                    "} huff_static_entry;\n\n");
+
+    emit_codes(output, codec);
+    emit_lookup(output, codec, inner, count);
+    emit_tree(output, inner, count);
+
+    fprintf(output, "#endif /* HUFF_STATIC_TABLES_H */\n");
+    return ferror(output) ? -1 : 0;
+}
@@ -0,0 +1,49 @@
+/**
+ * @defgroup EmitC
+ * @brief Writes the code tables of a codec as generated C (the `-emit-c` mode).
+ *
+ * When the frequency table is fixed at build time, there is no need to build the Huffman tree, the
+ * code strings and the decode table on every run. The generated header holds them as `static const`
+ * arrays, and static_codec.c compiles against it into an encoder and decoder that need no setup and
+ * whose table sizes are compile-time constants.
+ *
+ * The header defines, with the prefix `huff_static_`:
+ *  - HUFF_STATIC_TABLE_ID, the table ID that files encoded with the table carry in their header.
+ *  - huff_static_codes and huff_static_lengths, the code of every byte right-aligned in 64 bits and
+ *    its length (0 for bytes without a code).
+ *  - huff_static_lookup, the decode table indexed by the next HUFF_STATIC_LOOKUP_BITS bits.
+ *  - huff_static_tree, the inner nodes of the tree, which finish codes longer than the lookup.
+ *
+ * The generated tables decode exactly like decode_table.h, including the bits consumed by an
+ * invalid code, and encode the same payloads as encode_block().
+ *
+ * @section Author
+ *  - Author: Abdiaziz Ibrahim Adam
+ * @since Datum
+ *  - 18 October 2026
+ * @{
+ */
+
+#ifndef EMIT_C_H
+#define EMIT_C_H
+
+#include <stdio.h>
+#include "encode_decode.h"
+
+#define EMIT_C_MAX_CODE_LENGTH 57   ///< The longest code the generated encoder can write with one 64-bit shift.
+#define EMIT_C_MISSING (-257)       ///< Marks a missing child in huff_static_tree.
+
+/**
+ * @brief Writes the generated header for a codec.
+ *
+ * @param output The stream to write the header to.
+ * @param codec The codec whose tables are written.
+ * @param source_name The name of the frequency file, quoted in the header comment.
+ * @return 0 on success, -1 if the codec has no codes, a code is longer than EMIT_C_MAX_CODE_LENGTH
+ *         or writing failed.
+ */
+int emit_c_tables(FILE *output, const huff_codec *codec, const char *source_name);
+
+#endif /* EMIT_C_H */
+
+/** @} */
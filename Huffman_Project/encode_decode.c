@@ -13,91 +13,972 @@
  * Date:         18 March 2024
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include "bit_buffer.h"
 #include "Huff_Trie.h"
 #include "encode_decode.h"
+#include "byte_io.h"
+#include "huff_table.h"
+#include "table_file.h"
+#include "checksum.h"
+#include "decode_table.h"
+#include "pipeline.h"
+#include "tans.h"
+#include "parallel_decode.h"
+#include "huff_profile.h"
+
+#define BITSTREAM_MARGIN 64   // Bytes that hold the longest code of 256 bytes, 255 bits, and the reader's look-ahead
 
-void encode_file(FILE *input, FILE *output, char **huffmanTable) 
+huff_codec *codec_create(const int *frequency_table)
 {
-    bit_buffer *buffer = bit_buffer_empty();
-    int c;
-    long input_size = 0;
-    long output_size = 0;
+    huff_codec *codec = malloc(sizeof(huff_codec));
+    if (codec == NULL) {
+        fprintf(stderr, "Failed to allocate memory for codec\n");
+        return NULL;
+    }
+
+    memcpy(codec->frequency, frequency_table, sizeof(codec->frequency));
+    codec->trie = build_huff_trie(codec->frequency);
+    codec->table = huff_table(codec->trie);
+    codec->table_id = table_id(frequency_table);
+    codec->decoder = decode_table_create(codec->trie);
+    codec->tans = tans_table_create(codec->frequency);
+    codec->threads = 1;
+    codec->memory_limit = 0;
+    for (int i = 0; i < 256; i++) {
+        codec->code_length[i] = codec->table[i] != NULL ? (uint8_t)strlen(codec->table[i]) : 0;
+    }
+    if (codec->decoder == NULL || codec->tans == NULL) {
+        codec_free(codec);
+        return NULL;
+    }
 
-    fseek(input, 0, SEEK_END);
-    input_size = ftell(input);
-    rewind(input); 
-    
+    return codec;
+}
 
-    // Encode all characters from input
-    while ((c = fgetc(input)) != EOF) {
-        char *code = huffmanTable[c];
-        for (int i = 0; code[i] != '\0'; i++) {
-            bit_buffer_insert_bit(buffer, code[i] == '1');
+void codec_free(huff_codec *codec)
+{
+    if (codec != NULL) {
+        trie_kill(codec->trie);
+        free_huff_table(codec->table);
+        decode_table_free(codec->decoder);
+        tans_table_free(codec->tans);
+        free(codec);
+    }
+}
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+/*
+ * Writes one block: its header followed by the payload.
+ *
+ * @return 0 on success, -1 if writing failed.
+ */
+static int write_block(FILE *output, int type, uint32_t raw_size, const unsigned char *payload, uint32_t payload_size)
+{
+    unsigned char header[BLOCK_HEADER_SIZE];
+
+    header[0] = (unsigned char)type;
+    put_u32(header + 1, raw_size);
+    put_u32(header + 5, payload_size);
+    put_u32(header + 9, payload_size > 0 ? crc32c(payload, payload_size) : 0);
+
+    if (fwrite(header, 1, BLOCK_HEADER_SIZE, output) != BLOCK_HEADER_SIZE ||
+        (payload_size > 0 && fwrite(payload, 1, payload_size, output) != payload_size)) {
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Makes sure a byte array can hold at least size bytes.
+ *
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+static int reserve(unsigned char **array, size_t *capacity, size_t size)
+{
+    if (size > *capacity) {
+        unsigned char *grown = realloc(*array, size);
+        if (grown == NULL) {
+            return -1;
         }
+        *array = grown;
+        *capacity = size;
     }
+    return 0;
+}
 
-    // Encode EOT symbol
-    char *eotCode = huffmanTable[4]; // Assuming '4' is the index for EOT in your table
-    for (int i = 0; eotCode[i] != '\0'; i++) {
-        bit_buffer_insert_bit(buffer, eotCode[i] == '1');
+/*
+ * Expands the runs of an RLE payload into exactly raw_size bytes.
+ */
+static decode_status decode_rle(const unsigned char *payload, size_t payload_size, unsigned char *out, size_t raw_size)
+{
+    size_t size = 0;
+
+    if (payload_size % RLE_RUN_SIZE != 0) {
+        return DECODE_BAD_BLOCK;
+    }
+    for (size_t i = 0; i < payload_size; i += RLE_RUN_SIZE) {
+        size_t run = ((size_t)payload[i + 1] | (size_t)payload[i + 2] << 8) + 1;
+        if (run > raw_size - size) {
+            return DECODE_BAD_BLOCK;
+        }
+        memset(out + size, payload[i], run);
+        size += run;
     }
+    return size == raw_size ? DECODE_OK : DECODE_BAD_BLOCK;
+}
 
-    while (bit_buffer_size(buffer) > 0) {
-        if (bit_buffer_size(buffer) < 8) {
-            // Pading with zeros to complete the final byte
-            while (bit_buffer_size(buffer) < 8) {
-                bit_buffer_insert_bit(buffer, 0);
-            }
+/*
+ * Decodes a payload with a tree of its own: the code lengths of the tree, then the codes of exactly
+ * raw_size bytes. The lengths are checked before the tree is built from them.
+ */
+static decode_status decode_local(const unsigned char *payload, size_t payload_size, unsigned char *out,
+                                  size_t raw_size)
+{
+    if (payload_size < LOCAL_LENGTHS_SIZE || !canonical_lengths_valid(payload)) {
+        return DECODE_BAD_BLOCK;
+    }
+
+    Trie *trie = build_canonical_huff_trie(payload);
+    decode_table *decoder = trie != NULL ? decode_table_create(trie) : NULL;
+    decode_status status = DECODE_NO_MEMORY;
+    if (decoder != NULL) {
+        bit_reader reader;
+        bit_reader_init(&reader, payload + LOCAL_LENGTHS_SIZE, payload_size - LOCAL_LENGTHS_SIZE);
+        status = decode_table_run(decoder, &reader, out, raw_size);
+    }
+
+    decode_table_free(decoder);
+    trie_kill(trie);
+    return status;
+}
+
+/*
+ * Decodes the blocks of a version 2 or 3 file until the end block. The checksum of every payload
+ * is verified before the payload is decoded, so corrupt data never reaches the decoder.
+ */
+static decode_status decode_blocks(FILE *input, FILE *output, const huff_codec *codec, const decode_table *decoder,
+                                   codec_stats *stats)
+{
+    unsigned char header_bytes[BLOCK_HEADER_SIZE];
+    unsigned char *payload = NULL;
+    size_t payload_capacity = 0;
+    unsigned char *block = malloc(BLOCK_SIZE);
+    decode_status status = DECODE_OK;
+
+    if (block == NULL) {
+        return DECODE_NO_MEMORY;
+    }
+
+    while (status == DECODE_OK) {
+        if (fread(header_bytes, 1, BLOCK_HEADER_SIZE, input) != BLOCK_HEADER_SIZE) {
+            status = ferror(input) ? DECODE_IO_ERROR : DECODE_TRUNCATED;
+            break;
+        }
+        stats->bytes_in += BLOCK_HEADER_SIZE;
+
+        block_header header;
+        status = block_header_read(header_bytes, &header);
+        if (status != DECODE_OK) {
+            break;
+        }
+        // The index is not needed to decode, but it is part of what was encoded
+        if (header.type == BLOCK_END) {
+            stats->bytes_in += skip_bytes(input, header.payload_size);
+            break;
+        }
+
+        // No valid block is larger than a stored one; under a limit the payload must not grow past it
+        if (codec->memory_limit != 0 && header.payload_size > BLOCK_SIZE) {
+            status = DECODE_OVER_LIMIT;
+            break;
+        }
+        if (reserve(&payload, &payload_capacity, header.payload_size) != 0) {
+            status = DECODE_NO_MEMORY;
+            break;
         }
-        char byte = bit_buffer_remove_byte(buffer);
-        fputc(byte, output);
-        output_size++;
+        if (fread(payload, 1, header.payload_size, input) != header.payload_size) {
+            status = ferror(input) ? DECODE_IO_ERROR : DECODE_TRUNCATED;
+            break;
+        }
+        stats->bytes_in += header.payload_size;
+
+        const unsigned char *decoded;
+        status = decode_block(codec, decoder, &header, payload, block, &decoded);
+        if (status == DECODE_OK && fwrite(decoded, 1, header.raw_size, output) != header.raw_size) {
+            status = DECODE_IO_ERROR;
+        }
+        stats->bytes_out += header.raw_size;
     }
-    printf("\n%ld bytes read from input file.\n", input_size);
-    printf("%ld bytes used in encoded form.\n\n", output_size);
 
-    bit_buffer_free(buffer);
+    free(payload);
+    free(block);
+    return status;
 }
 
-void decode_file(FILE *input, FILE *output, Trie *huffmanTree, char **huffmanTable) 
+/*
+ * Decodes a single EOT-terminated bitstream, the format of files without a header and of version 1
+ * files, on up to num_threads threads. The bytes already read while looking for a header are passed
+ * in as the start of the stream.
+ */
+static decode_status decode_bitstream(FILE *input, FILE *output, const decode_table *decoder, int num_threads,
+                                      codec_stats *stats, const unsigned char *start, size_t start_size)
 {
-    Trie *current = huffmanTree;
-    bit_buffer *buffer = bit_buffer_empty();
+    size_t capacity = BLOCK_SIZE;
+    size_t size = start_size;
+    unsigned char *data = malloc(capacity);
+    decode_status status = DECODE_OK;
 
-    int c;
-    while ((c = fgetc(input)) != EOF) {
-        for (int i = 7; i >= 0; --i) {
-            bit_buffer_insert_bit(buffer, (c >> i) & 1);
+    if (data == NULL) {
+        return DECODE_NO_MEMORY;
+    }
+    memcpy(data, start, start_size);
+
+    // The stream has no framing, so all of it is read before decoding
+    size_t n;
+    while ((n = fread(data + size, 1, capacity - size, input)) > 0) {
+        size += n;
+        stats->bytes_in += n;
+        if (size == capacity && reserve(&data, &capacity, capacity * 2) != 0) {
+            free(data);
+            return DECODE_NO_MEMORY;
         }
     }
+    if (ferror(input)) {
+        free(data);
+        return DECODE_IO_ERROR;
+    }
+
+    // Decoding until EOT is encountered; the bytes before an error are written as well
+    unsigned char *decoded = NULL;
+    size_t decoded_size = 0;
+    status = parallel_decode_bitstream(decoder, data, size, num_threads, &decoded, &decoded_size);
+    if (decoded_size > 0 && fwrite(decoded, 1, decoded_size, output) != decoded_size && status == DECODE_OK) {
+        status = DECODE_IO_ERROR;
+    }
+    stats->bytes_out += decoded_size;
+
+    free(decoded);
+    free(data);
+    return status;
+}
+
+/*
+ * Decodes a single EOT-terminated bitstream sequentially through a window of BLOCK_SIZE bytes, so
+ * that memory use does not depend on the size of the stream. A code is only decoded while at least
+ * BITSTREAM_MARGIN bytes follow it in the window, unless the input has ended, which covers the
+ * longest code of a tree of 256 bytes and the look-ahead of the bit reader.
+ */
+static decode_status decode_bitstream_bounded(FILE *input, FILE *output, const decode_table *decoder,
+                                              codec_stats *stats, const unsigned char *start, size_t start_size)
+{
+    unsigned char *window = malloc(BLOCK_SIZE);
+    unsigned char *block = malloc(BLOCK_SIZE);
+    size_t size = start_size;
+    size_t bit = 0;
+    size_t block_size = 0;
+    bool done = false;
+    decode_status status = DECODE_OK;
+
+    if (window == NULL || block == NULL) {
+        free(window);
+        free(block);
+        return DECODE_NO_MEMORY;
+    }
+    memcpy(window, start, start_size);
 
-    // Decoding until EOT is encountered
-    bool foundEOT = false;
-    while (bit_buffer_size(buffer) > 0 && !foundEOT) {
-        if (current->left_child == NULL && current->right_child == NULL) { // Leaf node
-            if (strcmp(huffmanTable[current->byte], huffmanTable[4]) == 0) { // Check if it's EOT
-                foundEOT = true;
+    while (!done) {
+        // Move the unread bytes to the front and fill up the window
+        size_t first = bit / 8;
+        memmove(window, window + first, size - first);
+        size -= first;
+        bit -= first * 8;
+        size_t n = fread(window + size, 1, BLOCK_SIZE - size, input);
+        size += n;
+        stats->bytes_in += n;
+        if (ferror(input)) {
+            status = DECODE_IO_ERROR;
+            break;
+        }
+        bool end = size < BLOCK_SIZE;
+        size_t limit = end ? SIZE_MAX : (size - BITSTREAM_MARGIN) * 8;
+
+        bit_reader reader;
+        bit_reader_init_at(&reader, window, size, bit);
+        while (reader.consumed < limit) {
+            int byte = decode_table_symbol(decoder, &reader);
+            if (bit_reader_overrun(&reader) || byte < 0) {
+                status = bit_reader_overrun(&reader) ? DECODE_TRUNCATED : DECODE_INVALID_CODE;
+                done = true;
                 break;
-            } else {
-                fputc(current->byte, output); // Write decoded character
-                current = huffmanTree; // Reset to root
             }
+            if (byte == PARALLEL_EOT) {
+                done = true;
+                break;
+            }
+            block[block_size++] = (unsigned char)byte;
+            if (block_size == BLOCK_SIZE) {
+                if (fwrite(block, 1, block_size, output) != block_size) {
+                    status = DECODE_IO_ERROR;
+                    done = true;
+                    break;
+                }
+                stats->bytes_out += block_size;
+                block_size = 0;
+            }
+        }
+        bit = reader.consumed;
+    }
+
+    // The bytes before an error are written as well
+    if (block_size > 0 && fwrite(block, 1, block_size, output) != block_size && status == DECODE_OK) {
+        status = DECODE_IO_ERROR;
+    }
+    stats->bytes_out += block_size;
+
+    free(block);
+    free(window);
+    return status;
+}
+
+/*
+ * Decodes a file written by format version 1 or 2, or without a header, with the tree of all 256
+ * bytes those versions used. The tree is only built when such a file is decoded.
+ */
+static decode_status decode_legacy(FILE *input, FILE *output, const huff_codec *codec, codec_stats *stats,
+                                   int version, const unsigned char *start, size_t start_size)
+{
+    Trie *trie = build_legacy_huff_trie((int *)codec->frequency);
+    decode_table *decoder = decode_table_create(trie);
+    decode_status status = DECODE_NO_MEMORY;
+
+    if (trie != NULL && decoder != NULL) {
+        if (version == 2) {
+            status = decode_blocks(input, output, codec, decoder, stats);
+        } else if (codec->memory_limit != 0) {
+            status = decode_bitstream_bounded(input, output, decoder, stats, start, start_size);
+        } else {
+            status = decode_bitstream(input, output, decoder, codec->threads, stats, start, start_size);
+        }
+    }
+
+    decode_table_free(decoder);
+    trie_kill(trie);
+    return status;
+}
+
+/*
+ * Reads the end block with an index of count entries at the end of a file of size bytes, and checks
+ * that the entries add up to where the end block starts.
+ */
+static decode_status read_index(FILE *archive, block_index *index, uint32_t count, long size, long *end_offset)
+{
+    if (count > (size - HUFF_HEADER_SIZE - end_block_size(0)) / INDEX_ENTRY_SIZE) {
+        return DECODE_BAD_BLOCK;
+    }
+    size_t end_size = end_block_size(count);
+    long offset = size - (long)end_size;
+    unsigned char *end = malloc(end_size);
+    if (end == NULL) {
+        return DECODE_NO_MEMORY;
+    }
+
+    decode_status status = DECODE_OK;
+    block_header header;
+    if (fseek(archive, offset, SEEK_SET) != 0 || fread(end, 1, end_size, archive) != end_size) {
+        status = DECODE_IO_ERROR;
+    } else if (block_header_read(end, &header) != DECODE_OK || header.type != BLOCK_END ||
+               header.payload_size != end_size - BLOCK_HEADER_SIZE) {
+        status = DECODE_BAD_BLOCK;
+    } else if (crc32c(end + BLOCK_HEADER_SIZE, header.payload_size) != header.checksum) {
+        status = DECODE_BAD_CHECKSUM;
+    }
+
+    long expected_offset = HUFF_HEADER_SIZE;
+    for (uint32_t i = 0; status == DECODE_OK && i < count; i++) {
+        const unsigned char *entry = end + BLOCK_HEADER_SIZE + (size_t)i * INDEX_ENTRY_SIZE;
+        uint32_t block_size = get_u32(entry + 4);
+        if (block_index_add(index, get_u32(entry), block_size) != 0) {
+            status = DECODE_NO_MEMORY;
+        }
+        expected_offset += block_size;
+    }
+    if (status == DECODE_OK && expected_offset != offset) {
+        status = DECODE_BAD_BLOCK;
+    }
+
+    free(end);
+    *end_offset = offset;
+    return status;
+}
+
+/*
+ * Finds the end block of a file without an index by skipping from block header to block header.
+ */
+static decode_status scan_blocks(FILE *archive, block_index *index, long *end_offset)
+{
+    long offset = HUFF_HEADER_SIZE;
+
+    while (fseek(archive, offset, SEEK_SET) == 0) {
+        unsigned char bytes[BLOCK_HEADER_SIZE];
+        block_header header;
+
+        if (fread(bytes, 1, BLOCK_HEADER_SIZE, archive) != BLOCK_HEADER_SIZE) {
+            return ferror(archive) ? DECODE_IO_ERROR : DECODE_TRUNCATED;
+        }
+        decode_status status = block_header_read(bytes, &header);
+        if (status != DECODE_OK) {
+            return status;
+        }
+        if (header.type == BLOCK_END) {
+            *end_offset = offset;
+            return DECODE_OK;
         }
-        int bit = bit_buffer_remove_bit(buffer);
-        current = (bit == 0) ? current->left_child : current->right_child;
+        if (block_index_add(index, header.raw_size, BLOCK_HEADER_SIZE + header.payload_size) != 0) {
+            return DECODE_NO_MEMORY;
+        }
+        offset += BLOCK_HEADER_SIZE + header.payload_size;
     }
-    printf("\nFile decoded succesfully.\n\n");
+    return DECODE_IO_ERROR;
+}
 
-    bit_buffer_free(buffer);
+/*
+ * Moves bytes of a file to a lower offset. The ranges may overlap.
+ *
+ * @return 0 on success, -1 if reading or writing failed.
+ */
+static int move_bytes(int fd, off_t from, off_t to, off_t size)
+{
+    unsigned char *buffer = malloc(BLOCK_SIZE);
+    int result = buffer != NULL ? 0 : -1;
+
+    // Each chunk is read before the next write can reach it, since the bytes move down
+    for (off_t done = 0; result == 0 && done < size; ) {
+        size_t chunk = size - done < BLOCK_SIZE ? (size_t)(size - done) : BLOCK_SIZE;
+        if (pread(fd, buffer, chunk, from + done) != (ssize_t)chunk ||
+            pwrite(fd, buffer, chunk, to + done) != (ssize_t)chunk) {
+            result = -1;
+        }
+        done += chunk;
+    }
+    free(buffer);
+    return result;
 }
 
+/*
+ * Returns where the byte counts and messages of the file functions go: stdout, unless the output
+ * itself is written to stdout.
+ */
+static FILE *report_stream(FILE *output)
+{
+    return output == stdout ? stderr : stdout;
+}
 
+/*
+ * Writes the runs of equal bytes in a block to an RLE payload.
+ */
+static void rle_encode(const unsigned char *block, size_t block_size, unsigned char *payload)
+{
+    size_t i = 0;
 
+    while (i < block_size) {
+        size_t run = 1;
+        while (i + run < block_size && block[i + run] == block[i]) {
+            run++;
+        }
+        payload[0] = block[i];
+        payload[1] = (unsigned char)((run - 1) & 0xFF);
+        payload[2] = (unsigned char)((run - 1) >> 8);
+        payload += RLE_RUN_SIZE;
+        i += run;
+    }
+}
 
+/*
+ * Appends the codes of a block to the bit buffer, padded to whole bytes. Every byte of the block
+ * must have a code.
+ */
+static void insert_codes(bit_buffer *buffer, char **huffmanTable, const unsigned char *block, size_t block_size)
+{
+    for (size_t j = 0; j < block_size; j++) {
+        char *code = huffmanTable[block[j]];
+        for (int i = 0; code[i] != '\0'; i++) {
+            bit_buffer_insert_bit(buffer, code[i] == '1');
+        }
+    }
 
+    // Pading with zeros to complete the final byte
+    while (bit_buffer_size(buffer) % 8 != 0) {
+        bit_buffer_insert_bit(buffer, 0);
+    }
+}
 
+/*
+ * Computes the code lengths of a Huffman tree built from a block's own histogram.
+ */
+static void block_local_lengths(const size_t *count, uint8_t *code_length)
+{
+    int frequency[256];
+    for (int i = 0; i < 256; i++) {
+        frequency[i] = (int)count[i];
+    }
 
+    Trie *trie = build_huff_trie(frequency);
+    trie_code_lengths(trie, code_length);
+    trie_kill(trie);
+}
+
+/*
+ * Writes a block with a tree of its own: its code lengths, then the codes of its bytes in the
+ * canonical tree of those lengths.
+ *
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+static int local_encode(bit_buffer *buffer, const uint8_t *code_length, const unsigned char *block,
+                        size_t block_size, unsigned char *payload)
+{
+    Trie *trie = build_canonical_huff_trie(code_length);
+    char **table = trie != NULL ? huff_table(trie) : NULL;
+    if (table == NULL) {
+        trie_kill(trie);
+        return -1;
+    }
+
+    memcpy(payload, code_length, LOCAL_LENGTHS_SIZE);
+    insert_codes(buffer, table, block, block_size);
+    bit_buffer_copy_to(buffer, (char *)payload + LOCAL_LENGTHS_SIZE);
+    bit_buffer_clear(buffer);
+
+    free_huff_table(table);
+    trie_kill(trie);
+    return 0;
+}
+
+/* ------------------------------------ External functions ---------------------------------------------- */
+
+void block_histogram(const unsigned char *block, size_t block_size, size_t *count, size_t *runs)
+{
+    memset(count, 0, 256 * sizeof(size_t));
+    *runs = block_size > 0;
+    if (block_size == 0) {
+        return;
+    }
+
+    count[block[0]]++;
+    for (size_t i = 1; i < block_size; i++) {
+        count[block[i]]++;
+        *runs += block[i] != block[i - 1];
+    }
+}
+
+int block_choose_type(const huff_codec *codec, const unsigned char *block, const size_t *count, size_t runs,
+                      size_t block_size, size_t *payload_size)
+{
+    uint64_t bits = 0;
+    bool codable = true;
+    for (int i = 0; i < 256; i++) {
+        if (count[i] > 0 && codec->code_length[i] == 0) {
+            codable = false;
+        }
+        bits += (uint64_t)count[i] * codec->code_length[i];
+    }
+
+    int type = BLOCK_STORED;
+    *payload_size = block_size;
+
+    size_t huffman_size = (bits + 7) / 8;
+    if (codable && huffman_size < *payload_size) {
+        type = BLOCK_HUFFMAN;
+        *payload_size = huffman_size;
+    }
+    size_t rle_size = runs * RLE_RUN_SIZE;
+    if (rle_size < *payload_size) {
+        type = BLOCK_RLE;
+        *payload_size = rle_size;
+    }
+
+    // A tree of the block's own costs its code lengths, but codes every byte, also those the shared tree lacks
+    if (block_size > LOCAL_LENGTHS_SIZE) {
+        uint8_t local_length[256];
+        uint64_t local_bits = 0;
+        block_local_lengths(count, local_length);
+        for (int i = 0; i < 256; i++) {
+            local_bits += (uint64_t)count[i] * local_length[i];
+        }
+        size_t local_size = LOCAL_LENGTHS_SIZE + (local_bits + 7) / 8;
+        if (local_size < *payload_size) {
+            type = BLOCK_LOCAL;
+            *payload_size = local_size;
+        }
+    }
+
+    // Only blocks that tANS could shrink further are worth the exact size computation
+    if (tans_estimate_size(codec->tans, count) < *payload_size) {
+        size_t tans_size = tans_payload_size(codec->tans, block, block_size);
+        if (tans_size < *payload_size) {
+            type = BLOCK_TANS;
+            *payload_size = tans_size;
+        }
+    }
+    return type;
+}
+
+void write_file_header(FILE *output, const huff_codec *codec)
+{
+    fwrite(HUFF_MAGIC, 1, 4, output);
+    fputc(HUFF_FORMAT_VERSION, output);
+    write_u32(output, codec->table_id);
+}
+
+int block_index_add(block_index *index, uint32_t raw_size, uint32_t block_size)
+{
+    if (index->count == index->capacity) {
+        size_t capacity = index->capacity > 0 ? index->capacity * 2 : 64;
+        index_entry *entries = realloc(index->entries, capacity * sizeof(index_entry));
+        if (entries == NULL) {
+            return -1;
+        }
+        index->entries = entries;
+        index->capacity = capacity;
+    }
+    index->entries[index->count].raw_size = raw_size;
+    index->entries[index->count].block_size = block_size;
+    index->count++;
+    return 0;
+}
+
+void block_index_free(block_index *index)
+{
+    free(index->entries);
+    index->entries = NULL;
+    index->count = 0;
+    index->capacity = 0;
+}
+
+size_t end_block_size(size_t num_blocks)
+{
+    return BLOCK_HEADER_SIZE + num_blocks * INDEX_ENTRY_SIZE + INDEX_TRAILER_SIZE;
+}
+
+int write_end_block(FILE *output, const block_index *index)
+{
+    size_t count = index != NULL ? index->count : 0;
+    size_t payload_size = count * INDEX_ENTRY_SIZE + INDEX_TRAILER_SIZE;
+    unsigned char *payload = malloc(payload_size);
+
+    if (payload == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        put_u32(payload + i * INDEX_ENTRY_SIZE, index->entries[i].raw_size);
+        put_u32(payload + i * INDEX_ENTRY_SIZE + 4, index->entries[i].block_size);
+    }
+    put_u32(payload + count * INDEX_ENTRY_SIZE, (uint32_t)count);
+    memcpy(payload + count * INDEX_ENTRY_SIZE + 4, HUFF_INDEX_MAGIC, 4);
+
+    int result = write_block(output, BLOCK_END, 0, payload, payload_size);
+    free(payload);
+    return result;
+}
+
+decode_status read_block_index(FILE *archive, const huff_codec *codec, block_index *index, long *end_offset)
+{
+    unsigned char header[HUFF_HEADER_SIZE];
+    unsigned char trailer[INDEX_TRAILER_SIZE];
+
+    if (fseek(archive, 0, SEEK_SET) != 0 || fread(header, 1, HUFF_HEADER_SIZE, archive) != HUFF_HEADER_SIZE) {
+        return ferror(archive) ? DECODE_IO_ERROR : DECODE_TRUNCATED;
+    }
+    if (memcmp(header, HUFF_MAGIC, 4) != 0 || header[4] != HUFF_FORMAT_VERSION ||
+        get_u32(header + 5) != codec->table_id) {
+        return DECODE_TABLE_MISMATCH;
+    }
+    if (fseek(archive, 0, SEEK_END) != 0) {
+        return DECODE_IO_ERROR;
+    }
+    long size = ftell(archive);
+    if (size < 0) {
+        return DECODE_IO_ERROR;
+    }
+
+    if (size >= HUFF_HEADER_SIZE + (long)end_block_size(0) &&
+        fseek(archive, size - INDEX_TRAILER_SIZE, SEEK_SET) == 0 &&
+        fread(trailer, 1, INDEX_TRAILER_SIZE, archive) == INDEX_TRAILER_SIZE &&
+        memcmp(trailer + 4, HUFF_INDEX_MAGIC, 4) == 0) {
+        return read_index(archive, index, get_u32(trailer), size, end_offset);
+    }
+    return scan_blocks(archive, index, end_offset);
+}
+
+size_t encode_block(const huff_codec *codec, bit_buffer *buffer, const unsigned char *block, size_t block_size,
+                    unsigned char *out)
+{
+    // The payload sizes follow from the histogram, so nothing is encoded in vain
+    size_t count[256];
+    size_t runs;
+    size_t payload_size;
+    block_histogram(block, block_size, count, &runs);
+    int type = block_choose_type(codec, block, count, runs, block_size, &payload_size);
+
+    unsigned char *payload = out + BLOCK_HEADER_SIZE;
+    uint8_t local_length[256];
+    if (type == BLOCK_LOCAL) {
+        block_local_lengths(count, local_length);
+        if (local_encode(buffer, local_length, block, block_size, payload) != 0) {
+            type = BLOCK_STORED;  // Out of memory for the tree, storing needs none
+            payload_size = block_size;
+        }
+    }
+    if (type == BLOCK_STORED) {
+        memcpy(payload, block, block_size);
+    } else if (type == BLOCK_RLE) {
+        rle_encode(block, block_size, payload);
+    } else if (type == BLOCK_TANS) {
+        tans_encode(codec->tans, block, block_size, payload);
+    } else if (type == BLOCK_HUFFMAN) {
+        insert_codes(buffer, codec->table, block, block_size);
+        bit_buffer_copy_to(buffer, (char *)payload);
+        bit_buffer_clear(buffer);
+    }
+
+    out[0] = (unsigned char)type;
+    put_u32(out + 1, block_size);
+    put_u32(out + 5, payload_size);
+    put_u32(out + 9, crc32c(payload, payload_size));
+    PROFILE_ONLY(profile_add_block(type, type == BLOCK_STORED || type == BLOCK_RLE ? NULL : count,
+                                   type == BLOCK_TANS ? NULL : type == BLOCK_LOCAL ? local_length : codec->code_length,
+                                   block_size, payload_size);)
+    return BLOCK_HEADER_SIZE + payload_size;
+}
+
+decode_status block_header_read(const unsigned char *bytes, block_header *header)
+{
+    header->type = bytes[0];
+    header->raw_size = get_u32(bytes + 1);
+    header->payload_size = get_u32(bytes + 5);
+    header->checksum = get_u32(bytes + 9);
+
+    if (header->type == BLOCK_END) {
+        return DECODE_OK;
+    }
+    size_t lengths_size = header->type == BLOCK_LOCAL ? LOCAL_LENGTHS_SIZE : 0;
+    if ((header->type != BLOCK_HUFFMAN && header->type != BLOCK_STORED && header->type != BLOCK_RLE &&
+         header->type != BLOCK_TANS && header->type != BLOCK_LOCAL) ||
+        header->raw_size > BLOCK_SIZE || header->payload_size > (size_t)header->raw_size * 32 + 1 + lengths_size ||
+        (header->type == BLOCK_STORED && header->payload_size != header->raw_size)) {
+        return DECODE_BAD_BLOCK;
+    }
+    return DECODE_OK;
+}
+
+decode_status decode_block(const huff_codec *codec, const decode_table *decoder, const block_header *header,
+                           const unsigned char *payload, unsigned char *block, const unsigned char **decoded)
+{
+    if (crc32c(payload, header->payload_size) != header->checksum) {
+        return DECODE_BAD_CHECKSUM;
+    }
+
+    // Stored payloads are used as they are
+    *decoded = payload;
+    if (header->type == BLOCK_HUFFMAN) {
+        bit_reader reader;
+        bit_reader_init(&reader, payload, header->payload_size);
+        *decoded = block;
+        return decode_table_run(decoder, &reader, block, header->raw_size);
+    }
+    if (header->type == BLOCK_RLE) {
+        *decoded = block;
+        return decode_rle(payload, header->payload_size, block, header->raw_size);
+    }
+    if (header->type == BLOCK_LOCAL) {
+        *decoded = block;
+        return decode_local(payload, header->payload_size, block, header->raw_size);
+    }
+    if (header->type == BLOCK_TANS) {
+        *decoded = block;
+        return tans_decode(codec->tans, payload, header->payload_size, block, header->raw_size);
+    }
+    return DECODE_OK;
+}
+
+int encode_stream(FILE *input, FILE *output, const huff_codec *codec, bit_buffer *buffer, codec_stats *stats)
+{
+    unsigned char *block = malloc(BLOCK_SIZE);
+    unsigned char *encoded = malloc(BLOCK_HEADER_SIZE + BLOCK_SIZE);
+    size_t block_size;
+    block_index index = {NULL, 0, 0};
+    int result = 0;
+
+    stats->bytes_in = 0;
+    stats->bytes_out = 0;
+    if (block == NULL || encoded == NULL) {
+        free(block);
+        free(encoded);
+        return -1;
+    }
+
+    // Write the header so the decoder can check that it uses the same table
+    write_file_header(output, codec);
+    stats->bytes_out += HUFF_HEADER_SIZE;
+
+    // Encode the input one block at a time
+    while (result == 0 && (block_size = fread(block, 1, BLOCK_SIZE, input)) > 0) {
+        stats->bytes_in += block_size;
+
+        size_t encoded_size = encode_block(codec, buffer, block, block_size, encoded);
+        if (fwrite(encoded, 1, encoded_size, output) != encoded_size ||
+            block_index_add(&index, block_size, encoded_size) != 0) {
+            result = -1;
+        }
+        stats->bytes_out += encoded_size;
+    }
+
+    if (result == 0) {
+        result = write_end_block(output, &index);
+        stats->bytes_out += end_block_size(index.count);
+    }
+
+    block_index_free(&index);
+    free(encoded);
+    free(block);
+    return result != 0 || ferror(input) || ferror(output) ? -1 : 0;
+}
+
+decode_status decode_stream(FILE *input, FILE *output, const huff_codec *codec, codec_stats *stats)
+{
+    unsigned char header[HUFF_HEADER_SIZE];
+    size_t header_size = fread(header, 1, sizeof(header), input);
+
+    return decode_stream_with_header(input, output, codec, stats, header, header_size);
+}
+
+decode_status decode_stream_with_header(FILE *input, FILE *output, const huff_codec *codec, codec_stats *stats,
+                                        const unsigned char *header, size_t header_size)
+{
+    stats->bytes_in = header_size;
+    stats->bytes_out = 0;
+
+    // Files without the magic predate the header; their first bytes are already encoded data
+    if (header_size < HUFF_HEADER_SIZE || memcmp(header, HUFF_MAGIC, 4) != 0) {
+        return decode_legacy(input, output, codec, stats, 0, header, header_size);
+    }
+
+    if (header[4] > HUFF_FORMAT_VERSION || get_u32(header + 5) != codec->table_id) {
+        return DECODE_TABLE_MISMATCH;
+    }
+    if (header[4] < HUFF_FORMAT_VERSION) {
+        return decode_legacy(input, output, codec, stats, header[4], NULL, 0);
+    }
+    return decode_blocks(input, output, codec, codec->decoder, stats);
+}
+
+int encode_file(FILE *input, FILE *output, const huff_codec *codec) 
+{
+    codec_stats stats;
+    FILE *report = report_stream(output);
+
+    if (pipeline_encode(input, output, codec, &stats) != 0) {
+        fprintf(stderr, "\nCould not encode: reading or writing failed.\n\n");
+        return 1;
+    }
+    fprintf(report, "\n%ld bytes read from input file.\n", stats.bytes_in);
+    fprintf(report, "%ld bytes used in encoded form.\n\n", stats.bytes_out);
+
+    return 0;
+}
+
+decode_status append_stream(FILE *input, FILE *archive, const huff_codec *codec, codec_stats *stats)
+{
+    block_index index = {NULL, 0, 0};
+    long end_offset = 0;
+    long old_size = -1;
+    unsigned char *old_end = NULL;
+    int fd = fileno(archive);
+
+    stats->bytes_in = 0;
+    stats->bytes_out = 0;
+    decode_status status = read_block_index(archive, codec, &index, &end_offset);
+
+    // The old end block is kept until the new blocks are complete, and put back if anything fails
+    if (status == DECODE_OK && (fseek(archive, 0, SEEK_END) != 0 || (old_size = ftell(archive)) < end_offset)) {
+        status = DECODE_IO_ERROR;
+    }
+    if (status == DECODE_OK && (old_end = malloc(old_size - end_offset + 1)) == NULL) {
+        status = DECODE_NO_MEMORY;
+    }
+    if (status == DECODE_OK && (fseek(archive, end_offset, SEEK_SET) != 0 ||
+                                fread(old_end, 1, old_size - end_offset, archive) != (size_t)(old_size - end_offset) ||
+                                fseek(archive, old_size, SEEK_SET) != 0)) {
+        status = DECODE_IO_ERROR;
+    }
+    if (status != DECODE_OK) {
+        free(old_end);
+        block_index_free(&index);
+        return status;
+    }
+
+    // The new blocks and the end block with the index of all blocks are written after the old end block
+    if (pipeline_encode_blocks(input, archive, codec, &index, stats) != 0) {
+        status = DECODE_IO_ERROR;
+    }
+    // The pipeline writes past stdio, so the position is taken from the file descriptor
+    if (status == DECODE_OK && fflush(archive) != 0) {
+        status = DECODE_IO_ERROR;
+    }
+    off_t new_size = status == DECODE_OK ? lseek(fd, 0, SEEK_CUR) : -1;
+    if (status == DECODE_OK && new_size < old_size) {
+        status = DECODE_IO_ERROR;
+    }
+
+    // Only then are they moved over the old end block
+    off_t appended = new_size - old_size;
+    if (status == DECODE_OK && (move_bytes(fd, old_size, end_offset, appended) != 0 ||
+                                ftruncate(fd, end_offset + appended) != 0)) {
+        status = DECODE_IO_ERROR;
+    }
+
+    if (status != DECODE_OK) {
+        fflush(archive);
+        if (pwrite(fd, old_end, old_size - end_offset, end_offset) == old_size - end_offset) {
+            ftruncate(fd, old_size);
+        }
+    }
+    free(old_end);
+    block_index_free(&index);
+    return status;
+}
+
+int decode_file(FILE *input, FILE *output, const huff_codec *codec) 
+{
+    codec_stats stats;
+
+    decode_status status = pipeline_decode(input, output, codec, &stats);
+    if (status != DECODE_OK) {
+        fprintf(stderr, "\n%s\n\n", decode_status_message(status));
+        return 1;
+    }
+    fprintf(report_stream(output), "\n%s\n\n", decode_status_message(status));
+
+    return 0;
+}
+
+int append_file(FILE *input, FILE *archive, const huff_codec *codec)
+{
+    codec_stats stats;
+
+    decode_status status = append_stream(input, archive, codec, &stats);
+    if (status != DECODE_OK) {
+        fprintf(stderr, "\nCould not append: %s\n\n", decode_status_message(status));
+        return 1;
+    }
+    printf("\n%ld bytes read from input file.\n", stats.bytes_in);
+    printf("%ld bytes appended in encoded form.\n\n", stats.bytes_out);
+
+    return 0;
+}
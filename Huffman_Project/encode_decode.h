@@ -15,44 +15,381 @@
 #ifndef ENCODE_DECODE_H
 #define ENCODE_DECODE_H
 
+#include <stdint.h>
 #include "bit_buffer.h" 
 #include "Huff_Trie.h"  
+#include "decode_table.h"
+#include "tans.h"
+
+#define HUFF_MAGIC "HUFZ"       ///< Magic bytes at the start of every encoded file.
+#define HUFF_FORMAT_VERSION 3   ///< The format version written by encode_file().
+#define HUFF_HEADER_SIZE 9      ///< Size of the file header in bytes.
+
+#define BLOCK_SIZE (64 * 1024)  ///< The largest number of input bytes encoded in one block.
+#define BLOCK_HEADER_SIZE 13    ///< Size of a block header in bytes.
+#define BLOCK_HUFFMAN 0         ///< Block type: the payload holds the Huffman codes of the block.
+#define BLOCK_STORED 1          ///< Block type: the payload holds the bytes of the block unchanged.
+#define BLOCK_RLE 2             ///< Block type: the payload holds the runs of equal bytes in the block.
+#define BLOCK_TANS 3            ///< Block type: the payload holds the block coded with tANS, see tans.h.
+#define BLOCK_LOCAL 4           ///< Block type: the payload holds the block's own code lengths, then its Huffman codes.
+#define LOCAL_LENGTHS_SIZE 256  ///< Size of the code lengths at the start of a BLOCK_LOCAL payload, one byte per byte value.
+#define RLE_RUN_SIZE 3          ///< Size of one run in an RLE payload: the byte and the run length - 1 (16 bits).
+#define BLOCK_END 0xFF          ///< Block type: marks the end of the file, its payload is the block index.
+#define INDEX_ENTRY_SIZE 8      ///< Size of one block index entry: the raw size and the stored size of a block.
+#define INDEX_TRAILER_SIZE 8    ///< Size of the end of the block index: the number of entries and HUFF_INDEX_MAGIC.
+#define HUFF_INDEX_MAGIC "HUFI" ///< Ends an encoded file that has a block index.
+
+/*
+ * Encoded files start with a small header: the magic, one version byte and the 32-bit ID of the
+ * frequency table used (see table_id()). Files written before the header was introduced have no
+ * magic and are still decoded, without any table check, as are version 1 files whose header is
+ * followed by a single EOT-terminated bitstream.
+ *
+ * In version 2 the header is followed by blocks of at most BLOCK_SIZE input bytes each, and an end
+ * block. Every block starts with a header of one type byte, the number of decoded bytes, the number
+ * of payload bytes and the CRC32C checksum of the payload (three 32-bit little-endian integers).
+ * The checksum is verified before a payload is decoded, so corruption is reported instead of
+ * producing garbage.
+ *
+ * Version 3 has the same layout, but its Huffman tree only holds the bytes that occur in the
+ * frequency table (see build_huff_trie()). Version 1 and 2 files are decoded with the tree of all
+ * 256 bytes they were written with.
+ *
+ * Each block is written in the form that gives the smallest payload, which the encoder computes
+ * from the block's histogram and the code lengths before encoding anything: Huffman coded, tANS
+ * coded (see tans.h), Huffman coded with a tree of its own, stored unchanged or run-length encoded.
+ * Version 3 files may also hold tANS blocks; the tANS tables are built from the same frequency
+ * table as the Huffman codes, so the file header does not change.
+ *
+ * A block with a tree of its own (BLOCK_LOCAL) is how bytes that have no code in the shared tree
+ * are encoded, for example when the frequency table comes from another file than the input. The
+ * payload starts with LOCAL_LENGTHS_SIZE bytes, the code length of every byte value in a Huffman
+ * tree built from the block's histogram (0 for bytes that do not occur), followed by the codes of
+ * the block in the canonical tree of those lengths (see build_canonical_huff_trie()), padded to
+ * whole bytes. A single byte without a shared code thus costs the block LOCAL_LENGTHS_SIZE bytes
+ * instead of turning all of it into a stored block. Decoders of files before this block type
+ * existed reject it as a bad block.
+ *
+ * The payload of the end block is an index of the blocks before it: for each block its raw size and
+ * its size in the file, header included (two 32-bit little-endian integers), followed by the number
+ * of entries and HUFF_INDEX_MAGIC. Since the magic ends the file, the index and the end block can be
+ * found from the end of the file, and new blocks can be appended by replacing the end block with
+ * them and a longer index (see append_stream()). Decoders stop at the end block header and never
+ * need the index, so end blocks without an index, as written before it was introduced, still decode.
+ */
+
+/**
+ * @brief The code tables built from one frequency table.
+ *
+ * A codec is built once and can then be used to encode or decode any number of files, also from
+ * several threads at the same time, since encoding and decoding only read from it.
+ */
+typedef struct huff_codec {
+    Trie *trie;         ///< The Huffman tree, used for decoding.
+    char **table;       ///< The Huffman table, one code string per byte value, used for encoding.
+    uint32_t table_id;  ///< The ID of the frequency table, see table_id().
+    decode_table *decoder; ///< The decode table built from the tree, used for decoding.
+    int frequency[256]; ///< The frequency table, kept to build the tree of older format versions.
+    uint8_t code_length[256]; ///< The length of each byte's code, 0 if the byte has no code.
+    tans_table *tans;   ///< The tANS tables built from the same frequency table.
+    int threads;        ///< The number of threads a legacy bitstream is decoded on, 1 unless changed, see parallel_decode.h.
+    size_t memory_limit; ///< The bytes the buffers may use, or 0 for no limit. With a limit legacy bitstreams are decoded in a window.
+} huff_codec;
+
+/**
+ * @brief The fields of a block header.
+ */
+typedef struct block_header {
+    int type;               ///< The block type.
+    uint32_t raw_size;      ///< The number of decoded bytes.
+    uint32_t payload_size;  ///< The number of payload bytes that follow the header.
+    uint32_t checksum;      ///< The CRC32C checksum of the payload.
+} block_header;
+
+/**
+ * @brief Byte counts collected while encoding or decoding one file.
+ */
+typedef struct codec_stats {
+    long bytes_in;   ///< The number of bytes read from the input file.
+    long bytes_out;  ///< The number of bytes written to the output file.
+} codec_stats;
+
+/**
+ * @brief One entry of the block index.
+ */
+typedef struct index_entry {
+    uint32_t raw_size;    ///< The number of decoded bytes in the block.
+    uint32_t block_size;  ///< The size of the block in the file, header and payload.
+} index_entry;
+
+/**
+ * @brief The index of the blocks of an encoded file, in file order.
+ */
+typedef struct block_index {
+    index_entry *entries;  ///< The entries.
+    size_t count;          ///< The number of entries.
+    size_t capacity;       ///< The number of entries there is room for.
+} block_index;
+
+/**
+ * @brief Builds the Huffman tree and table for a frequency table.
+ *
+ * @warning Memory allocation: It's the caller's responsibility to free the codec with codec_free().
+ *
+ * @param frequency_table Array of 256 integers representing the frequency of each byte.
+ * @return Pointer to the new codec, or NULL if memory allocation fails.
+ */
+huff_codec *codec_create(const int *frequency_table);
+
+/**
+ * @brief Frees a codec and the tree and table it owns.
+ *
+ * @param codec Pointer to the codec to free. May be NULL.
+ */
+void codec_free(huff_codec *codec);
+
+/**
+ * @brief Counts the bytes and the runs of equal bytes in a block.
+ *
+ * @param block The bytes of the block.
+ * @param block_size The number of bytes.
+ * @param count Array of 256 counts where the histogram is stored.
+ * @param runs Pointer to where the number of runs is stored.
+ */
+void block_histogram(const unsigned char *block, size_t block_size, size_t *count, size_t *runs);
+
+/**
+ * @brief Picks the block type that gives a block the smallest payload.
+ *
+ * The payload sizes are computed exactly from the histogram, the code lengths of the codec and the
+ * number of runs, see block_histogram(). A block with a byte that has no code is never Huffman or
+ * tANS coded with the shared tables, but may still be Huffman coded with a tree of its own, whose
+ * code lengths follow from the same histogram. The tANS size depends on the order of the bytes, so
+ * it is computed from the block itself, but only when the histogram shows that tANS could beat the
+ * other types. A block is only stored when no other type is smaller.
+ *
+ * @param codec The codec the block would be encoded with.
+ * @param block The bytes of the block.
+ * @param count The histogram of the block.
+ * @param runs The number of runs in the block.
+ * @param block_size The number of bytes in the block.
+ * @param payload_size Pointer to where the payload size of the chosen type is stored.
+ * @return BLOCK_HUFFMAN, BLOCK_TANS, BLOCK_LOCAL, BLOCK_STORED or BLOCK_RLE.
+ */
+int block_choose_type(const huff_codec *codec, const unsigned char *block, const size_t *count, size_t runs,
+                      size_t block_size, size_t *payload_size);
+
+/**
+ * @brief Writes the file header: the magic, the format version and the table ID of the codec.
+ *
+ * @param output Pointer to a FILE structure for the output file. Must be opened in write mode.
+ * @param codec The codec the file is encoded with.
+ */
+void write_file_header(FILE *output, const huff_codec *codec);
+
+/**
+ * @brief Adds a block to a block index.
+ *
+ * @param index The index. An index of all zeros is empty.
+ * @param raw_size The number of decoded bytes in the block.
+ * @param block_size The size of the block in the file.
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+int block_index_add(block_index *index, uint32_t raw_size, uint32_t block_size);
+
+/**
+ * @brief Frees the entries of a block index and empties it.
+ *
+ * @param index The index.
+ */
+void block_index_free(block_index *index);
+
+/**
+ * @brief Returns the size of the end block of a file with a number of blocks.
+ *
+ * @param num_blocks The number of blocks before the end block.
+ * @return The size in bytes, header and index.
+ */
+size_t end_block_size(size_t num_blocks);
+
+/**
+ * @brief Writes the end block that closes an encoded file, with the index of its blocks.
+ *
+ * @param output Pointer to a FILE structure for the output file. Must be opened in write mode.
+ * @param index The index of the blocks written before, or NULL for a file without blocks.
+ * @return 0 on success, -1 if writing or memory allocation failed.
+ */
+int write_end_block(FILE *output, const block_index *index);
+
+/**
+ * @brief Finds the end block of an encoded file and reads its block index.
+ *
+ * The index is found from the end of the file. A file whose end block has no index is scanned
+ * block header by block header instead, skipping the payloads.
+ *
+ * @param archive Pointer to a FILE structure for the encoded file. Must be seekable.
+ * @param codec The codec the file must be encoded with.
+ * @param index Pointer to an empty index where the entries are stored. Free it with block_index_free().
+ * @param end_offset Pointer to where the offset of the end block is stored.
+ * @return DECODE_OK, DECODE_TABLE_MISMATCH if the file is not a current format file of the codec's
+ *         table, or the decode_status describing why the file is damaged.
+ */
+decode_status read_block_index(FILE *archive, const huff_codec *codec, block_index *index, long *end_offset);
+
+/**
+ * @brief Encodes one block, header and payload, into a byte array.
+ *
+ * @param codec The codec to encode with.
+ * @param buffer An empty bit buffer used as scratch space. It is empty again when the function returns.
+ * @param block The bytes to encode, at most BLOCK_SIZE.
+ * @param block_size The number of bytes.
+ * @param out Array of at least BLOCK_HEADER_SIZE + BLOCK_SIZE bytes where the block is stored.
+ * @return The number of bytes stored in out.
+ */
+size_t encode_block(const huff_codec *codec, bit_buffer *buffer, const unsigned char *block, size_t block_size,
+                    unsigned char *out);
+
+/**
+ * @brief Parses and checks a block header.
+ *
+ * @param bytes The BLOCK_HEADER_SIZE bytes of the header.
+ * @param header Pointer to where the fields are stored.
+ * @return DECODE_OK, or DECODE_BAD_BLOCK if the type is unknown or the sizes are impossible.
+ */
+decode_status block_header_read(const unsigned char *bytes, block_header *header);
+
+/**
+ * @brief Verifies the checksum of a block payload and decodes it.
+ *
+ * @param codec The codec, whose tANS tables decode tANS blocks.
+ * @param decoder The decode table to decode Huffman blocks with.
+ * @param header The header of the block, checked with block_header_read(). Must not be an end block.
+ * @param payload The payload_size bytes of the payload.
+ * @param block Array of at least BLOCK_SIZE bytes used for the decoded bytes.
+ * @param decoded Pointer to where the address of the raw_size decoded bytes is stored. This is block,
+ *        or payload itself for stored blocks.
+ * @return DECODE_OK on success, otherwise the decode_status describing the error.
+ */
+decode_status decode_block(const huff_codec *codec, const decode_table *decoder, const block_header *header,
+                           const unsigned char *payload, unsigned char *block, const unsigned char **decoded);
+
+/**
+ * @brief Encodes an input file into an output file without printing anything.
+ *
+ * This is the core of encode_file(). The caller supplies the bit buffer, so that it can be reused
+ * between files; it must be empty when the function is called and is empty again when it returns.
+ *
+ * @param input Pointer to a FILE structure for the input file. Must be opened in read mode.
+ * @param output Pointer to a FILE structure for the output file. Must be opened in write mode.
+ * @param codec The codec to encode with.
+ * @param buffer An empty bit buffer used as scratch space.
+ * @param stats Pointer to where the byte counts are stored.
+ * @return 0 on success, -1 if reading or writing failed.
+ */
+int encode_stream(FILE *input, FILE *output, const huff_codec *codec, bit_buffer *buffer, codec_stats *stats);
+
+/**
+ * @brief Appends an input file to an encoded file without recompressing what it holds.
+ *
+ * The new blocks replace the end block of the encoded file, and a new end block with the index of
+ * all blocks is written after them, so the cost only depends on the size of the input. Decoding the
+ * result gives the old contents followed by the input.
+ *
+ * The new blocks and end block are first written after the old end block and only moved over it
+ * once they are complete. If reading the input or writing fails, the old end block is put back
+ * and the file truncated to its old size, so a failed append leaves a file that still decodes.
+ *
+ * @param input Pointer to a FILE structure for the input file. Must be opened in read mode.
+ * @param archive Pointer to a FILE structure for the encoded file. Must be opened in "r+b" mode.
+ * @param codec The codec the encoded file was written with.
+ * @param stats Pointer to where the byte counts of the appended data are stored.
+ * @return DECODE_OK, or the decode_status describing why nothing or not all could be appended.
+ */
+decode_status append_stream(FILE *input, FILE *archive, const huff_codec *codec, codec_stats *stats);
+
+/**
+ * @brief Decodes an encoded file into an output file without printing anything.
+ *
+ * This is the core of decode_file(). Decoding is table-driven and never follows a missing child in
+ * the tree, so corrupt, truncated or malicious input is reported as an error instead of crashing.
+ * Output written before an error is detected is not removed.
+ *
+ * @param input Pointer to a FILE structure for the encoded file. Must be opened in read mode.
+ * @param output Pointer to a FILE structure for the output file. Must be opened in write mode.
+ * @param codec The codec to decode with.
+ * @param stats Pointer to where the byte counts are stored.
+ * @return DECODE_OK on success, otherwise the decode_status describing the error.
+ */
+decode_status decode_stream(FILE *input, FILE *output, const huff_codec *codec, codec_stats *stats);
+
+/**
+ * @brief Decodes an encoded file whose first bytes were already read.
+ *
+ * This is decode_stream() for callers that have to look at the file header themselves.
+ *
+ * @param input Pointer to a FILE structure for the encoded file, positioned after the bytes in header.
+ * @param output Pointer to a FILE structure for the output file. Must be opened in write mode.
+ * @param codec The codec to decode with.
+ * @param stats Pointer to where the byte counts are stored.
+ * @param header The first bytes of the file.
+ * @param header_size The number of bytes in header, HUFF_HEADER_SIZE unless the file is shorter.
+ * @return DECODE_OK on success, otherwise the decode_status describing the error.
+ */
+decode_status decode_stream_with_header(FILE *input, FILE *output, const huff_codec *codec, codec_stats *stats,
+                                        const unsigned char *header, size_t header_size);
 
 /**
  * @brief Encodes an input file using Huffman codes and writes the encoded data to an output file.
  * 
- * This function reads each character from the input file, looks up its corresponding Huffman code in the provided
- * Huffman table, and writes the encoded bits to the output file. The encoding process uses a bit buffer to manage the
- * bit-level operations required for writing encoded data.
- * 
- * Memory Management: The function allocates a bit buffer for encoding purposes and it is users responsiblity to free this buffer before returning.
+ * This function reads each character from the input file, looks up its corresponding Huffman code in the
+ * codec's Huffman table, and writes the encoded bits to the output file. The encoding process uses a bit buffer
+ * to manage the bit-level operations required for writing encoded data. The number of bytes read and written
+ * is printed when done, to stderr if the output is stdout.
+ *
+ * The input is read strictly sequentially and the output is never seeked, so both may be pipes.
  * 
- * @note It's crucial that the Huffman table contains valid Huffman codes for every character that may appear in the input file.
+ * @note Characters that have no Huffman code, because they did not occur in the frequency table, are
+ *       not lost: every block that holds one is Huffman coded with a tree of its own, which the block
+ *       carries as LOCAL_LENGTHS_SIZE bytes of code lengths. Blocks that Huffman coding would not
+ *       make smaller are stored or run-length encoded.
  * 
  * @param input Pointer to a FILE structure for the input file. Must be opened in read mode.
  * @param output Pointer to a FILE structure for the output file. Must be opened in write mode.
- * @param huffmanTable An array of strings where each index corresponds to a character (byte) and each string represents
- *        the Huffman code for that character.
+ * @param codec The codec holding the Huffman table and the ID of its frequency table.
+ * @return 0 on success, or 1 if reading the input or writing the output failed.
  */
-void encode_file(FILE *input, FILE *output, char **huffmanTable);
+int encode_file(FILE *input, FILE *output, const huff_codec *codec);
 
 /**
  * @brief Decodes an encoded file using a Huffman tree and writes the decoded data to an output file.
  * 
- * This function reads the encoded data from the input file bit by bit, traverses the provided Huffman tree according
- * to these bits, and writes the decoded characters to the output file. When the traversal reaches a leaf node,
- * the corresponding character is written out, and the traversal restarts from the root for the next series of bits.
+ * This function reads the encoded data from the input file, looks up the codes in the codec's decode table,
+ * which is built from the Huffman tree, and writes the decoded characters to the output file. A message
+ * describing the result is printed when done, to stderr if the output is stdout. Neither file is
+ * seeked, so both may be pipes.
  * 
- * Memory Management: The function allocates a bit buffer to assist in the decoding process and it is user's responsiblity to free this buffer before returning.
- * 
- * @note The function expects the input file to be encoded according to the provided Huffman tree. If the encoded data
- * does not match the Huffman tree structure, the decoding process may result in undefined behavior.
+ * @note If the encoded data does not match the Huffman tree, an error message is printed and 1 is returned.
  * 
  * @param input Pointer to a FILE structure for the input file, containing encoded data. Must be opened in read mode.
  * @param output Pointer to a FILE structure for the output file where the decoded data will be written. Must be opened in write mode.
- * @param huffmanTree A pointer to the root of the Huffman tree used for decoding.
+ * @param codec The codec holding the Huffman tree and the ID of its frequency table. Decoding is refused if
+ *        the file header names another table.
+ * @return 0 on success, or 1 if the file could not be decoded.
+ */
+int decode_file(FILE *input, FILE *output, const huff_codec *codec);
+
+/**
+ * @brief Appends a file to an encoded file and prints the result.
+ *
+ * See append_stream(). The number of bytes read and appended is printed when done, or a message
+ * describing why the encoded file could not be appended to.
+ *
+ * @param input Pointer to a FILE structure for the input file. Must be opened in read mode.
+ * @param archive Pointer to a FILE structure for the encoded file. Must be opened in "r+b" mode.
+ * @param codec The codec the encoded file was written with.
+ * @return 0 on success, or 1 on failure.
  */
-void decode_file(FILE *input, FILE *output, Trie *huffmanTree, char **huffmanTable) ;
+int append_file(FILE *input, FILE *archive, const huff_codec *codec);
 
 #endif /* ENCODE_DECODE_H */
 
@@ -0,0 +1,164 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         estimate.c
+ * Description:  Predicts the encoded size of a file from the histograms of its blocks, and compares
+ *               it with the Shannon bound, without encoding anything.
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "estimate.h"
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+/*
+ * Adds one block to the report.
+ */
+static void sample_block(estimate_report *report, const huff_codec *codec, const unsigned char *block,
+                         size_t block_size)
+{
+    size_t count[256];
+    size_t runs;
+    size_t payload_size;
+
+    block_histogram(block, block_size, count, &runs);
+    int type = block_choose_type(codec, block, count, runs, block_size, &payload_size);
+
+    for (int i = 0; i < 256; i++) {
+        if (count[i] > 0 && codec->code_length[i] == 0) {
+            report->codable = false;
+        }
+        report->count[i] += count[i];
+        report->code_bits += (long long)count[i] * codec->code_length[i];
+    }
+    report->block_types[type]++;
+    report->payload_bytes += payload_size;
+    report->bytes_sampled += block_size;
+    report->blocks_sampled++;
+}
+
+/*
+ * Returns the size of a seekable file and rewinds it, or -1 if the file can not seek.
+ */
+static long long seekable_size(FILE *input)
+{
+    if (fseek(input, 0, SEEK_END) != 0) {
+        return -1;
+    }
+    long size = ftell(input);
+    if (size < 0 || fseek(input, 0, SEEK_SET) != 0) {
+        return -1;
+    }
+    return size;
+}
+
+/* ------------------------------------ External functions ---------------------------------------------- */
+
+int estimate_stream(FILE *input, const huff_codec *codec, int sample_every, estimate_report *report)
+{
+    unsigned char *block = malloc(BLOCK_SIZE);
+    size_t block_size;
+
+    memset(report, 0, sizeof(*report));
+    report->codable = true;
+    if (block == NULL) {
+        return -1;
+    }
+    if (sample_every < 1) {
+        sample_every = 1;
+    }
+
+    long long size = sample_every > 1 ? seekable_size(input) : -1;
+    if (size >= 0) {
+        // Skipped blocks are never read
+        report->bytes_in = size;
+        report->blocks = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        for (long long i = 0; i < report->blocks; i += sample_every) {
+            if (fseek(input, (long)(i * BLOCK_SIZE), SEEK_SET) != 0) {
+                break;
+            }
+            block_size = fread(block, 1, BLOCK_SIZE, input);
+            sample_block(report, codec, block, block_size);
+        }
+    } else {
+        while ((block_size = fread(block, 1, BLOCK_SIZE, input)) > 0) {
+            if (report->blocks % sample_every == 0) {
+                sample_block(report, codec, block, block_size);
+            }
+            report->bytes_in += block_size;
+            report->blocks++;
+        }
+    }
+
+    free(block);
+    return ferror(input) ? -1 : 0;
+}
+
+long long estimate_encoded_size(const estimate_report *report)
+{
+    long long payload = report->payload_bytes;
+
+    // Nothing sampled, for example when the file shrank before its blocks were read, leaves nothing to scale
+    if (report->bytes_sampled > 0 && report->bytes_sampled < report->bytes_in) {
+        payload = llround((double)payload * report->bytes_in / report->bytes_sampled);
+    }
+    return HUFF_HEADER_SIZE + report->blocks * BLOCK_HEADER_SIZE + payload + end_block_size(report->blocks);
+}
+
+double estimate_shannon_bound(const estimate_report *report)
+{
+    double bits = 0;
+
+    for (int i = 0; i < 256; i++) {
+        if (report->count[i] > 0) {
+            bits += report->count[i] * log2((double)report->bytes_sampled / report->count[i]);
+        }
+    }
+    if (report->bytes_sampled > 0) {
+        bits *= (double)report->bytes_in / report->bytes_sampled;
+    }
+    return bits / 8;
+}
+
+void estimate_print(FILE *output, const estimate_report *report, const huff_codec *codec)
+{
+    bool exact = report->bytes_sampled == report->bytes_in;
+    double bound = estimate_shannon_bound(report);
+
+    fprintf(output, "\n%lld bytes in input file, %lld of %lld blocks sampled.\n",
+            report->bytes_in, report->blocks_sampled, report->blocks);
+    fprintf(output, "%lld bytes used in encoded form (%s).\n",
+            estimate_encoded_size(report), exact ? "exact" : "extrapolated");
+    fprintf(output, "Blocks: %lld Huffman, %lld local Huffman, %lld tANS, %lld stored, %lld RLE.\n",
+            report->block_types[BLOCK_HUFFMAN], report->block_types[BLOCK_LOCAL], report->block_types[BLOCK_TANS],
+            report->block_types[BLOCK_STORED], report->block_types[BLOCK_RLE]);
+    if (report->codable && report->bytes_sampled > 0) {
+        fprintf(output, "Huffman codes: %.3f bits per byte.\n", (double)report->code_bits / report->bytes_sampled);
+    } else {
+        fprintf(output, "Huffman codes: some bytes have no code.\n");
+    }
+    fprintf(output, "Shannon bound: %.0f bytes, %.3f bits per byte.\n\n",
+            ceil(bound), report->bytes_in > 0 ? bound * 8 / report->bytes_in : 0.0);
+
+    fprintf(output, "Byte      Count  Code length  Ideal length\n");
+    for (int i = 0; i < 256; i++) {
+        if (report->count[i] == 0) {
+            continue;
+        }
+        double ideal = log2((double)report->bytes_sampled / report->count[i]);
+        if (codec->code_length[i] > 0) {
+            fprintf(output, "0x%02x %10lld %12d %13.2f\n", i, report->count[i], codec->code_length[i], ideal);
+        } else {
+            fprintf(output, "0x%02x %10lld %12s %13.2f\n", i, report->count[i], "-", ideal);
+        }
+    }
+    fprintf(output, "\n");
+}
@@ -0,0 +1,82 @@
+/**
+ * @defgroup Estimate
+ * @brief Predicts the encoded size of a file without encoding it (the `-estimate` mode).
+ *
+ * The input is read once, a block at a time, and only histograms are built. With the code lengths
+ * of the codec these give the exact size encode_file() would produce, since the block type and
+ * payload size of every block follow from its histogram (see block_choose_type()); only blocks that
+ * tANS could win are also run through the tANS encoder without writing anything. The Shannon
+ * bound, the smallest size any coder that looks at one byte at a time could reach, is reported
+ * next to it, together with the code length of every byte that occurs.
+ *
+ * To estimate large files quickly, only every Nth block can be sampled; the sizes are then
+ * extrapolated from the sampled blocks.
+ *
+ * @section Author
+ *  - Author: Abdiaziz Ibrahim Adam
+ * @since Datum
+ *  - 18 October 2026
+ * @{
+ */
+
+#ifndef ESTIMATE_H
+#define ESTIMATE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "encode_decode.h"
+
+/**
+ * @brief The result of estimating one file.
+ */
+typedef struct estimate_report {
+    long long bytes_in;        ///< The size of the input file.
+    long long bytes_sampled;   ///< The number of input bytes in the sampled blocks.
+    long long blocks;          ///< The number of blocks in the input.
+    long long blocks_sampled;  ///< The number of blocks that were sampled.
+    long long block_types[5];  ///< The number of sampled blocks of each type, indexed by block type.
+    long long payload_bytes;   ///< The payload bytes of the sampled blocks.
+    long long code_bits;       ///< The Huffman code bits of the sampled bytes, 0 if a byte has no code.
+    bool codable;              ///< True if every sampled byte has a Huffman code.
+    long long count[256];      ///< The histogram of the sampled bytes.
+} estimate_report;
+
+/**
+ * @brief Builds the histograms of a file and computes its encoded size.
+ *
+ * @param input Pointer to a FILE structure for the input file. Must be opened in read mode.
+ * @param codec The codec the file would be encoded with.
+ * @param sample_every Sample every Nth block; 1 samples every block and gives exact sizes.
+ * @param report Pointer to where the result is stored.
+ * @return 0 on success, -1 if reading failed.
+ */
+int estimate_stream(FILE *input, const huff_codec *codec, int sample_every, estimate_report *report);
+
+/**
+ * @brief Returns the predicted size of the encoded file.
+ *
+ * @param report The result of estimate_stream().
+ * @return The size in bytes, exact if every block was sampled.
+ */
+long long estimate_encoded_size(const estimate_report *report);
+
+/**
+ * @brief Returns the Shannon bound of the input: its size if every byte cost exactly its information content.
+ *
+ * @param report The result of estimate_stream().
+ * @return The bound in bytes, extrapolated to the whole input if blocks were skipped.
+ */
+double estimate_shannon_bound(const estimate_report *report);
+
+/**
+ * @brief Prints a report with the sizes and the code length of every byte that occurs.
+ *
+ * @param output The stream to print to.
+ * @param report The result of estimate_stream().
+ * @param codec The codec the report was made with.
+ */
+void estimate_print(FILE *output, const estimate_report *report, const huff_codec *codec);
+
+#endif /* ESTIMATE_H */
+
+/** @} */
@@ -0,0 +1,143 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         huff_profile.c
+ * Description:  Counters of the profiling build: the bits every symbol emits, the probes every decoded
+ *               symbol takes and the sizes of the write system calls, merged under one lock and
+ *               written as tab-separated records for offline analysis.
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "huff_profile.h"
+
+#define NUM_BLOCK_TYPES 256  // Block types are stored in one byte
+
+typedef struct profile_counters {
+    uint64_t symbols[256];
+    uint64_t symbol_bits[256];
+    uint64_t blocks[NUM_BLOCK_TYPES];
+    uint64_t block_raw[NUM_BLOCK_TYPES];
+    uint64_t block_payload[NUM_BLOCK_TYPES];
+    uint64_t probes[PROFILE_MAX_PROBES];
+    uint64_t write_calls[PROFILE_SIZE_CLASSES];
+    uint64_t write_bytes[PROFILE_SIZE_CLASSES];
+} profile_counters;
+
+static profile_counters counters;
+static pthread_mutex_t counters_mut = PTHREAD_MUTEX_INITIALIZER;
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+/*
+ * Returns the power-of-two class of a size: 0 for 0 and 1, otherwise the position of the highest set bit.
+ */
+static int size_class(size_t bytes)
+{
+    int class = 0;
+    while (bytes > 1) {
+        bytes >>= 1;
+        class++;
+    }
+    return class;
+}
+
+/* ------------------------------------ External functions ---------------------------------------------- */
+
+void profile_add_block(int type, const size_t *count, const uint8_t *code_length, size_t raw_size,
+                       size_t payload_size)
+{
+    pthread_mutex_lock(&counters_mut);
+    type &= NUM_BLOCK_TYPES - 1;
+    counters.blocks[type]++;
+    counters.block_raw[type] += raw_size;
+    counters.block_payload[type] += payload_size;
+
+    if (count != NULL) {
+        for (int i = 0; i < 256; i++) {
+            counters.symbols[i] += count[i];
+            if (code_length != NULL) {
+                counters.symbol_bits[i] += (uint64_t)count[i] * code_length[i];
+            }
+        }
+    }
+    pthread_mutex_unlock(&counters_mut);
+}
+
+void profile_add_symbol_bits(const uint64_t *symbol_bits)
+{
+    pthread_mutex_lock(&counters_mut);
+    for (int i = 0; i < 256; i++) {
+        counters.symbol_bits[i] += symbol_bits[i];
+    }
+    pthread_mutex_unlock(&counters_mut);
+}
+
+void profile_add_probes(const uint64_t *probes)
+{
+    pthread_mutex_lock(&counters_mut);
+    for (int i = 0; i < PROFILE_MAX_PROBES; i++) {
+        counters.probes[i] += probes[i];
+    }
+    pthread_mutex_unlock(&counters_mut);
+}
+
+void profile_add_write(size_t bytes)
+{
+    int class = size_class(bytes);
+
+    pthread_mutex_lock(&counters_mut);
+    counters.write_calls[class]++;
+    counters.write_bytes[class] += bytes;
+    pthread_mutex_unlock(&counters_mut);
+}
+
+void profile_dump(FILE *file)
+{
+    pthread_mutex_lock(&counters_mut);
+    for (int i = 0; i < 256; i++) {
+        if (counters.symbols[i] != 0) {
+            fprintf(file, "symbol_bits\t%d\t%llu\t%llu\n", i, (unsigned long long)counters.symbols[i],
+                    (unsigned long long)counters.symbol_bits[i]);
+        }
+    }
+    for (int i = 0; i < NUM_BLOCK_TYPES; i++) {
+        if (counters.blocks[i] != 0) {
+            fprintf(file, "block_type\t%d\t%llu\t%llu\t%llu\n", i, (unsigned long long)counters.blocks[i],
+                    (unsigned long long)counters.block_raw[i], (unsigned long long)counters.block_payload[i]);
+        }
+    }
+    for (int i = 0; i < PROFILE_MAX_PROBES; i++) {
+        if (counters.probes[i] != 0) {
+            fprintf(file, "probe_depth\t%d\t%llu\n", i, (unsigned long long)counters.probes[i]);
+        }
+    }
+    for (int i = 0; i < PROFILE_SIZE_CLASSES; i++) {
+        if (counters.write_calls[i] != 0) {
+            fprintf(file, "write_size\t%llu\t%llu\t%llu\n", i == 0 ? 0ull : 1ull << i,
+                    (unsigned long long)counters.write_calls[i], (unsigned long long)counters.write_bytes[i]);
+        }
+    }
+    pthread_mutex_unlock(&counters_mut);
+}
+
+void profile_dump_at_exit(void)
+{
+    const char *path = getenv("HUFF_PROFILE_OUT");
+    FILE *file = path != NULL ? fopen(path, "w") : NULL;
+
+    if (path != NULL && file == NULL) {
+        perror(path);
+    }
+    profile_dump(file != NULL ? file : stderr);
+    if (file != NULL) {
+        fclose(file);
+    }
+}
@@ -0,0 +1,101 @@
+/**
+ * @defgroup HuffProfile
+ * @brief Optional counters for tuning the codec: bits per symbol, decode probes and write sizes.
+ *
+ * Building with -DHUFF_PROFILE (see `make profile`) turns on three sets of counters:
+ *
+ * - The bits every byte value emits in Huffman and tANS blocks, and the raw and payload bytes of
+ *   every block type, to see which symbols dominate the output. A tANS symbol spends a varying
+ *   number of bits, so the encoder adds up what each one actually emitted.
+ * - How many probes each symbol of a decoded Huffman block takes: 1 when the decode table resolves
+ *   it, 1 + n when n more bits are walked in the tree after the table. This shows whether
+ *   DECODE_TABLE_BITS fits the codes. tANS blocks are not counted, a tANS symbol is always a single
+ *   table lookup.
+ * - The bytes of every write system call made by the output sink, by power-of-two size class.
+ *
+ * The coders count into local arrays and merge them once per block, so even the profiling build
+ * takes the lock only a few times per 64 KiB. Without HUFF_PROFILE the hooks are wrapped in
+ * PROFILE_ONLY() and compile to nothing, so the normal build is unchanged.
+ *
+ * The counters are written on exit as tab-separated lines, one record per line, to the file named by
+ * the environment variable HUFF_PROFILE_OUT, or to stderr:
+ *
+ *     symbol_bits  <byte>  <symbols>  <bits>
+ *     block_type   <type>  <blocks>   <raw bytes>  <payload bytes>
+ *     probe_depth  <probes>  <symbols>
+ *     write_size   <smallest size in class>  <calls>  <bytes>
+ *
+ * @section Author
+ *  - Author: Abdiaziz Ibrahim Adam
+ * @since Datum
+ *  - 18 October 2026
+ * @{
+ */
+
+#ifndef HUFF_PROFILE_H
+#define HUFF_PROFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef HUFF_PROFILE
+#define PROFILE_ONLY(...) __VA_ARGS__  ///< Keeps its argument in the profiling build only.
+#else
+#define PROFILE_ONLY(...)
+#endif
+
+#define PROFILE_MAX_PROBES 256   ///< Codes are at most 255 bits, so a symbol never takes more probes.
+#define PROFILE_SIZE_CLASSES 64  ///< One class per power of two a write size can have.
+
+/**
+ * @brief Adds the symbols of an encoded block.
+ *
+ * @param type The block type the block was encoded as.
+ * @param count The number of times each byte value occurs in the block, or NULL if the block type
+ *              does not code its symbols one by one (stored and RLE blocks).
+ * @param code_length The code length of each byte value, or NULL if the bits depend on the order of
+ *                    the symbols. tANS blocks add their bits with profile_add_symbol_bits() instead.
+ * @param raw_size The number of bytes in the block.
+ * @param payload_size The number of payload bytes the block was encoded to.
+ */
+void profile_add_block(int type, const size_t *count, const uint8_t *code_length, size_t raw_size,
+                       size_t payload_size);
+
+/**
+ * @brief Adds the bits the symbols of a tANS block emitted.
+ *
+ * @param symbol_bits Array of 256 bit counts, the bits spent on each byte value. The final state
+ *                    the decoder starts from belongs to no symbol and is not counted.
+ */
+void profile_add_symbol_bits(const uint64_t *symbol_bits);
+
+/**
+ * @brief Adds the probe counts of a decoded block.
+ *
+ * @param probes Array of PROFILE_MAX_PROBES counts, the number of symbols that took each number of probes.
+ */
+void profile_add_probes(const uint64_t *probes);
+
+/**
+ * @brief Adds one write system call.
+ *
+ * @param bytes The number of bytes it wrote.
+ */
+void profile_add_write(size_t bytes);
+
+/**
+ * @brief Writes all counters, in the format described above.
+ *
+ * @param file The file to write to.
+ */
+void profile_dump(FILE *file);
+
+/**
+ * @brief Writes all counters to HUFF_PROFILE_OUT or stderr. Meant to be registered with atexit().
+ */
+void profile_dump_at_exit(void);
+
+#endif /* HUFF_PROFILE_H */
+
+/** @} */
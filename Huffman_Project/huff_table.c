@@ -67,7 +67,9 @@ char** huff_table(Trie *root)
          huffmanTable[i] = NULL;
      }
 
-    trie_DFS(root, path, 0, huffmanTable);
+    if (root != NULL) {
+        trie_DFS(root, path, 0, huffmanTable);
+    }
 
     return huffmanTable;
 }
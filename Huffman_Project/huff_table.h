@@ -29,9 +29,10 @@
  * This function traverses a given Huffman trie to generate a table mapping byte values to Huffman codes.
  * The table is dynamically allocated and must be freed by the caller to avoid memory leaks.
  * 
- * @param root Pointer to the root node of the Huffman trie.
+ * @param root Pointer to the root node of the Huffman trie. May be NULL for an empty trie.
  * @return A dynamically allocated array of strings where each string represents the Huffman code for
- *         the corresponding byte value. The caller is responsible for freeing this table.
+ *         the corresponding byte value, or NULL for byte values that are not in the trie. The caller
+ *         is responsible for freeing this table.
  */
 char **huff_table(Trie *root);
 
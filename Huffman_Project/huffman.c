@@ -14,54 +14,455 @@
  * Date:         18 March 2024
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/resource.h>
 #include "huffman.h"
+#include "batch.h"
+#include "estimate.h"
+#include "emit_c.h"
+#include "train.h"
+#include "huff_profile.h"
 
 int main(int argc, const char *argv[]) 
 {
     files my_files;
 
+    PROFILE_ONLY(atexit(profile_dump_at_exit);)
+
+    // Training builds a table file and does not encode or decode anything.
+    if (argc > 1 && strcmp("-train", argv[1]) == 0) {
+        return train_table(argc, argv);
+    }
+
+    if (argc > 1 && (strcmp("-batch-encode", argv[1]) == 0 || strcmp("-batch-decode", argv[1]) == 0)) {
+        return run_batch(argc, argv);
+    }
+
+    // Estimating only reads the input file
+    if (argc > 1 && strcmp("-estimate", argv[1]) == 0) {
+        return run_estimate(argc, argv);
+    }
+
+    if (argc > 1 && strcmp("-emit-c", argv[1]) == 0) {
+        return run_emit_c(argc, argv);
+    }
+
+    if (argc > 1 && strcmp("-append", argv[1]) == 0) {
+        return run_append(argc, argv);
+    }
+
     // Check and parse command line arguments. If incorrect, terminate the program.
     if (validate_program_arguments(argc, argv, &my_files) != 0) {
         return 1; 
     }
 
-    int *frequency_table = create_frequency_table(my_files.in_frequency_file); 
+    int *frequency_table = load_frequency_table(my_files.in_frequency_file); 
+    if (frequency_table == NULL) {
+        fclose(my_files.in_frequency_file); 
+        fclose(my_files.in_file); 
+        fclose(my_files.out_file); 
+        return 1;
+    }
 
-    // Use the frequency table for Huffman tree construction
-    Trie *huffman_trie_root = build_huff_trie(frequency_table);
+    // Use the frequency table for Huffman tree and table construction
+    huff_codec *codec = codec_create(frequency_table);
+
+    if (codec != NULL) {
+        codec->memory_limit = my_files.memory_limit;
+    }
 
-    //The huffman table:
-    char **huffmanTable = huff_table(huffman_trie_root);
+    int exit_code = 0;
+    if (codec == NULL) {
+        exit_code = 1;
+    }
 
-    if (strcmp("-encode", argv[1]) == 0){
-        encode_file(my_files.in_file, my_files.out_file, huffmanTable) ;
+    else if (strcmp("-encode", argv[1]) == 0){
+        exit_code = encode_file(my_files.in_file, my_files.out_file, codec);
     }
 
     else if (strcmp("-decode", argv[1]) == 0){
-        decode_file(my_files.in_file, my_files.out_file, huffman_trie_root, huffmanTable);
+        codec->threads = my_files.num_threads;
+        exit_code = decode_file(my_files.in_file, my_files.out_file, codec);
+    }
+
+    if (codec != NULL && my_files.memory_limit != 0 && report_peak_memory(my_files.out_file, my_files.memory_limit) != 0) {
+        exit_code = 1;
     }
 
-    trie_kill(huffman_trie_root);
-    free_huff_table(huffmanTable);
+    codec_free(codec);
     free(frequency_table); 
 
     fclose(my_files.in_frequency_file); 
     fclose(my_files.in_file); 
-    fclose(my_files.out_file); 
+    if (fclose(my_files.out_file) != 0) {
+        exit_code = 1;
+    }
 
+    return exit_code;
+}
+
+size_t parse_size(const char *text)
+{
+    char *end;
+
+    // strtoull would take a sign, and wrap a negative size around
+    if (*text < '0' || *text > '9') {
+        return 0;
+    }
+    errno = 0;
+    unsigned long long size = strtoull(text, &end, 10);
+    if (errno == ERANGE || size > SIZE_MAX) {
+        return 0;
+    }
+
+    int shifts = 0;
+    switch (*end) {
+    case 'G': case 'g':
+        shifts++;
+        /* fall through */
+    case 'M': case 'm':
+        shifts++;
+        /* fall through */
+    case 'K': case 'k':
+        shifts++;
+        end++;
+        break;
+    default:
+        break;
+    }
+    for (int i = 0; i < shifts; i++) {
+        if (size > SIZE_MAX / 1024) {
+            return 0;
+        }
+        size *= 1024;
+    }
+    return *end == '\0' ? (size_t)size : 0;
+}
+
+int report_peak_memory(FILE *output, size_t memory_limit)
+{
+    struct rusage usage;
+    FILE *report = output == stdout ? stderr : stdout;
+
+    size_t peak = 0;
+    FILE *status = fopen("/proc/self/status", "r");
+    if (status != NULL) {
+        char line[256];
+        unsigned long kib;
+        while (fgets(line, sizeof(line), status) != NULL) {
+            if (sscanf(line, "VmHWM: %lu kB", &kib) == 1) {
+                peak = (size_t)kib * 1024;
+                break;
+            }
+        }
+        fclose(status);
+    }
+    // ru_maxrss is in KiB on Linux
+    if (peak == 0 && getrusage(RUSAGE_SELF, &usage) == 0) {
+        peak = (size_t)usage.ru_maxrss * 1024;
+    }
+    if (peak == 0) {
+        return 0;
+    }
+    fprintf(report, "Peak memory use: %zu KiB of %zu KiB allowed.\n\n", peak / 1024, memory_limit / 1024);
+    if (peak > memory_limit) {
+        fprintf(stderr, "The memory limit was exceeded.\n");
+        return 1;
+    }
+    return 0;
+}
+
+FILE *open_stream(const char *path, const char *mode)
+{
+    if (strcmp(path, "-") == 0) {
+        return mode[0] == 'r' ? stdin : stdout;
+    }
+    return fopen(path, mode);
+}
+
+int *load_frequency_table(FILE *file)
+{
+    if (table_file_detect(file)) {
+        return table_file_read(file);
+    }
+    return create_frequency_table(file);
+}
+
+int run_batch(int argc, const char *argv[])
+{
+    int num_workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (argc == 7 && strcmp("-j", argv[5]) == 0) {
+        num_workers = atoi(argv[6]);
+    } else if (argc != 5) {
+        error_message();
+        return 1;
+    }
+    if (num_workers < 1) {
+        num_workers = 1;
+    }
+
+    FILE *frequency_file = fopen(argv[2], "rb");
+    if (frequency_file == NULL) {
+        error_message();
+        return 1;
+    }
+    int *frequency_table = load_frequency_table(frequency_file);
+    fclose(frequency_file);
+    if (frequency_table == NULL) {
+        return 1;
+    }
+
+    // The codec is built once and shared by all workers
+    huff_codec *codec = codec_create(frequency_table);
+    free(frequency_table);
+    if (codec == NULL) {
+        return 1;
+    }
+
+    bool encode = strcmp("-batch-encode", argv[1]) == 0;
+    int exit_code = batch_run(encode, argv[3], argv[4], num_workers, codec);
+
+    codec_free(codec);
+    return exit_code;
+}
+
+int run_estimate(int argc, const char *argv[])
+{
+    int sample_every = 1;
+
+    if (argc == 6 && strcmp("-sample", argv[4]) == 0) {
+        sample_every = atoi(argv[5]);
+    } else if (argc != 4) {
+        error_message();
+        return 1;
+    }
+
+    FILE *frequency_file = fopen(argv[2], "rb");
+    if (frequency_file == NULL) {
+        error_message();
+        return 1;
+    }
+    int *frequency_table = load_frequency_table(frequency_file);
+    fclose(frequency_file);
+    if (frequency_table == NULL) {
+        return 1;
+    }
+
+    huff_codec *codec = codec_create(frequency_table);
+    free(frequency_table);
+    if (codec == NULL) {
+        return 1;
+    }
+
+    FILE *input = fopen(argv[3], "rb");
+    if (input == NULL) {
+        codec_free(codec);
+        error_message();
+        return 1;
+    }
+
+    estimate_report report;
+    int exit_code = 0;
+    if (estimate_stream(input, codec, sample_every, &report) != 0) {
+        fprintf(stderr, "Failed to read %s\n", argv[3]);
+        exit_code = 1;
+    } else {
+        estimate_print(stdout, &report, codec);
+    }
+
+    fclose(input);
+    codec_free(codec);
+    return exit_code;
+}
+
+int run_emit_c(int argc, const char *argv[])
+{
+    if (argc != 4) {
+        error_message();
+        return 1;
+    }
+
+    FILE *frequency_file = fopen(argv[2], "rb");
+    if (frequency_file == NULL) {
+        error_message();
+        return 1;
+    }
+    int *frequency_table = load_frequency_table(frequency_file);
+    fclose(frequency_file);
+    if (frequency_table == NULL) {
+        return 1;
+    }
+
+    huff_codec *codec = codec_create(frequency_table);
+    free(frequency_table);
+    if (codec == NULL) {
+        return 1;
+    }
+
+    FILE *output = fopen(argv[3], "w");
+    if (output == NULL) {
+        codec_free(codec);
+        error_message();
+        return 1;
+    }
+
+    int exit_code = 0;
+    if (emit_c_tables(output, codec, argv[2]) != 0) {
+        fprintf(stderr, "Failed to write %s: the table has no codes, a code is longer than %d bits or writing failed\n",
+                argv[3], EMIT_C_MAX_CODE_LENGTH);
+        exit_code = 1;
+    }
+
+    if (fclose(output) != 0) {
+        exit_code = 1;
+    }
+    codec_free(codec);
+    return exit_code;
+}
+
+int run_append(int argc, const char *argv[])
+{
+    if (argc != 5) {
+        error_message();
+        return 1;
+    }
+
+    FILE *frequency_file = fopen(argv[2], "rb");
+    if (frequency_file == NULL) {
+        error_message();
+        return 1;
+    }
+    int *frequency_table = load_frequency_table(frequency_file);
+    fclose(frequency_file);
+    if (frequency_table == NULL) {
+        return 1;
+    }
+
+    huff_codec *codec = codec_create(frequency_table);
+    free(frequency_table);
+    if (codec == NULL) {
+        return 1;
+    }
+
+    FILE *input = open_stream(argv[3], "rb");
+    if (input == NULL) {
+        codec_free(codec);
+        error_message();
+        return 1;
+    }
+
+    // A missing or empty FILE2 is encoded into as a new file
+    int exit_code = 0;
+    FILE *archive = fopen(argv[4], "r+b");
+    if (archive != NULL && fseek(archive, 0, SEEK_END) == 0 && ftell(archive) > 0) {
+        exit_code = append_file(input, archive, codec);
+    } else {
+        if (archive != NULL) {
+            fclose(archive);
+        }
+        archive = fopen(argv[4], "wb");
+        if (archive == NULL) {
+            error_message();
+            exit_code = 1;
+        } else {
+            exit_code = encode_file(input, archive, codec);
+        }
+    }
+
+    if (archive != NULL && fclose(archive) != 0) {
+        exit_code = 1;
+    }
+    fclose(input);
+    codec_free(codec);
+    return exit_code;
+}
+
+int train_table(int argc, const char *argv[])
+{
+    int num_workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int num_sources = argc - 3;
+
+    if (argc >= 6 && strcmp("-j", argv[argc - 2]) == 0) {
+        num_workers = atoi(argv[argc - 1]);
+        num_sources -= 2;
+    }
+    if (num_sources < 1) {
+        error_message();
+        return 1;
+    }
+    if (num_workers < 1) {
+        num_workers = 1;
+    }
+
+    long long totals[256] = {0};
+    int num_files;
+    if (train_count(&argv[3], num_sources, num_workers, totals, &num_files) != 0) {
+        return 1;
+    }
+    if (num_files == 0) {
+        fprintf(stderr, "No sample files found\n");
+        return 1;
+    }
+
+    int *trained_table = table_file_finish(totals);
+    if (trained_table == NULL) {
+        return 1;
+    }
+
+    FILE *out = fopen(argv[2], "wb");
+    if (out == NULL) {
+        perror(argv[2]);
+        free(trained_table);
+        return 1;
+    }
+
+    int write_result = table_file_write(out, trained_table);
+    if (fclose(out) != 0 || write_result != 0) {
+        fprintf(stderr, "Failed to write table file %s\n", argv[2]);
+        free(trained_table);
+        return 1;
+    }
+
+    printf("\nTrained on %d sample files. Table ID %08x written to %s.\n\n",
+           num_files, (unsigned)table_id(trained_table), argv[2]);
+    free(trained_table);
     return 0;
 }
 
 
 int validate_program_arguments(int argc, const char *argv[], files *my_files)
 {
-    if (argc != 5){
+    my_files->num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    my_files->memory_limit = 0;
+    if (argc < 5 || argc % 2 == 0) {
         error_message();
         return 1;
     }
+    for (int i = 5; i < argc; i += 2) {
+        if (strcmp("-j", argv[i]) == 0 && strcmp("-decode", argv[1]) == 0) {
+            my_files->num_threads = atoi(argv[i + 1]);
+        } else if (strcmp("-memlimit", argv[i]) == 0) {
+            my_files->memory_limit = parse_size(argv[i + 1]);
+            if (my_files->memory_limit < MEMLIMIT_MIN) {
+                fprintf(stderr, "-memlimit must be at least %zu KiB\n", ((size_t)MEMLIMIT_MIN + 1023) / 1024);
+                return 1;
+            }
+        } else {
+            error_message();
+            return 1;
+        }
+    }
+    if (my_files->num_threads < 1) {
+        my_files->num_threads = 1;
+    }
 
     if (strcmp("-encode", argv[1])!= 0 && strcmp("-decode", argv[1])!= 0) {
         error_message();
@@ -74,13 +475,13 @@ int validate_program_arguments(int argc, const char *argv[], files *my_files)
         return 1;
     }
 
-    my_files->in_file = fopen(argv[3], "rb");
+    my_files->in_file = open_stream(argv[3], "rb");
     if (my_files->in_file== NULL){
         error_message();
         return 1;
     }
 
-    my_files->out_file = fopen(argv[4], "wb");
+    my_files->out_file = open_stream(argv[4], "wb");
     if (my_files->out_file == NULL){
         error_message();
         return 1;
@@ -95,5 +496,25 @@ void error_message(void)
     "huffman [OPTION] [FILE0] [FILE1] [FILE2]\n" 
     "Options:\n" 
     "-encode encodes FILE1 according to frequence analysis done on FILE0. Stores the result in FILE2\n"
-    "-decode decodes FILE1 according to frequence analysis done on FILE0. Stores the result in FILE2\n\n");
+    "-decode decodes FILE1 according to frequence analysis done on FILE0. Stores the result in FILE2\n"
+    "        A file in the old single-bitstream format is decoded on N threads with -j N after FILE2.\n"
+    "        FILE0 may also be a table file created with -train.\n"
+    "        FILE1 - reads from stdin and FILE2 - writes to stdout; the byte counts then go to stderr.\n"
+    "        -memlimit SIZE after FILE2 bounds the buffers to SIZE bytes (K, M or G suffix) for any\n"
+    "        input size, and reports the peak memory use. Under a smaller SIZE fewer blocks are in\n"
+    "        flight, and a block too large for the limit is refused.\n\n"
+    "huffman -train [TABLE] [SAMPLE|DIR]... [-j N]\n"
+    "-train  aggregates the frequencies of all SAMPLE files, and of all files in each DIR, into the\n"
+    "        table file TABLE. The samples are counted on N threads, by default one per CPU.\n\n"
+    "huffman -batch-encode [FILE0] [SOURCE] [DIR] [-j N]\n"
+    "huffman -batch-decode [FILE0] [SOURCE] [DIR] [-j N]\n"
+    "-batch-encode encodes every file in the directory or manifest SOURCE into DIR on N worker threads\n"
+    "-batch-decode decodes every file in the directory or manifest SOURCE into DIR on N worker threads\n\n"
+    "huffman -estimate [FILE0] [FILE1] [-sample N]\n"
+    "-estimate predicts the size of FILE1 encoded with FILE0 without encoding it, sampling every Nth block\n\n"
+    "huffman -emit-c [FILE0] [HEADER]\n"
+    "-emit-c writes the code and decode tables of FILE0 as a C header for static_codec.c\n\n"
+    "huffman -append [FILE0] [FILE1] [FILE2]\n"
+    "-append encodes FILE1 according to FILE0 and adds it to the end of the encoded file FILE2\n"
+    "        FILE1 may be - for stdin. FILE2 must be a regular file.\n\n");
 }
@@ -26,6 +26,20 @@
  * - "huffman_tree.c"      : Implements the logic for constructing the Huffman tree based on the frequency table.
  * - "encoding_decoding.h" : Defines interfaces for encoding and decoding functions, tying together the Huffman tree and bit buffer operations.
  * - "encoding_decoding.c" : Implements the core logic for converting input data into encoded format and vice versa.
+ * - "table_file.h/.c"     : Trains shared frequency tables from sample files and stores them in versioned table files.
+ * - "batch.h/.c"          : Encodes or decodes a directory or manifest of files on a pool of worker threads.
+ * - "decode_table.h/.c"   : Table-driven, bounds-checked decoding with structured error codes.
+ * - "checksum.h/.c"       : Computes the CRC32C checksums that protect every block of an encoded file.
+ * - "byte_io.h/.c"        : Reads and writes the little-endian integers used in table files and file headers.
+ * - "estimate.h/.c"       : Predicts the encoded size of a file from its histograms, next to the Shannon bound.
+ * - "pipeline.h/.c"       : Overlaps reading, coding and writing of blocks on three threads.
+ * - "tans.h/.c"           : tANS coding, chosen per block when it beats the Huffman codes on skewed data.
+ * - "emit_c.h/.c"         : Writes the tables of a frequency file as a C header (the -emit-c mode).
+ * - "static_codec.h/.c"   : Encoder and decoder compiled against that header, with no setup at startup.
+ * - "parallel_decode.h/.c": Decodes an old single-bitstream file on several threads.
+ * - "output_sink.h/.c"    : Buffers the writes of the pipeline and writes them with few system calls.
+ * - "train.h/.c"          : Counts the bytes of many training samples on several threads.
+ * - "huff_profile.h/.c"   : Counters of the profiling build (make profile), off in the normal build.
  *
  * @section datatypes Datatypes
  *
@@ -96,6 +110,10 @@
 #include "Huff_Trie.h"
 #include "huff_table.h"
 #include "encode_decode.h"
+#include "table_file.h"
+#include "pipeline.h"
+
+#define MEMLIMIT_MIN PIPELINE_MIN_MEMORY  ///< The smallest -memlimit: the program, its tables, one pipeline slot and a one-block write buffer.
 
 /**
  * @brief Structure to hold file pointers for input and output files.
@@ -108,6 +126,8 @@ typedef struct files {
     FILE *in_frequency_file; ///< File pointer for the input frequency analysis file.
     FILE *in_file;           ///< File pointer for the input file to encode/decode.
     FILE *out_file;          ///< File pointer for the output file where the result is stored.
+    int num_threads;         ///< The number of threads an old single-bitstream file is decoded on (-j N).
+    size_t memory_limit;     ///< The bytes the buffers may use (-memlimit SIZE), 0 for no limit.
 } files;
 
 /**
@@ -125,6 +145,116 @@ typedef struct files {
  */
 int validate_program_arguments(int argc, const char *argv[], files *file);
 
+/**
+ * @brief Opens the file at path, or the standard stream for the path "-".
+ *
+ * "-" is stdin when mode is a read mode and stdout otherwise, so that huffman can read from and
+ * write to pipes. Encoding and decoding never seek in these files.
+ *
+ * @param path The path of the file, or "-".
+ * @param mode The mode to open the file in, as for fopen().
+ * @return The opened file, stdin or stdout, or NULL if the file could not be opened.
+ */
+FILE *open_stream(const char *path, const char *mode);
+
+/**
+ * @brief Parses a size in bytes with an optional K, M or G suffix for KiB, MiB or GiB.
+ *
+ * @param text The size, e.g. "64M".
+ * @return The number of bytes, or 0 if text is not a size or the size does not fit in a size_t.
+ */
+size_t parse_size(const char *text);
+
+/**
+ * @brief Prints the peak resident memory of the process and checks it against a memory limit.
+ *
+ * The peak is VmHWM from /proc/self/status where there is one, since ru_maxrss also counts the
+ * memory of the parent process from before the program was executed. The report goes to stdout, or
+ * to stderr if the output file is stdout.
+ *
+ * @param output The output file of the encoding or decoding.
+ * @param memory_limit The limit given with -memlimit.
+ * @return 0 if the peak stayed within the limit, otherwise 1.
+ */
+int report_peak_memory(FILE *output, size_t memory_limit);
+
+/**
+ * @brief Loads the frequency table used for encoding or decoding.
+ *
+ * The frequency source is either a table file created with `-train`, or any other file whose
+ * byte frequencies are counted with create_frequency_table().
+ *
+ * @param file Pointer to the opened frequency source. Must be seekable.
+ * @return A dynamically allocated array of 256 counts, or NULL if the table file could not be read.
+ *         The caller is responsible for freeing it.
+ */
+int *load_frequency_table(FILE *file);
+
+/**
+ * @brief Trains a shared frequency table from sample files (the `-train` mode).
+ *
+ * Expects the arguments `-train TABLE SAMPLE|DIR... [-j N]`. A directory stands for all regular
+ * files in it. The samples are counted on N threads, see train.h, and the summed frequencies are
+ * written to the table file TABLE, see table_file.h.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv An array of strings containing the command-line arguments.
+ * @return 0 on success, 1 on failure.
+ */
+int train_table(int argc, const char *argv[]);
+
+/**
+ * @brief Encodes or decodes many files in one process (the `-batch-encode` and `-batch-decode` modes).
+ *
+ * Expects the arguments `-batch-encode FILE0 SOURCE DIR [-j N]`, where SOURCE is a directory or a
+ * manifest file and N is the number of worker threads (the number of processors by default).
+ * The codec is built once from FILE0 and shared by all workers, see batch.h.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv An array of strings containing the command-line arguments.
+ * @return 0 if all files were processed successfully, otherwise 1.
+ */
+int run_batch(int argc, const char *argv[]);
+
+/**
+ * @brief Predicts the encoded size of a file without encoding it (the `-estimate` mode).
+ *
+ * Expects the arguments `-estimate FILE0 FILE1 [-sample N]`. FILE1 is read once and a report with
+ * its encoded size, the Shannon bound and the code lengths is printed, see estimate.h. With
+ * `-sample N` only every Nth block is read and the sizes are extrapolated.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv An array of strings containing the command-line arguments.
+ * @return 0 on success, 1 on failure.
+ */
+int run_estimate(int argc, const char *argv[]);
+
+/**
+ * @brief Writes the tables of a frequency file as a C header (the `-emit-c` mode).
+ *
+ * Expects the arguments `-emit-c FILE0 HEADER`. The codec built from FILE0 is written to HEADER as
+ * static const arrays, which static_codec.c compiles against, see emit_c.h.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv An array of strings containing the command-line arguments.
+ * @return 0 on success, 1 on failure.
+ */
+int run_emit_c(int argc, const char *argv[]);
+
+/**
+ * @brief Adds a file to the end of an encoded file (the `-append` mode).
+ *
+ * Expects the arguments `-append FILE0 FILE1 FILE2`. FILE1 is encoded with the codec built from FILE0
+ * and its blocks replace the end block of FILE2, which must have been encoded with the same table.
+ * The blocks already in FILE2 are not read or recompressed, and decoding FILE2 afterwards gives its
+ * old contents followed by FILE1. A missing or empty FILE2 is encoded into like with `-encode`.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv An array of strings containing the command-line arguments.
+ * @return 0 on success, 1 on failure.
+ */
+int run_append(int argc, const char *argv[]);
+
 /**
  * @brief Displays an error message.
  *
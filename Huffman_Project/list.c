@@ -1,7 +1,11 @@
 /*
  * A data type representing a list.
  *
- * The list is implemented as an dubble linked list.
+ * The list is implemented as an dubble linked list. A pooled list takes
+ * its nodes from slabs of many nodes and keeps removed nodes on a free
+ * list, so that it stops calling malloc once the slabs are warm. Only
+ * the tests and bench_pqueue use pooled lists, the priority queue is a
+ * heap.
  *
  * For more information see the corresponding .h-file.
  *
@@ -35,23 +39,44 @@ struct node
 };
 
 
+/* A structure used to represent a slab of nodes in a pooled list.
+ *
+ * @elem next       A pointer to the slab allocated before or NULL.
+ * @elem nodes      The nodes of the slab.
+ */
+struct slab
+{
+	struct slab *next;
+	struct node nodes[];
+};
+
+
 /* A structure used to represent a list.
  *
  * @elem first      A pointer to the first node in the list or NULL.
  * @elem end        A pointer to the last node in the list or NULL.
  * @elem mfunc      The function for handling dynamically allocated
  *                  memory.
+ * @elem slabs      The slabs of a pooled list or NULL.
+ * @elem free_nodes Unused nodes of the slabs, linked by next.
+ * @elem slab_nodes The number of nodes in a new slab, 0 if the list
+ *                  is not pooled.
  */
 struct list
 {
 	struct node *first;
 	struct node *end;
 	list_mem_func mfunc;
+	struct slab *slabs;
+	struct node *free_nodes;
+	size_t slab_nodes;
 };
 
 
 /* Declaration of internal functions */
-static struct node *make_node(void *value);
+static struct node *make_node(list *const l, void *value);
+static void add_slab(list *const l, size_t nodes);
+static void release_node(list *const l, struct node *n);
 
 
 /* ---------------------- External functions ---------------------- */
@@ -70,11 +95,40 @@ list *list_empty(void)
 	l->first = NULL;
 	l->end = NULL;
 	l->mfunc = NULL;
+	l->slabs = NULL;
+	l->free_nodes = NULL;
+	l->slab_nodes = 0;
+
+	return l;
+}
+
+
+list *list_empty_pooled(size_t slab_nodes)
+{
+	assert(slab_nodes > 0);
+
+	list *l = list_empty();
+	l->slab_nodes = slab_nodes;
 
 	return l;
 }
 
 
+void list_reserve(list *const l, size_t nodes)
+{
+	assert(l->slab_nodes > 0);
+
+	size_t available = 0;
+	for (struct node *n = l->free_nodes; n != NULL && available < nodes;
+	     n = n->next) {
+		available++;
+	}
+	if (available < nodes) {
+		add_slab(l, nodes - available);
+	}
+}
+
+
 bool list_is_empty(const list *const l)
 {
 	return l->first == NULL;
@@ -147,13 +201,13 @@ void* list_inspect(const list *const l, const list_position pos)
 }
 
 
-list_position list_insert(const list *const l,
+list_position list_insert(list *const l,
                           const list_position pos,
                           void *value)
 {
 	assert(l != NULL);
 
-	struct node *n = make_node(value);
+	struct node *n = make_node(l, value);
 	n->next = *pos.forward;
 	n->prev = *pos.backward;
 	*pos.forward = n;
@@ -177,20 +231,31 @@ list_position list_remove(list *const l, list_position pos)
 	if(l->mfunc != NULL) {
 		l->mfunc(n->value);
 	}
-	free(n);
+	release_node(l, n);
 
 	return pos;
 }
 
 void list_kill(list *l)
 {
-	while (l->first != NULL) {
-		struct node *n = l->first;
-		l->first = n->next;
-		if(l->mfunc != NULL) {
-			l->mfunc(n->value);
+	// The nodes of a pooled list go with their slabs, so they are only
+	// visited if their values have to be deallocated
+	if (l->slab_nodes == 0 || l->mfunc != NULL) {
+		while (l->first != NULL) {
+			struct node *n = l->first;
+			l->first = n->next;
+			if(l->mfunc != NULL) {
+				l->mfunc(n->value);
+			}
+			if (l->slab_nodes == 0) {
+				free(n);
+			}
 		}
-		free(n);
+	}
+	while (l->slabs != NULL) {
+		struct slab *s = l->slabs;
+		l->slabs = s->next;
+		free(s);
 	}
 	free(l);
 }
@@ -199,16 +264,27 @@ void list_kill(list *l)
 /* ---------------------- Internal function ----------------------- */
 
 /**
- * @brief           Creats a new node.
+ * @brief           Creats a new node, from the free nodes of a pooled
+ *                  list or with malloc.
  *
+ * @param l         The list the node is for.
  * @param value     The value to put in the new node.
- * @param mem_func  The memory function.
  * @return          A pointer to the new node.
  */
-static struct node *make_node(void *value)
+static struct node *make_node(list *const l, void *value)
 {
-	struct node *n = malloc(sizeof *n);
-	assert(n != NULL);
+	struct node *n;
+
+	if (l->slab_nodes > 0) {
+		if (l->free_nodes == NULL) {
+			add_slab(l, l->slab_nodes);
+		}
+		n = l->free_nodes;
+		l->free_nodes = n->next;
+	} else {
+		n = malloc(sizeof *n);
+		assert(n != NULL);
+	}
 
 	n->next = NULL;
 	n->prev = NULL;
@@ -216,3 +292,43 @@ static struct node *make_node(void *value)
 
 	return n;
 }
+
+
+/**
+ * @brief           Allocates a slab and puts its nodes on the free list.
+ *
+ * @param l         The pooled list.
+ * @param nodes     The number of nodes in the slab.
+ * @return          -
+ */
+static void add_slab(list *const l, size_t nodes)
+{
+	struct slab *s = malloc(sizeof *s + nodes * sizeof(struct node));
+	assert(s != NULL);
+
+	s->next = l->slabs;
+	l->slabs = s;
+	for (size_t i = 0; i < nodes; i++) {
+		s->nodes[i].next = l->free_nodes;
+		l->free_nodes = &s->nodes[i];
+	}
+}
+
+
+/**
+ * @brief           Returns a removed node to the free list of a pooled
+ *                  list, or frees it.
+ *
+ * @param l         The list the node was removed from.
+ * @param n         The node.
+ * @return          -
+ */
+static void release_node(list *const l, struct node *n)
+{
+	if (l->slab_nodes > 0) {
+		n->next = l->free_nodes;
+		l->free_nodes = n;
+	} else {
+		free(n);
+	}
+}
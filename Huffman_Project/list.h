@@ -20,6 +20,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
  * @brief          Function used for handling the data pointed to in
@@ -65,6 +66,38 @@ void list_set_memhandler(list *const l, const list_mem_func mem_func);
  */
 list *list_empty(void);
 
+/**
+ * @brief          Allocate an empty pooled list. Its nodes are
+ *                 allocated in slabs of slab_nodes nodes, and removed
+ *                 nodes are kept for later inserts instead of being
+ *                 deallocated. Once the list has had as many nodes as
+ *                 it will ever have, inserts and removes do not
+ *                 allocate memory. The memory should be deallocated
+ *                 using the function list_kill, which deallocates the
+ *                 slabs at once without visiting every node unless a
+ *                 memory handler is set.
+ *
+ *                 Since the priority queue became a heap, no part of
+ *                 the Huffman program uses a pooled list; only the
+ *                 tests and the list baseline of bench_pqueue do.
+ *
+ * @param slab_nodes The number of nodes allocated at a time. Must be
+ *                 greater than 0.
+ * @return         The new list.
+ */
+list *list_empty_pooled(size_t slab_nodes);
+
+/**
+ * @brief          Make sure that at least nodes more nodes can be
+ *                 inserted into a pooled list without allocating
+ *                 memory. The missing nodes are allocated as one slab.
+ *
+ * @param l        The pooled list.
+ * @param nodes    The number of nodes to have ready.
+ * @return         -
+ */
+void list_reserve(list *const l, size_t nodes);
+
 /**
  * @brief          Check if the list is empty or not.
  *
@@ -148,7 +181,7 @@ void* list_inspect(const list *const l, const list_position pos);
  * @param value    The value to be inserted.
  * @return         The position of the new node in the list.
  */
-list_position list_insert(const list *const l,
+list_position list_insert(list *const l,
                           const list_position pos,
                           void *value);
 
@@ -0,0 +1,156 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         output_sink.c
+ * Description:  Collects writes in a large buffer and hands them to the file descriptor with as few
+ *               write() and writev() calls as possible.
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include "output_sink.h"
+#include "huff_profile.h"
+
+struct output_sink {
+    int fd;
+    unsigned char *buffer;
+    size_t capacity;
+    size_t used;
+    bool aligned;
+    size_t syscalls;
+};
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+/*
+ * Writes all bytes of up to two pieces with writev(), continuing after partial writes and signals.
+ */
+static int write_all(output_sink *sink, struct iovec *pieces, int count)
+{
+    while (count > 0) {
+        ssize_t written = writev(sink->fd, pieces, count);
+        sink->syscalls++;
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        PROFILE_ONLY(profile_add_write((size_t)written);)
+        // Skip the pieces that were written completely, and the written part of the next
+        while (count > 0 && (size_t)written >= pieces[0].iov_len) {
+            written -= (ssize_t)pieces[0].iov_len;
+            pieces++;
+            count--;
+        }
+        if (count > 0) {
+            pieces[0].iov_base = (unsigned char *)pieces[0].iov_base + written;
+            pieces[0].iov_len -= (size_t)written;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Writes size bytes of the buffer and moves the rest to its front.
+ */
+static int drain(output_sink *sink, size_t size)
+{
+    struct iovec piece = {sink->buffer, size};
+
+    if (size > 0 && write_all(sink, &piece, 1) != 0) {
+        return -1;
+    }
+    memmove(sink->buffer, sink->buffer + size, sink->used - size);
+    sink->used -= size;
+    return 0;
+}
+
+/* ------------------------------------ External functions ---------------------------------------------- */
+
+output_sink *sink_create(int fd, size_t capacity, bool aligned)
+{
+    output_sink *sink = malloc(sizeof(output_sink));
+    if (sink == NULL) {
+        return NULL;
+    }
+
+    if (aligned) {
+        capacity = (capacity + SINK_ALIGNMENT - 1) / SINK_ALIGNMENT * SINK_ALIGNMENT;
+        void *buffer = NULL;
+        sink->buffer = posix_memalign(&buffer, SINK_ALIGNMENT, capacity) == 0 ? buffer : NULL;
+    } else {
+        sink->buffer = malloc(capacity);
+    }
+    if (capacity == 0 || sink->buffer == NULL) {
+        free(sink->buffer);
+        free(sink);
+        return NULL;
+    }
+
+    sink->fd = fd;
+    sink->capacity = capacity;
+    sink->used = 0;
+    sink->aligned = aligned;
+    sink->syscalls = 0;
+    return sink;
+}
+
+int sink_write(output_sink *sink, const void *data, size_t size)
+{
+    const unsigned char *bytes = data;
+
+    if (sink->used + size <= sink->capacity) {
+        memcpy(sink->buffer + sink->used, bytes, size);
+        sink->used += size;
+        return 0;
+    }
+
+    if (!sink->aligned) {
+        // The buffer and the new bytes go out together, without copying the new bytes
+        struct iovec pieces[2] = {{sink->buffer, sink->used}, {(void *)bytes, size}};
+        sink->used = 0;
+        return write_all(sink, pieces, 2);
+    }
+
+    // An aligned sink fills its buffer and writes it whole, as often as needed
+    while (size > 0) {
+        size_t part = sink->capacity - sink->used < size ? sink->capacity - sink->used : size;
+        memcpy(sink->buffer + sink->used, bytes, part);
+        sink->used += part;
+        bytes += part;
+        size -= part;
+        if (sink->used == sink->capacity && drain(sink, sink->capacity) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int sink_flush(output_sink *sink)
+{
+    return drain(sink, sink->used);
+}
+
+size_t sink_syscalls(const output_sink *sink)
+{
+    return sink->syscalls;
+}
+
+void sink_free(output_sink *sink)
+{
+    if (sink != NULL) {
+        free(sink->buffer);
+        free(sink);
+    }
+}
@@ -0,0 +1,83 @@
+/**
+ * @defgroup OutputSink
+ * @brief Buffered writing to a file descriptor with few system calls.
+ *
+ * Writing every block with its own call costs a system call per 64 KiB, and stdio copies small
+ * writes through a buffer of a few KiB. A sink collects the writes in one large buffer instead. When
+ * a write does not fit, the buffer and the new bytes are written together with a single writev(),
+ * so large writes are not copied at all.
+ *
+ * An aligned sink keeps its buffer aligned to SINK_ALIGNMENT and only ever writes whole multiples of
+ * it, except for the last write of sink_flush(). Such a sink can write to a file opened with
+ * O_DIRECT, as long as everything written to the file goes through the sink.
+ *
+ * @section Author
+ *  - Author: Abdiaziz Ibrahim Adam
+ * @since Datum
+ *  - 18 October 2026
+ * @{
+ */
+
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SINK_CAPACITY (1 << 20)   ///< The default buffer size, a few system calls per megabyte.
+#define SINK_ALIGNMENT 4096       ///< The alignment of the buffer and the writes of an aligned sink.
+
+/**
+ * @brief A buffer in front of a file descriptor.
+ */
+typedef struct output_sink output_sink;
+
+/**
+ * @brief Creates a sink writing to a file descriptor.
+ *
+ * @warning Memory allocation: It's the caller's responsibility to free the sink using sink_free().
+ *
+ * @param fd The file descriptor to write to. It is not closed by the sink.
+ * @param capacity The buffer size. An aligned sink rounds it up to a multiple of SINK_ALIGNMENT.
+ * @param aligned True to write only whole multiples of SINK_ALIGNMENT from an aligned buffer.
+ * @return The sink, or NULL if memory allocation failed.
+ */
+output_sink *sink_create(int fd, size_t capacity, bool aligned);
+
+/**
+ * @brief Writes bytes to the sink. They reach the file descriptor when the buffer is full or on
+ *        sink_flush().
+ *
+ * @param sink The sink.
+ * @param data The bytes to write.
+ * @param size The number of bytes.
+ * @return 0 on success, -1 if a write to the file descriptor failed.
+ */
+int sink_write(output_sink *sink, const void *data, size_t size);
+
+/**
+ * @brief Writes all buffered bytes to the file descriptor.
+ *
+ * @param sink The sink.
+ * @return 0 on success, -1 if a write failed.
+ */
+int sink_flush(output_sink *sink);
+
+/**
+ * @brief Returns the number of write() and writev() calls the sink has made.
+ *
+ * @param sink The sink.
+ * @return The number of system calls.
+ */
+size_t sink_syscalls(const output_sink *sink);
+
+/**
+ * @brief Frees a sink without flushing it.
+ *
+ * @param sink The sink, or NULL.
+ */
+void sink_free(output_sink *sink);
+
+#endif /* OUTPUT_SINK_H */
+
+/** @} */
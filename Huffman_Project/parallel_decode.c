@@ -0,0 +1,261 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         parallel_decode.c
+ * Description:  Decodes one legacy bitstream with speculative decoders started at evenly spaced bit
+ *               offsets, one thread each, and stitches their outputs where they synchronise with the
+ *               true code boundaries.
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "parallel_decode.h"
+
+/*
+ * One segment of the stream and what its speculative decoder found.
+ */
+typedef struct segment {
+    const decode_table *decoder;
+    const unsigned char *data;
+    size_t size;
+    size_t start;            // The first bit of the segment
+    size_t end;              // The bit after the segment
+    uint8_t *starts;         // Bit (pos - start) is set if a decoded code starts at pos
+    unsigned char *out;      // The speculatively decoded bytes
+    size_t out_size;
+    size_t out_capacity;
+    size_t exit;             // Where decoding stopped: the first code start at or after end, or the failing code
+    bool failed;             // True if an invalid code, the end of the data or lack of memory stopped the decoder
+    bool started;            // True if the segment's thread was started
+    pthread_t thread;
+} segment;
+
+/*
+ * The stitched output.
+ */
+typedef struct output {
+    unsigned char *bytes;
+    size_t size;
+    size_t capacity;
+} output;
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+static int append(unsigned char **bytes, size_t *size, size_t *capacity, const unsigned char *add, size_t count)
+{
+    if (*size + count > *capacity) {
+        size_t new_capacity = *capacity > 0 ? *capacity : 4096;
+        while (new_capacity < *size + count) {
+            new_capacity *= 2;
+        }
+        unsigned char *new_bytes = realloc(*bytes, new_capacity);
+        if (new_bytes == NULL) {
+            return -1;
+        }
+        *bytes = new_bytes;
+        *capacity = new_capacity;
+    }
+    memcpy(*bytes + *size, add, count);
+    *size += count;
+    return 0;
+}
+
+/*
+ * Checks whether the speculative decoder started a code at pos. Without a record of code starts the
+ * answer is always no, so the segment is decoded sequentially.
+ */
+static bool is_start(const segment *s, size_t pos)
+{
+    size_t bit = pos - s->start;
+    return s->starts != NULL && pos >= s->start && pos < s->end && (s->starts[bit / 8] >> (bit % 8)) & 1;
+}
+
+/*
+ * Returns the number of codes the speculative decoder started before pos.
+ */
+static size_t count_starts(const segment *s, size_t pos)
+{
+    size_t bits = pos - s->start;
+    size_t count = 0;
+
+    for (size_t i = 0; i < bits / 8; i++) {
+        count += __builtin_popcount(s->starts[i]);
+    }
+    if (bits % 8 != 0) {
+        count += __builtin_popcount(s->starts[bits / 8] & ((1u << (bits % 8)) - 1));
+    }
+    return count;
+}
+
+/*
+ * Decodes a segment from its first bit as if a code started there, until the first code that starts
+ * at or after the end of the segment.
+ */
+static void *decode_segment(void *arg)
+{
+    segment *s = arg;
+    bit_reader reader;
+
+    bit_reader_init_at(&reader, s->data, s->size, s->start);
+    while (reader.consumed < s->end) {
+        size_t pos = reader.consumed;
+        int byte = decode_table_symbol(s->decoder, &reader);
+        unsigned char decoded = (unsigned char)byte;
+
+        if (byte < 0 || bit_reader_overrun(&reader) ||
+            append(&s->out, &s->out_size, &s->out_capacity, &decoded, 1) != 0) {
+            s->failed = true;
+            reader.consumed = pos;
+            break;
+        }
+        size_t bit = pos - s->start;
+        s->starts[bit / 8] |= (uint8_t)(1u << (bit % 8));
+    }
+    s->exit = reader.consumed;
+    return NULL;
+}
+
+/*
+ * Appends decoded bytes up to the EOT. Returns 1 if the EOT was found, 0 if not, -1 if memory ran out.
+ */
+static int append_until_eot(output *result, const unsigned char *bytes, size_t count)
+{
+    const unsigned char *eot = memchr(bytes, PARALLEL_EOT, count);
+    size_t length = eot != NULL ? (size_t)(eot - bytes) : count;
+
+    if (append(&result->bytes, &result->size, &result->capacity, bytes, length) != 0) {
+        return -1;
+    }
+    return eot != NULL;
+}
+
+/*
+ * Stitches one segment onto the output. entry is the first true code boundary at or after the start
+ * of the segment, and is moved to the first one at or after its end. Returns DECODE_OK with *done
+ * set once the EOT was decoded or the stream failed, otherwise DECODE_OK to go on.
+ */
+static decode_status stitch_segment(const segment *s, output *result, size_t *entry, bool *done)
+{
+    bit_reader reader;
+    bool synced = false;
+
+    while (*entry < s->end) {
+        // Decode sequentially until a code boundary that the speculative decoder also had
+        bit_reader_init_at(&reader, s->data, s->size, *entry);
+        while (reader.consumed < s->end && (synced || !is_start(s, reader.consumed))) {
+            int byte = decode_table_symbol(s->decoder, &reader);
+            if (bit_reader_overrun(&reader) || byte < 0) {
+                *done = true;
+                return bit_reader_overrun(&reader) ? DECODE_TRUNCATED : DECODE_INVALID_CODE;
+            }
+            unsigned char decoded = (unsigned char)byte;
+            int found = append_until_eot(result, &decoded, 1);
+            if (found != 0) {
+                *done = true;
+                return found < 0 ? DECODE_NO_MEMORY : DECODE_OK;
+            }
+        }
+        *entry = reader.consumed;
+        if (*entry >= s->end) {
+            break;
+        }
+
+        // From here on the speculative output is the true output
+        size_t first = count_starts(s, *entry);
+        int found = append_until_eot(result, s->out + first, s->out_size - first);
+        if (found != 0) {
+            *done = true;
+            return found < 0 ? DECODE_NO_MEMORY : DECODE_OK;
+        }
+        *entry = s->exit;
+        synced = true;   // A failed decoder is followed sequentially to the same failure
+    }
+    return DECODE_OK;
+}
+
+/*
+ * Decodes the whole stream on the calling thread.
+ */
+static decode_status decode_sequential(const decode_table *decoder, const unsigned char *data, size_t size,
+                                       output *result)
+{
+    segment whole = {decoder, data, size, 0, SIZE_MAX, NULL, NULL, 0, 0, 0, false, false, 0};
+    size_t entry = 0;
+    bool done = false;
+
+    decode_status status = stitch_segment(&whole, result, &entry, &done);
+    return done ? status : DECODE_TRUNCATED;
+}
+
+/* ------------------------------------ External functions ---------------------------------------------- */
+
+decode_status parallel_decode_bitstream(const decode_table *decoder, const unsigned char *data, size_t size,
+                                        int num_threads, unsigned char **out, size_t *out_size)
+{
+    output result = {NULL, 0, 0};
+    decode_status status = DECODE_OK;
+
+    size_t num_segments = size / PARALLEL_MIN_SEGMENT;
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+    if (num_segments > (size_t)num_threads) {
+        num_segments = num_threads;
+    }
+
+    segment *segments = num_segments > 1 ? calloc(num_segments, sizeof(segment)) : NULL;
+    if (segments == NULL) {
+        status = decode_sequential(decoder, data, size, &result);
+        *out = result.bytes;
+        *out_size = result.size;
+        return status;
+    }
+
+    size_t total_bits = size * 8;
+    for (size_t i = 0; i < num_segments; i++) {
+        segment *s = &segments[i];
+        s->decoder = decoder;
+        s->data = data;
+        s->size = size;
+        s->start = total_bits / num_segments * i;
+        s->end = i + 1 < num_segments ? total_bits / num_segments * (i + 1) : total_bits;
+        s->starts = calloc((s->end - s->start) / 8 + 1, 1);
+        if (s->starts != NULL && pthread_create(&s->thread, NULL, decode_segment, s) == 0) {
+            s->started = true;
+        }
+    }
+
+    // Stitch in order, so later segments are still decoding while earlier ones are stitched
+    size_t entry = 0;
+    bool done = false;
+    for (size_t i = 0; i < num_segments; i++) {
+        segment *s = &segments[i];
+        if (s->started) {
+            pthread_join(s->thread, NULL);
+        }
+        // A segment whose thread did not start has no code starts and is decoded sequentially
+        if (!done) {
+            status = stitch_segment(s, &result, &entry, &done);
+        }
+    }
+    if (!done) {
+        status = DECODE_TRUNCATED;
+    }
+
+    for (size_t i = 0; i < num_segments; i++) {
+        free(segments[i].starts);
+        free(segments[i].out);
+    }
+    free(segments);
+    *out = result.bytes;
+    *out_size = result.size;
+    return status;
+}
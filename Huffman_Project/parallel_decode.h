@@ -0,0 +1,54 @@
+/**
+ * @defgroup ParallelDecode
+ * @brief Decodes a single legacy bitstream on several threads.
+ *
+ * Files without a header and version 1 files hold one EOT-terminated bitstream with no block index,
+ * so where a code starts is only known by decoding everything before it. Huffman codes tend to
+ * resynchronise, though: a decoder started at an arbitrary bit soon produces a code boundary that
+ * the correct decoding also has, and from there on both decode the same bytes.
+ *
+ * The stream is therefore cut into evenly spaced segments, and every segment is decoded
+ * speculatively on its own thread, from its first bit, recording the bit position of every code it
+ * decodes. The calling thread then stitches the segments in order: it knows the first true code
+ * boundary in each segment from the previous one, decodes from there sequentially until it reaches
+ * a boundary the speculative decoder also had, and takes the rest of the speculative output as it
+ * is. A segment that never synchronises is decoded sequentially in full, so the result is always
+ * exactly that of a sequential decoder.
+ *
+ * @section Author
+ *  - Author: Abdiaziz Ibrahim Adam
+ * @since Datum
+ *  - 18 October 2026
+ * @{
+ */
+
+#ifndef PARALLEL_DECODE_H
+#define PARALLEL_DECODE_H
+
+#include <stddef.h>
+#include "decode_table.h"
+
+#define PARALLEL_MIN_SEGMENT (1 << 16)  ///< The fewest input bytes a segment is given, smaller ones do not pay off.
+#define PARALLEL_EOT 4                  ///< The byte that ends a legacy bitstream.
+
+/**
+ * @brief Decodes an EOT-terminated bitstream, splitting it over up to num_threads threads.
+ *
+ * @warning Memory allocation: It's the caller's responsibility to free *out.
+ *
+ * @param decoder The decode table of the tree the stream was written with.
+ * @param data The bitstream.
+ * @param size The number of bytes.
+ * @param num_threads The largest number of speculative decoders. 1 or a short stream decodes sequentially.
+ * @param out Pointer to where the decoded bytes are stored, the EOT excluded. On errors it holds the
+ *            bytes decoded before the error, like a sequential decoder would have written.
+ * @param out_size Pointer to where the number of decoded bytes is stored.
+ * @return DECODE_OK, DECODE_INVALID_CODE, DECODE_TRUNCATED if the stream ends before the EOT, or
+ *         DECODE_NO_MEMORY.
+ */
+decode_status parallel_decode_bitstream(const decode_table *decoder, const unsigned char *data, size_t size,
+                                        int num_threads, unsigned char **out, size_t *out_size);
+
+#endif /* PARALLEL_DECODE_H */
+
+/** @} */
@@ -0,0 +1,433 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         pipeline.c
+ * Description:  Overlaps reading, coding and writing of blocks on three threads that hand the
+ *               blocks to each other through a ring of slots. Every slot goes from free to read to
+ *               coded and back to free, and all three stages visit the slots in the same order, so
+ *               the blocks are written in the order they were read.
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "pipeline.h"
+#include "byte_io.h"
+#include "output_sink.h"
+
+typedef enum slot_state {
+    SLOT_FREE,   // Waiting for the reader
+    SLOT_READ,   // Waiting for the coder
+    SLOT_CODED   // Waiting for the writer
+} slot_state;
+
+typedef struct slot {
+    slot_state state;
+    bool last;                    // The reader reached the end; no more slots follow
+    unsigned char *in;            // A raw block, or a block header followed by the payload
+    size_t in_size;
+    size_t in_capacity;
+    block_header header;          // The parsed header when decoding
+    unsigned char *out;           // An encoded block, or decoded bytes
+    const unsigned char *result;  // The bytes to write: out, or the payload of a stored block
+    size_t result_size;
+} slot;
+
+typedef struct pipeline {
+    bool encode;
+    FILE *input;
+    FILE *output;
+    const huff_codec *codec;
+    block_index *index;           // The encoded blocks so far; only updated by the writer
+    slot slots[PIPELINE_SLOTS];
+    size_t num_slots;             // The slots in use, fewer than PIPELINE_SLOTS under a memory limit
+    output_sink *sink;            // Collects the writes of the writer to the output's file descriptor
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+    bool stopped;                 // Set on the first error
+    size_t stop_at;               // The block that failed; the stages finish the blocks before it
+    decode_status status;
+    long bytes_in;                // Only updated by the reader
+    long bytes_out;               // Only updated by the writer
+} pipeline;
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+/*
+ * Waits until a slot reaches a state. The blocks before the one that failed still reach every stage,
+ * so that the output of a failed run is the same as a sequential coder's.
+ *
+ * @param seq The number of the block the slot is waited for with.
+ * @return True when the slot is in the state, false if the pipeline was stopped at or before the block.
+ */
+static bool wait_for(pipeline *p, slot *s, slot_state state, size_t seq)
+{
+    pthread_mutex_lock(&p->mutex);
+    while (s->state != state && !(p->stopped && seq >= p->stop_at)) {
+        pthread_cond_wait(&p->changed, &p->mutex);
+    }
+    bool running = !(p->stopped && seq >= p->stop_at);
+    pthread_mutex_unlock(&p->mutex);
+    return running;
+}
+
+/*
+ * Passes a slot on to the next stage.
+ */
+static void hand_over(pipeline *p, slot *s, slot_state state)
+{
+    pthread_mutex_lock(&p->mutex);
+    s->state = state;
+    pthread_cond_broadcast(&p->changed);
+    pthread_mutex_unlock(&p->mutex);
+}
+
+/*
+ * Stops all stages at a block. Only the error of the earliest block is kept, as that is the one a
+ * sequential coder would have run into.
+ *
+ * @param seq The number of the block that failed, 0 to stop at once.
+ */
+static void stop(pipeline *p, decode_status status, size_t seq)
+{
+    pthread_mutex_lock(&p->mutex);
+    if (!p->stopped || seq < p->stop_at) {
+        p->stopped = true;
+        p->stop_at = seq;
+        p->status = status;
+    }
+    pthread_cond_broadcast(&p->changed);
+    pthread_mutex_unlock(&p->mutex);
+}
+
+/*
+ * Reads the next raw block to encode.
+ */
+static decode_status read_raw_block(pipeline *p, slot *s)
+{
+    s->in_size = fread(s->in, 1, BLOCK_SIZE, p->input);
+    if (s->in_size == 0) {
+        if (ferror(p->input)) {
+            return DECODE_IO_ERROR;
+        }
+        s->last = true;
+    }
+    p->bytes_in += s->in_size;
+    return DECODE_OK;
+}
+
+/*
+ * Reads the next block header and its payload.
+ */
+static decode_status read_encoded_block(pipeline *p, slot *s)
+{
+    if (fread(s->in, 1, BLOCK_HEADER_SIZE, p->input) != BLOCK_HEADER_SIZE) {
+        return ferror(p->input) ? DECODE_IO_ERROR : DECODE_TRUNCATED;
+    }
+    p->bytes_in += BLOCK_HEADER_SIZE;
+
+    decode_status status = block_header_read(s->in, &s->header);
+    if (status != DECODE_OK) {
+        return status;
+    }
+    if (s->header.type == BLOCK_END) {
+        p->bytes_in += skip_bytes(p->input, s->header.payload_size);
+        s->last = true;
+        return DECODE_OK;
+    }
+
+    // No valid block is larger than a stored one, which fits; under a limit the slot must not grow
+    size_t size = BLOCK_HEADER_SIZE + s->header.payload_size;
+    if (size > s->in_capacity && p->codec->memory_limit != 0) {
+        return DECODE_OVER_LIMIT;
+    }
+    if (size > s->in_capacity) {
+        unsigned char *grown = realloc(s->in, size);
+        if (grown == NULL) {
+            return DECODE_NO_MEMORY;
+        }
+        s->in = grown;
+        s->in_capacity = size;
+    }
+    if (fread(s->in + BLOCK_HEADER_SIZE, 1, s->header.payload_size, p->input) != s->header.payload_size) {
+        return ferror(p->input) ? DECODE_IO_ERROR : DECODE_TRUNCATED;
+    }
+    p->bytes_in += s->header.payload_size;
+    s->in_size = size;
+    return DECODE_OK;
+}
+
+/*
+ * The reader stage: fills free slots until the end of the input.
+ */
+static void *reader_main(void *arg)
+{
+    pipeline *p = arg;
+
+    for (size_t i = 0; ; i++) {
+        slot *s = &p->slots[i % p->num_slots];
+        if (!wait_for(p, s, SLOT_FREE, i)) {
+            break;
+        }
+
+        decode_status status = p->encode ? read_raw_block(p, s) : read_encoded_block(p, s);
+        if (status != DECODE_OK) {
+            stop(p, status, i);
+            break;
+        }
+        bool last = s->last;
+        hand_over(p, s, SLOT_READ);
+        if (last) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * The writer stage: writes coded slots and frees them.
+ */
+static void *writer_main(void *arg)
+{
+    pipeline *p = arg;
+
+    for (size_t i = 0; ; i++) {
+        slot *s = &p->slots[i % p->num_slots];
+        if (!wait_for(p, s, SLOT_CODED, i) || s->last) {
+            break;
+        }
+
+        // The reader and the coder are further on, so stopping here stops them too
+        if (sink_write(p->sink, s->result, s->result_size) != 0) {
+            stop(p, DECODE_IO_ERROR, i);
+            break;
+        }
+        if (p->encode && block_index_add(p->index, (uint32_t)s->in_size, (uint32_t)s->result_size) != 0) {
+            stop(p, DECODE_NO_MEMORY, i);
+            break;
+        }
+        p->bytes_out += s->result_size;
+        hand_over(p, s, SLOT_FREE);
+    }
+    return NULL;
+}
+
+/*
+ * The coder stage, run on the calling thread: encodes or decodes read slots.
+ */
+static void run_coder(pipeline *p)
+{
+    bit_buffer *buffer = p->encode ? bit_buffer_empty() : NULL;
+
+    for (size_t i = 0; ; i++) {
+        slot *s = &p->slots[i % p->num_slots];
+        if (!wait_for(p, s, SLOT_READ, i)) {
+            break;
+        }
+        if (s->last) {
+            hand_over(p, s, SLOT_CODED);
+            break;
+        }
+
+        if (p->encode) {
+            s->result_size = encode_block(p->codec, buffer, s->in, s->in_size, s->out);
+            s->result = s->out;
+        } else {
+            decode_status status = decode_block(p->codec, p->codec->decoder, &s->header,
+                                                s->in + BLOCK_HEADER_SIZE, s->out, &s->result);
+            if (status != DECODE_OK) {
+                stop(p, status, i);
+                break;
+            }
+            s->result_size = s->header.raw_size;
+        }
+        hand_over(p, s, SLOT_CODED);
+    }
+
+    if (buffer != NULL) {
+        bit_buffer_free(buffer);
+    }
+}
+
+/*
+ * Returns the bytes of a memory limit the buffers of the pipeline may use.
+ */
+static size_t buffer_budget(size_t memory_limit)
+{
+    return memory_limit > PIPELINE_RESERVED_BYTES ? memory_limit - PIPELINE_RESERVED_BYTES : 0;
+}
+
+static void pipeline_free(pipeline *p)
+{
+    for (int i = 0; i < PIPELINE_SLOTS; i++) {
+        free(p->slots[i].in);
+        free(p->slots[i].out);
+    }
+    pthread_cond_destroy(&p->changed);
+    pthread_mutex_destroy(&p->mutex);
+    free(p);
+}
+
+static pipeline *pipeline_create(bool encode, FILE *input, FILE *output, const huff_codec *codec)
+{
+    pipeline *p = calloc(1, sizeof(pipeline));
+    if (p == NULL) {
+        return NULL;
+    }
+
+    p->encode = encode;
+    p->input = input;
+    p->output = output;
+    p->codec = codec;
+    p->status = DECODE_OK;
+    p->num_slots = pipeline_slots(codec->memory_limit);
+    pthread_mutex_init(&p->mutex, NULL);
+    pthread_cond_init(&p->changed, NULL);
+
+    // Encoded blocks are never larger than a header and a stored block
+    for (size_t i = 0; i < p->num_slots; i++) {
+        slot *s = &p->slots[i];
+        s->in_capacity = encode ? BLOCK_SIZE : BLOCK_HEADER_SIZE + BLOCK_SIZE;
+        s->in = malloc(s->in_capacity);
+        s->out = malloc(encode ? BLOCK_HEADER_SIZE + BLOCK_SIZE : BLOCK_SIZE);
+        if (s->in == NULL || s->out == NULL) {
+            pipeline_free(p);
+            return NULL;
+        }
+    }
+    return p;
+}
+
+/*
+ * Runs the three stages until the input is exhausted or an error occurs.
+ */
+static decode_status pipeline_run(pipeline *p)
+{
+    pthread_t reader;
+    pthread_t writer;
+
+    // The writer bypasses stdio, so what stdio holds must be written first
+    if (fflush(p->output) != 0) {
+        return DECODE_IO_ERROR;
+    }
+    p->sink = sink_create(fileno(p->output), pipeline_sink_capacity(p->codec->memory_limit), false);
+    if (p->sink == NULL) {
+        return DECODE_NO_MEMORY;
+    }
+
+    if (pthread_create(&reader, NULL, reader_main, p) != 0) {
+        sink_free(p->sink);
+        return DECODE_NO_MEMORY;
+    }
+    if (pthread_create(&writer, NULL, writer_main, p) != 0) {
+        stop(p, DECODE_NO_MEMORY, 0);
+        pthread_join(reader, NULL);
+        sink_free(p->sink);
+        return DECODE_NO_MEMORY;
+    }
+
+    run_coder(p);
+
+    pthread_join(reader, NULL);
+    pthread_join(writer, NULL);
+
+    // The blocks written before an error are kept, like a sequential coder would have
+    if (sink_flush(p->sink) != 0 && p->status == DECODE_OK) {
+        p->status = DECODE_IO_ERROR;
+    }
+    sink_free(p->sink);
+    return p->status;
+}
+
+/* ------------------------------------ External functions ---------------------------------------------- */
+
+size_t pipeline_slots(size_t memory_limit)
+{
+    if (memory_limit == 0) {
+        return PIPELINE_SLOTS;
+    }
+    size_t budget = buffer_budget(memory_limit);
+    size_t slots = budget > BLOCK_SIZE ? (budget - BLOCK_SIZE) / PIPELINE_SLOT_BYTES : 0;
+    return slots < 1 ? 1 : slots > PIPELINE_SLOTS ? PIPELINE_SLOTS : slots;
+}
+
+size_t pipeline_sink_capacity(size_t memory_limit)
+{
+    if (memory_limit == 0) {
+        return SINK_CAPACITY;
+    }
+    size_t budget = buffer_budget(memory_limit);
+    size_t slot_bytes = pipeline_slots(memory_limit) * PIPELINE_SLOT_BYTES;
+    size_t capacity = budget > slot_bytes ? budget - slot_bytes : 0;
+    return capacity < BLOCK_SIZE ? BLOCK_SIZE : capacity > SINK_CAPACITY ? SINK_CAPACITY : capacity;
+}
+
+int pipeline_encode(FILE *input, FILE *output, const huff_codec *codec, codec_stats *stats)
+{
+    block_index index = {NULL, 0, 0};
+
+    write_file_header(output, codec);
+    int result = pipeline_encode_blocks(input, output, codec, &index, stats);
+    stats->bytes_out += HUFF_HEADER_SIZE;
+    block_index_free(&index);
+    return result;
+}
+
+int pipeline_encode_blocks(FILE *input, FILE *output, const huff_codec *codec, block_index *index,
+                           codec_stats *stats)
+{
+    pipeline *p = pipeline_create(true, input, output, codec);
+
+    stats->bytes_in = 0;
+    stats->bytes_out = 0;
+    if (p == NULL) {
+        return -1;
+    }
+
+    p->index = index;
+    decode_status status = pipeline_run(p);
+    if (status == DECODE_OK && write_end_block(output, index) != 0) {
+        status = DECODE_IO_ERROR;
+    }
+
+    stats->bytes_in = p->bytes_in;
+    stats->bytes_out = p->bytes_out + end_block_size(index->count);
+    pipeline_free(p);
+    return status != DECODE_OK || ferror(output) ? -1 : 0;
+}
+
+decode_status pipeline_decode(FILE *input, FILE *output, const huff_codec *codec, codec_stats *stats)
+{
+    unsigned char header[HUFF_HEADER_SIZE];
+    size_t header_size = fread(header, 1, sizeof(header), input);
+
+    if (header_size < HUFF_HEADER_SIZE || memcmp(header, HUFF_MAGIC, 4) != 0 ||
+        header[4] != HUFF_FORMAT_VERSION) {
+        return decode_stream_with_header(input, output, codec, stats, header, header_size);
+    }
+
+    stats->bytes_in = header_size;
+    stats->bytes_out = 0;
+    if (get_u32(header + 5) != codec->table_id) {
+        return DECODE_TABLE_MISMATCH;
+    }
+
+    pipeline *p = pipeline_create(false, input, output, codec);
+    if (p == NULL) {
+        return DECODE_NO_MEMORY;
+    }
+
+    decode_status status = pipeline_run(p);
+    stats->bytes_in += p->bytes_in;
+    stats->bytes_out = p->bytes_out;
+    pipeline_free(p);
+    return status;
+}
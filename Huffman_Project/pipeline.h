@@ -0,0 +1,98 @@
+/**
+ * @defgroup Pipeline
+ * @brief Encodes and decodes with reading, coding and writing overlapped on three threads.
+ *
+ * When one thread reads, codes and writes in turn, the coding stalls whenever the disk is slow. The
+ * pipeline hides this latency: a reader thread reads ahead, the calling thread encodes or decodes,
+ * and a writer thread writes behind. The stages hand blocks to each other through a bounded ring of
+ * PIPELINE_SLOTS slots, so memory use is fixed and the reader can never run away from the writer.
+ * Under a memory limit fewer slots and a smaller write buffer are used, see pipeline_slots() and
+ * pipeline_sink_capacity(), and a block whose payload would not fit in a slot is refused.
+ *
+ * The output is byte for byte the same as that of encode_stream() and decode_stream().
+ *
+ * @section Author
+ *  - Author: Abdiaziz Ibrahim Adam
+ * @since Datum
+ *  - 18 October 2026
+ * @{
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdio.h>
+#include "encode_decode.h"
+
+#define PIPELINE_SLOTS 8  ///< The number of blocks that can be in flight between the stages.
+#define PIPELINE_SLOT_BYTES (2 * BLOCK_SIZE + BLOCK_HEADER_SIZE)  ///< The buffers of one slot.
+#define PIPELINE_RESERVED_BYTES (3 * 1024 * 1024)  ///< The part of a memory limit left to the program itself: code, libraries, code tables and stacks.
+#define PIPELINE_MIN_MEMORY (PIPELINE_RESERVED_BYTES + PIPELINE_SLOT_BYTES + BLOCK_SIZE)  ///< The smallest memory limit: one slot and a sink of one block.
+
+/**
+ * @brief Returns the number of slots the pipeline uses under a memory limit.
+ *
+ * The buffers may use what PIPELINE_RESERVED_BYTES leaves of the limit. The slots take it first,
+ * after a write buffer of one block. At least one slot is used, which makes the stages take turns
+ * instead of overlapping.
+ *
+ * @param memory_limit The limit of huff_codec.memory_limit, 0 for none. At least PIPELINE_MIN_MEMORY
+ *        for the bound to hold.
+ * @return Between 1 and PIPELINE_SLOTS.
+ */
+size_t pipeline_slots(size_t memory_limit);
+
+/**
+ * @brief Returns the size of the writer's buffer under a memory limit.
+ *
+ * The buffer gets what the slots leave of the limit, between BLOCK_SIZE and SINK_CAPACITY.
+ *
+ * @param memory_limit The limit of huff_codec.memory_limit, 0 for none.
+ * @return The capacity of the output sink in bytes.
+ */
+size_t pipeline_sink_capacity(size_t memory_limit);
+
+/**
+ * @brief Encodes an input file into an output file on three threads.
+ *
+ * @param input Pointer to a FILE structure for the input file. Must be opened in read mode.
+ * @param output Pointer to a FILE structure for the output file. Must be opened in write mode.
+ * @param codec The codec to encode with.
+ * @param stats Pointer to where the byte counts are stored.
+ * @return 0 on success, -1 if reading, writing or starting the threads failed.
+ */
+int pipeline_encode(FILE *input, FILE *output, const huff_codec *codec, codec_stats *stats);
+
+/**
+ * @brief Encodes an input file as blocks and an end block, without a file header.
+ *
+ * Used to append to an existing file: the blocks are written where the old end block was, and the
+ * new end block indexes both the old blocks and the new ones.
+ *
+ * @param input Pointer to a FILE structure for the input file. Must be opened in read mode.
+ * @param output Pointer to a FILE structure for the output file, positioned where the blocks go.
+ * @param codec The codec to encode with.
+ * @param index The index of the blocks before the output position. The new blocks are added to it.
+ * @param stats Pointer to where the byte counts are stored.
+ * @return 0 on success, -1 if reading, writing, indexing or starting the threads failed.
+ */
+int pipeline_encode_blocks(FILE *input, FILE *output, const huff_codec *codec, block_index *index,
+                           codec_stats *stats);
+
+/**
+ * @brief Decodes an encoded file into an output file on three threads.
+ *
+ * Files in the current format are decoded by the pipeline. Files in older formats have no blocks to
+ * overlap, or too few, and are handed to decode_stream_with_header().
+ *
+ * @param input Pointer to a FILE structure for the encoded file. Must be opened in read mode.
+ * @param output Pointer to a FILE structure for the output file. Must be opened in write mode.
+ * @param codec The codec to decode with.
+ * @param stats Pointer to where the byte counts are stored.
+ * @return DECODE_OK on success, otherwise the decode_status describing the error.
+ */
+decode_status pipeline_decode(FILE *input, FILE *output, const huff_codec *codec, codec_stats *stats);
+
+#endif /* PIPELINE_H */
+
+/** @} */
@@ -1,10 +1,17 @@
 /*
  * A data type representing a priority gueue.
  *
- * The data type represent a priority queue. The priority queue uses
- * a list as the internal representation. Takes a compare function
- * when creating a new priority queue, the compare function is used
- * to determine priority of elements within the priority queue.
+ * The data type represent a priority queue. The priority queue is a
+ * d-ary min-heap stored in an array. Takes a compare function when
+ * creating a new priority queue, the compare function is used to
+ * determine priority of elements within the priority queue. A queue
+ * without a compare function orders its elements by integer keys,
+ * which are compared without calling a function.
+ *
+ * Elements of equal priority leave the queue in the order they were
+ * inserted, as they did from the sorted list this queue used before.
+ * Every element therefore carries its insertion number, which breaks
+ * ties.
  *
  * For more information see the corresponding .h-file.
  *
@@ -19,30 +26,89 @@
  */
 
 #include <stdlib.h>
-#include "list.h"
+#include <stdint.h>
 #include "pqueue.h"
 #include <assert.h>
 
+/* The number of children of a heap node. Four children make the heap
+ * half as deep as a binary heap, and the children of a node share a
+ * cache line. */
+#define ARITY 4
+
+/* The number of elements a new queue has room for. */
+#define INITIAL_CAPACITY 16
+
 /* A structure used to represent an element in a priority queue.
  *
- * @elem the_list  A pointer to the internally used list.
+ * @elem value     The value of the element.
+ * @elem key       The priority of the element in a queue without a
+ *                 compare function.
+ * @elem seq       The insertion number of the element.
+ */
+struct element {
+	void *value;
+	long long key;
+	uint64_t seq;
+};
+
+/* A structure used to represent a priority queue.
+ *
+ * @elem elements  The heap of elements.
+ * @elem size      The number of elements.
+ * @elem capacity  The number of elements there is room for.
+ * @elem next_seq  The insertion number of the next element.
  * @elem cmp_func  The function used to decide priority between
- *                 elements in the priority queue.
+ *                 elements in the priority queue, or NULL to use the
+ *                 keys.
+ * @elem mfunc     The function for handling dynamically allocated
+ *                 memory, or NULL.
  */
 struct pqueue {
-	list *the_list;
+	struct element *elements;
+	size_t size;
+	size_t capacity;
+	uint64_t next_seq;
 	pqueue_cmp_func cmp_func;
+	pqueue_mem_func mfunc;
 };
 
 
+/* Declaration of internal functions */
+static inline bool before(const pqueue *const pq,
+                          const struct element *a,
+                          const struct element *b);
+static void sift_up(pqueue *const pq, size_t i);
+static void sift_down(pqueue *const pq, size_t i);
+static void heapify(pqueue *const pq);
+static void reserve(pqueue *const pq, size_t size);
+static void push(pqueue *const pq, long long key, void *value);
+
+
+/* ---------------------- External functions ---------------------- */
+
 pqueue* pqueue_empty(pqueue_cmp_func cmp_func)
 {
 	pqueue* pq = malloc(sizeof *pq);
 	assert(pq);
 
-	pq->the_list = list_empty();
-	assert(pq->the_list);
+	pq->elements = malloc(INITIAL_CAPACITY * sizeof *pq->elements);
+	assert(pq->elements);
+	pq->size = 0;
+	pq->capacity = INITIAL_CAPACITY;
+	pq->next_seq = 0;
 	pq->cmp_func = cmp_func;
+	pq->mfunc = NULL;
+
+	return pq;
+}
+
+
+pqueue *pqueue_build_from_array(pqueue_cmp_func cmp_func,
+                                void **values, size_t n)
+{
+	pqueue *pq = pqueue_empty(cmp_func);
+
+	pqueue_insert_many(pq, values, n);
 
 	return pq;
 }
@@ -52,19 +118,26 @@ void pqueue_set_memhandler(const pqueue *const pq,
                            pqueue_mem_func mfunc)
 {
 	assert(pq);
-	assert(pq->the_list);
 
-	list_set_memhandler(pq->the_list, mfunc);
+	// The handler belongs to the queue, not to its order, so it may
+	// be set through a pointer to a const queue as before
+	((pqueue *)pq)->mfunc = mfunc;
 }
 
 
 void pqueue_delete_first(pqueue *const pq)
 {
 	assert(pq);
-	assert(pq->the_list);
 
-	if(!list_is_empty(pq->the_list)) {
-		list_remove(pq->the_list, list_first(pq->the_list));
+	if(pq->size > 0) {
+		if(pq->mfunc != NULL) {
+			pq->mfunc(pq->elements[0].value);
+		}
+		pq->size--;
+		if(pq->size > 0) {
+			pq->elements[0] = pq->elements[pq->size];
+			sift_down(pq, 0);
+		}
 	}
 }
 
@@ -72,23 +145,39 @@ void pqueue_delete_first(pqueue *const pq)
 void pqueue_insert(pqueue *const pq, void *value)
 {
 	assert(pq);
-	assert(pq->the_list);
 
-	if(list_is_empty(pq->the_list)) {
-		list_insert(pq->the_list, list_first(pq->the_list), value);
+	push(pq, 0, value);
+	sift_up(pq, pq->size - 1);
+}
+
+
+void pqueue_insert_key(pqueue *const pq, long long key, void *value)
+{
+	assert(pq);
+	assert(pq->cmp_func == NULL);
+
+	push(pq, key, value);
+	sift_up(pq, pq->size - 1);
+}
+
+
+void pqueue_insert_many(pqueue *const pq, void **values, size_t n)
+{
+	assert(pq);
+
+	// Sifting up costs O(log size) per element and rebuilding the
+	// heap O(size + n) in all, so many elements are cheaper to heapify
+	size_t old_size = pq->size;
+	reserve(pq, old_size + n);
+	for(size_t i = 0; i < n; i++) {
+		push(pq, 0, values[i]);
+	}
+	if(n > old_size) {
+		heapify(pq);
 	} else {
-		list_position pos = list_first(pq->the_list);
-		while(!list_is_end(pq->the_list, pos)) {
-			if(pq->cmp_func != NULL) {
-				if(pq->cmp_func(value, list_inspect(pq->the_list,
-					                                 pos)) < 0) {
-					list_insert(pq->the_list, pos, value);
-					return;
-				}
-			}
-			pos = list_next(pq->the_list, pos);
+		for(size_t i = old_size; i < pq->size; i++) {
+			sift_up(pq, i);
 		}
-		list_insert(pq->the_list, pos, value);
 	}
 }
 
@@ -96,27 +185,30 @@ void pqueue_insert(pqueue *const pq, void *value)
 void* pqueue_inspect_first(const pqueue *const pq)
 {
 	assert(pq);
-	assert(pq->the_list);
+	assert(pq->size > 0);
 
-	return list_inspect(pq->the_list, list_first(pq->the_list));
+	return pq->elements[0].value;
 }
 
 
 bool pqueue_is_empty(const pqueue *const pq)
 {
 	assert(pq);
-	assert(pq->the_list);
 
-	return list_is_empty(pq->the_list);
+	return pq->size == 0;
 }
 
 
 void pqueue_kill(pqueue *pq)
 {
 	assert(pq);
-	assert(pq->the_list);
 
-	list_kill(pq->the_list);
+	if(pq->mfunc != NULL) {
+		for(size_t i = 0; i < pq->size; i++) {
+			pq->mfunc(pq->elements[i].value);
+		}
+	}
+	free(pq->elements);
 	free(pq);
 }
 
@@ -127,13 +219,156 @@ void pqueue_print(const pqueue *const pq,
                   pqueue_print_func print_func)
 {
 	assert(pq);
-	assert(pq->the_list);
 
-	list_position pos = list_first(pq->the_list);
-	while(!list_is_end(pq->the_list, pos)){
-		print_func(list_inspect(pq->the_list, pos));
-		pos = list_next(pq->the_list, pos);
+	for(size_t i = 0; i < pq->size; i++) {
+		print_func(pq->elements[i].value);
 	}
 }
 
 
+/* ---------------------- Internal functions ---------------------- */
+
+/**
+ * @brief           Check if an element leaves the queue before
+ *                  another.
+ *
+ * @param pq        The priority queue.
+ * @param a         The first element.
+ * @param b         The second element.
+ * @return          True if a has the higher priority, or the same
+ *                  priority and was inserted first.
+ */
+static inline bool before(const pqueue *const pq,
+                          const struct element *a,
+                          const struct element *b)
+{
+	if(pq->cmp_func == NULL) {
+		if(a->key != b->key) {
+			return a->key < b->key;
+		}
+	} else {
+		int order = pq->cmp_func(a->value, b->value);
+		if(order != 0) {
+			return order < 0;
+		}
+	}
+	return a->seq < b->seq;
+}
+
+
+/**
+ * @brief           Move an element towards the root until its parent
+ *                  comes before it.
+ *
+ * @param pq        The priority queue.
+ * @param i         The index of the element.
+ * @return          -
+ */
+static void sift_up(pqueue *const pq, size_t i)
+{
+	struct element moving = pq->elements[i];
+
+	while(i > 0) {
+		size_t parent = (i - 1) / ARITY;
+		if(!before(pq, &moving, &pq->elements[parent])) {
+			break;
+		}
+		pq->elements[i] = pq->elements[parent];
+		i = parent;
+	}
+	pq->elements[i] = moving;
+}
+
+
+/**
+ * @brief           Move an element towards the leaves until it comes
+ *                  before all its children.
+ *
+ * @param pq        The priority queue.
+ * @param i         The index of the element.
+ * @return          -
+ */
+static void sift_down(pqueue *const pq, size_t i)
+{
+	struct element moving = pq->elements[i];
+
+	for(;;) {
+		size_t first = i * ARITY + 1;
+		if(first >= pq->size) {
+			break;
+		}
+		size_t last = first + ARITY < pq->size ? first + ARITY
+		                                       : pq->size;
+		size_t best = first;
+		for(size_t child = first + 1; child < last; child++) {
+			if(before(pq, &pq->elements[child],
+			          &pq->elements[best])) {
+				best = child;
+			}
+		}
+		if(!before(pq, &pq->elements[best], &moving)) {
+			break;
+		}
+		pq->elements[i] = pq->elements[best];
+		i = best;
+	}
+	pq->elements[i] = moving;
+}
+
+
+/**
+ * @brief           Restore the heap order of all elements in O(n).
+ *
+ * @param pq        The priority queue.
+ * @return          -
+ */
+static void heapify(pqueue *const pq)
+{
+	if(pq->size < 2) {
+		return;
+	}
+	for(size_t i = (pq->size - 2) / ARITY + 1; i-- > 0; ) {
+		sift_down(pq, i);
+	}
+}
+
+
+/**
+ * @brief           Make room for size elements.
+ *
+ * @param pq        The priority queue.
+ * @param size      The number of elements.
+ * @return          -
+ */
+static void reserve(pqueue *const pq, size_t size)
+{
+	if(size > pq->capacity) {
+		size_t capacity = pq->capacity * 2;
+		while(capacity < size) {
+			capacity *= 2;
+		}
+		pq->elements = realloc(pq->elements,
+		                       capacity * sizeof *pq->elements);
+		assert(pq->elements);
+		pq->capacity = capacity;
+	}
+}
+
+
+/**
+ * @brief           Add an element after the last one without
+ *                  restoring the heap order.
+ *
+ * @param pq        The priority queue.
+ * @param key       The key of the element.
+ * @param value     The value of the element.
+ * @return          -
+ */
+static void push(pqueue *const pq, long long key, void *value)
+{
+	reserve(pq, pq->size + 1);
+	pq->elements[pq->size].value = value;
+	pq->elements[pq->size].key = key;
+	pq->elements[pq->size].seq = pq->next_seq++;
+	pq->size++;
+}
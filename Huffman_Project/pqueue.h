@@ -6,6 +6,14 @@
  * The data type represent a priority queue. Takes a compare function
  * when creating a new priority queue, the compare function is used
  * to determine priority of elements within the priority queue.
+ * Without a compare function the elements are ordered by integer keys
+ * given with pqueue_insert_key, which is faster since no function is
+ * called per comparison. Elements of equal priority leave the queue in
+ * the order they were inserted.
+ *
+ * The queue is an array-backed d-ary heap: inserting and deleting take
+ * O(log n) time, and pqueue_build_from_array and pqueue_insert_many
+ * build the heap of many elements in O(n).
  *
  * Copyright 2024 Jonny Pettersson (jonny@cs.umu.se). Permission is
  * given for usage of this file within the course DV2 at Umeå
@@ -66,6 +74,21 @@ typedef struct pqueue pqueue;
 pqueue* pqueue_empty(pqueue_cmp_func cmp_func);
 
 
+/**
+ * @brief             Create a priority queue holding n values. The
+ *                    heap is built in O(n) time, and values of equal
+ *                    priority leave the queue in array order.
+ *
+ * @param cmp_func    The compare function used to determine priority
+ *                    within the queue.
+ * @param values      The values to put in the queue.
+ * @param n           The number of values.
+ * @return            The new priority queue.
+ */
+pqueue *pqueue_build_from_array(pqueue_cmp_func cmp_func,
+                                void **values, size_t n);
+
+
 /**
  * @brief             Set the memory handling funciton for the
  *                    priority queue.
@@ -99,6 +122,34 @@ void pqueue_delete_first(pqueue *const pq);
 void pqueue_insert(pqueue *const pq, void* value);
 
 
+/**
+ * @brief             Insert a new element with a value and an integer
+ *                    priority in a queue created without a compare
+ *                    function. Lower keys come first.
+ *
+ * @param pq          The priority queue. Must not have a compare
+ *                    function.
+ * @param key         The priority of the element.
+ * @param value       The value to put in the new element.
+ * @return            -
+ */
+void pqueue_insert_key(pqueue *const pq, long long key, void *value);
+
+
+/**
+ * @brief             Insert n values at once. When n is larger than
+ *                    the queue, the heap is rebuilt in O(size + n)
+ *                    time instead of inserting the values one by one.
+ *
+ * @param pq          The priority queue.
+ * @param values      The values to insert. In a queue without a
+ *                    compare function they get the key 0.
+ * @param n           The number of values.
+ * @return            -
+ */
+void pqueue_insert_many(pqueue *const pq, void **values, size_t n);
+
+
 /**
  * @brief             Get the value from the front element in the
  *                    priority queue.
@@ -136,6 +187,7 @@ void pqueue_kill(pqueue* pq);
 /*
  * @brief             Print the priority queue using the print
  *                    function given as a parameter to the function.
+ *                    The elements are printed in heap order.
  *
  * @param pq          The priority queue.
  * @param print_func  The print function to be used.
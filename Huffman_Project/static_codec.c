@@ -0,0 +1,165 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         static_codec.c
+ * Description:  Huffman encoder and decoder compiled against the tables generated by "huffman -emit-c".
+ *               The tables are static const arrays, so there is no setup and the compiler sees their
+ *               sizes. The results are the same as those of encode_block() and decode_table_run().
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#include <stdint.h>
+#include "static_codec.h"
+
+#ifndef HUFF_STATIC_TABLES
+#define HUFF_STATIC_TABLES "static_tables.h"
+#endif
+#include HUFF_STATIC_TABLES
+
+#if HUFF_STATIC_MAX_CODE_LENGTH > 57
+#error "The generated codes are too long for the 64-bit bit writer"
+#endif
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+/*
+ * The same reader as in decode_table.c: bits are loaded most significant bit first into a word, and
+ * past the end of the payload the word holds zeros while consumed keeps counting.
+ */
+typedef struct static_reader {
+    const unsigned char *data;
+    size_t size;
+    size_t pos;
+    uint64_t bits;
+    int count;
+    size_t consumed;
+} static_reader;
+
+static inline void refill(static_reader *reader)
+{
+    while (reader->count <= 56 && reader->pos < reader->size) {
+        reader->bits |= (uint64_t)reader->data[reader->pos++] << (56 - reader->count);
+        reader->count += 8;
+    }
+}
+
+static inline void consume(static_reader *reader, int n)
+{
+    reader->bits <<= n;
+    reader->count = reader->count > n ? reader->count - n : 0;
+    reader->consumed += n;
+}
+
+static inline decode_status failure(const static_reader *reader)
+{
+    return reader->consumed > reader->size * 8 ? DECODE_TRUNCATED : DECODE_INVALID_CODE;
+}
+
+/*
+ * Finishes a code longer than the lookup by walking the tree from an inner node. Returns the byte,
+ * or -1 at a missing child.
+ */
+static int decode_long_code(int node, static_reader *reader)
+{
+    for (;;) {
+        refill(reader);
+        int bit = (int)(reader->bits >> 63);
+        consume(reader, 1);
+        int child = huff_static_tree[node][bit];
+        if (child == HUFF_STATIC_MISSING) {
+            return -1;
+        }
+        if (child < 0) {
+            return -1 - child;
+        }
+        node = child;
+    }
+}
+
+/* ------------------------------------ External functions ---------------------------------------------- */
+
+uint32_t static_codec_table_id(void)
+{
+    return HUFF_STATIC_TABLE_ID;
+}
+
+size_t static_codec_payload_size(const size_t *count)
+{
+    uint64_t bits = 0;
+
+    for (int i = 0; i < 256; i++) {
+        if (count[i] > 0 && huff_static_lengths[i] == 0) {
+            return SIZE_MAX;
+        }
+        bits += (uint64_t)count[i] * huff_static_lengths[i];
+    }
+    return (size_t)((bits + 7) / 8);
+}
+
+size_t static_codec_encode(const unsigned char *block, size_t block_size, unsigned char *payload)
+{
+    for (size_t i = 0; i < block_size; i++) {
+        if (huff_static_lengths[block[i]] == 0) {
+            return SIZE_MAX;
+        }
+    }
+
+    uint64_t bits = 0;
+    int count = 0;
+    size_t size = 0;
+    for (size_t i = 0; i < block_size; i++) {
+        int length = huff_static_lengths[block[i]];
+        bits = (bits << length) | huff_static_codes[block[i]];
+        count += length;
+        while (count >= 8) {
+            count -= 8;
+            payload[size++] = (unsigned char)(bits >> count);
+        }
+    }
+    if (count > 0) {
+        payload[size++] = (unsigned char)(bits << (8 - count));
+    }
+    return size;
+}
+
+decode_status static_codec_decode(const unsigned char *payload, size_t payload_size, unsigned char *out,
+                                  size_t raw_size, size_t *consumed)
+{
+    static_reader reader = {payload, payload_size, 0, 0, 0, 0};
+    decode_status status = DECODE_OK;
+
+    for (size_t i = 0; i < raw_size; i++) {
+        refill(&reader);
+        const huff_static_entry *entry = &huff_static_lookup[reader.bits >> (64 - HUFF_STATIC_LOOKUP_BITS)];
+
+        if (entry->length != 0) {
+            out[i] = entry->byte;
+            consume(&reader, entry->length);
+            continue;
+        }
+        if (entry->next < 0) {
+            consume(&reader, entry->byte);
+            status = failure(&reader);
+            break;
+        }
+        consume(&reader, HUFF_STATIC_LOOKUP_BITS);
+        int byte = decode_long_code(entry->next, &reader);
+        if (byte < 0) {
+            status = failure(&reader);
+            break;
+        }
+        out[i] = (unsigned char)byte;
+    }
+
+    if (status == DECODE_OK && reader.consumed > reader.size * 8) {
+        status = DECODE_TRUNCATED;
+    }
+    if (consumed != NULL) {
+        *consumed = reader.consumed;
+    }
+    return status;
+}
@@ -0,0 +1,71 @@
+/**
+ * @defgroup StaticCodec
+ * @brief Huffman encoder and decoder specialised at compile time for one frequency table.
+ *
+ * static_codec.c includes the header written by `huffman -emit-c` (see emit_c.h), named by the
+ * macro HUFF_STATIC_TABLES, "static_tables.h" by default:
+ *
+ *     huffman -emit-c table.huft static_tables.h
+ *     gcc -c -DHUFF_STATIC_TABLES='"static_tables.h"' static_codec.c
+ *
+ * Nothing is built at startup, and the loops index constant arrays of known size. The functions
+ * work on block payloads: static_codec_encode() writes the same bytes as a BLOCK_HUFFMAN payload
+ * of encode_block(), and static_codec_decode() accepts them with the same results as
+ * decode_table_run(), so the blocks can be framed with block headers as usual.
+ *
+ * @section Author
+ *  - Author: Abdiaziz Ibrahim Adam
+ * @since Datum
+ *  - 18 October 2026
+ * @{
+ */
+
+#ifndef STATIC_CODEC_H
+#define STATIC_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "decode_table.h"
+
+/**
+ * @brief Returns the table ID of the frequency table the codec was generated from.
+ *
+ * @return The table ID, as written in file headers.
+ */
+uint32_t static_codec_table_id(void);
+
+/**
+ * @brief Returns the Huffman payload size of a block from its histogram.
+ *
+ * @param count The histogram of the block.
+ * @return The payload size in bytes, or SIZE_MAX if a byte of the block has no code.
+ */
+size_t static_codec_payload_size(const size_t *count);
+
+/**
+ * @brief Huffman codes a block, most significant bit first and padded with zero bits.
+ *
+ * @param block The bytes of the block.
+ * @param block_size The number of bytes.
+ * @param payload Array of at least static_codec_payload_size() bytes where the payload is stored.
+ * @return The payload size in bytes, or SIZE_MAX if a byte of the block has no code. Nothing is
+ *         written in that case.
+ */
+size_t static_codec_encode(const unsigned char *block, size_t block_size, unsigned char *payload);
+
+/**
+ * @brief Decodes exactly raw_size bytes from a payload.
+ *
+ * @param payload The payload. May hold arbitrary bytes; reads never leave it.
+ * @param payload_size The number of payload bytes.
+ * @param out Array of at least raw_size bytes where the decoded bytes are stored.
+ * @param raw_size The number of bytes to decode.
+ * @param consumed Pointer to where the number of consumed bits is stored, or NULL.
+ * @return DECODE_OK, DECODE_INVALID_CODE or DECODE_TRUNCATED.
+ */
+decode_status static_codec_decode(const unsigned char *payload, size_t payload_size, unsigned char *out,
+                                  size_t raw_size, size_t *consumed);
+
+#endif /* STATIC_CODEC_H */
+
+/** @} */
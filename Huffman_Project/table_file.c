@@ -0,0 +1,154 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         table_file.c
+ * Description:  Trains, writes and reads shared frequency tables. A table file lets many short messages
+ *               be encoded and decoded against the same table, identified in each compressed file only by
+ *               a 32-bit table ID.
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "table_file.h"
+#include "byte_io.h"
+
+#define NUM_BYTES 256
+#define MAX_TABLE_TOTAL (1LL << 30) // Keeps the sum of all Trie weights well inside an int
+
+void table_file_accumulate(long long *totals, const int *frequency_table)
+{
+    for (int i = 0; i < NUM_BYTES; i++) {
+        totals[i] += frequency_table[i];
+    }
+}
+
+int *table_file_finish(const long long *totals)
+{
+    long long scaled[NUM_BYTES];
+    long long sum = 0;
+
+    for (int i = 0; i < NUM_BYTES; i++) {
+        scaled[i] = totals[i];
+        sum += totals[i];
+    }
+
+    // Halve the counts until they fit, but never let a seen byte drop to zero
+    while (sum > MAX_TABLE_TOTAL) {
+        sum = 0;
+        for (int i = 0; i < NUM_BYTES; i++) {
+            if (scaled[i] > 0) {
+                scaled[i] = (scaled[i] + 1) / 2;
+            }
+            sum += scaled[i];
+        }
+    }
+
+    int *frequency_table = malloc(NUM_BYTES * sizeof(int));
+    if (frequency_table == NULL) {
+        fprintf(stderr, "Failed to allocate memory for frequency table\n");
+        return NULL;
+    }
+
+    for (int i = 0; i < NUM_BYTES; i++) {
+        frequency_table[i] = scaled[i] > 0 ? (int)scaled[i] : 1;
+    }
+    return frequency_table;
+}
+
+uint32_t table_id(const int *frequency_table)
+{
+    uint32_t hash = 2166136261u;
+    unsigned char bytes[4];
+
+    for (int i = 0; i < NUM_BYTES; i++) {
+        put_u32(bytes, (uint32_t)frequency_table[i]);
+        for (int j = 0; j < 4; j++) {
+            hash ^= bytes[j];
+            hash *= 16777619u;
+        }
+    }
+    return hash;
+}
+
+int table_file_write(FILE *file, const int *frequency_table)
+{
+    if (fwrite(TABLE_FILE_MAGIC, 1, 4, file) != 4 || fputc(TABLE_FILE_VERSION, file) == EOF) {
+        return -1;
+    }
+    if (write_u32(file, table_id(frequency_table)) != 0) {
+        return -1;
+    }
+    for (int i = 0; i < NUM_BYTES; i++) {
+        if (write_u32(file, (uint32_t)frequency_table[i]) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+bool table_file_detect(FILE *file)
+{
+    char magic[4];
+    bool is_table = fread(magic, 1, 4, file) == 4 && memcmp(magic, TABLE_FILE_MAGIC, 4) == 0;
+
+    rewind(file);
+    return is_table;
+}
+
+int *table_file_read(FILE *file)
+{
+    char magic[4];
+    if (fread(magic, 1, 4, file) != 4 || memcmp(magic, TABLE_FILE_MAGIC, 4) != 0) {
+        fprintf(stderr, "Not a table file\n");
+        return NULL;
+    }
+
+    int version = fgetc(file);
+    if (version == EOF || version > TABLE_FILE_VERSION) {
+        fprintf(stderr, "Unsupported table file version\n");
+        return NULL;
+    }
+
+    uint32_t stored_id;
+    if (read_u32(file, &stored_id) != 0) {
+        fprintf(stderr, "Table file is truncated\n");
+        return NULL;
+    }
+
+    int *frequency_table = malloc(NUM_BYTES * sizeof(int));
+    if (frequency_table == NULL) {
+        fprintf(stderr, "Failed to allocate memory for frequency table\n");
+        return NULL;
+    }
+
+    long long sum = 0;
+    for (int i = 0; i < NUM_BYTES; i++) {
+        uint32_t count;
+        if (read_u32(file, &count) != 0) {
+            fprintf(stderr, "Table file is truncated\n");
+            free(frequency_table);
+            return NULL;
+        }
+        sum += count;
+        frequency_table[i] = (int)count;
+    }
+
+    if (sum > MAX_TABLE_TOTAL + NUM_BYTES) {
+        fprintf(stderr, "Table file counts are too large\n");
+        free(frequency_table);
+        return NULL;
+    }
+
+    if (table_id(frequency_table) != stored_id) {
+        fprintf(stderr, "Table file ID does not match its contents\n");
+        free(frequency_table);
+        return NULL;
+    }
+    return frequency_table;
+}
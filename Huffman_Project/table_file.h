@@ -0,0 +1,105 @@
+/**
+ * @defgroup TableFile
+ * @brief Functions for training, storing and loading shared frequency tables.
+ *
+ * A table file holds a frequency table that has been aggregated over a set of sample files. Encoding and
+ * decoding can use it instead of a per-file frequency source, and the compressed file then only needs to
+ * carry the table ID in its header. This makes short records compress well, since no table has to be
+ * stored or rebuilt from a large reference file for every message.
+ *
+ * The file layout is:
+ * - 4 bytes  : The magic "HUFT".
+ * - 1 byte   : The format version (TABLE_FILE_VERSION).
+ * - 4 bytes  : The table ID, see table_id().
+ * - 1024 bytes: 256 counts, one 32-bit little-endian integer per byte value.
+ *
+ * @section Author
+ *  - Author: Abdiaziz Ibrahim Adam
+ * @since Datum
+ *  - 18 October 2026
+ * @{
+ */
+
+#ifndef TABLE_FILE_H
+#define TABLE_FILE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TABLE_FILE_MAGIC "HUFT"  ///< Magic bytes at the start of every table file.
+#define TABLE_FILE_VERSION 1     ///< The newest table file version this program understands.
+
+/**
+ * @brief Adds the counts of a frequency table to a running total.
+ *
+ * Used when training, to aggregate the tables of many sample files. The totals are 64-bit so that
+ * large sample sets cannot overflow them.
+ *
+ * @param totals Array of 256 running totals.
+ * @param frequency_table Array of 256 counts to add.
+ */
+void table_file_accumulate(long long *totals, const int *frequency_table);
+
+/**
+ * @brief Turns aggregated totals into a frequency table usable for Huffman coding.
+ *
+ * The totals are scaled down until their sum fits comfortably in an int, and every byte value is
+ * given a count of at least one. The latter makes sure that any byte can be encoded with the table,
+ * also bytes that never appeared in the samples.
+ *
+ * @warning Memory allocation: It's the caller's responsibility to free the returned table.
+ *
+ * @param totals Array of 256 aggregated totals.
+ * @return A dynamically allocated array of 256 counts, or NULL if memory allocation fails.
+ */
+int *table_file_finish(const long long *totals);
+
+/**
+ * @brief Computes the ID of a frequency table.
+ *
+ * The ID is a 32-bit FNV-1a hash of the counts, so the same table always gets the same ID. It is
+ * stored in the header of compressed files to check that they are decoded with the table they were
+ * encoded with.
+ *
+ * @param frequency_table Array of 256 counts.
+ * @return The ID of the table.
+ */
+uint32_t table_id(const int *frequency_table);
+
+/**
+ * @brief Writes a frequency table to a table file.
+ *
+ * @param file Pointer to a FILE structure opened in binary write mode.
+ * @param frequency_table Array of 256 counts.
+ * @return 0 on success, -1 if writing failed.
+ */
+int table_file_write(FILE *file, const int *frequency_table);
+
+/**
+ * @brief Checks whether a file is a table file.
+ *
+ * Reads the first bytes of the file and rewinds it, so the file can afterwards be read either with
+ * table_file_read() or with create_frequency_table().
+ *
+ * @param file Pointer to a FILE structure opened in binary read mode. Must be seekable.
+ * @return True if the file starts with TABLE_FILE_MAGIC, otherwise false.
+ */
+bool table_file_detect(FILE *file);
+
+/**
+ * @brief Reads a frequency table from a table file.
+ *
+ * The magic, version and stored table ID are all checked. An error message is printed if any of
+ * them does not match.
+ *
+ * @warning Memory allocation: It's the caller's responsibility to free the returned table.
+ *
+ * @param file Pointer to a FILE structure positioned at the start of a table file.
+ * @return A dynamically allocated array of 256 counts, or NULL if the file is not a valid table file.
+ */
+int *table_file_read(FILE *file);
+
+#endif /* TABLE_FILE_H */
+
+/** @} */
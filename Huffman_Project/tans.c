@@ -0,0 +1,282 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         tans.c
+ * Description:  Builds tANS tables from a frequency table and encodes and decodes block payloads
+ *               with them. The construction follows Finite State Entropy: the normalised
+ *               frequencies are spread over the states with a fixed step, and every state change is
+ *               precomputed so that the encode and decode loops are a lookup, a shift and a bit
+ *               write or read per byte.
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "tans.h"
+#include "huff_profile.h"
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+/*
+ * Returns the index of the highest set bit of a non-zero value.
+ */
+static int highest_bit(uint32_t value)
+{
+    return 31 - __builtin_clz(value);
+}
+
+/*
+ * Scales the frequencies so they sum to TANS_TABLE_SIZE. Every byte that occurs keeps at least 1.
+ * Rounding errors are taken from the largest counts, where they matter least, and any remainder is
+ * given to the most common byte. The result only depends on the frequency table.
+ */
+static void normalise(const int *frequency_table, uint16_t *norm)
+{
+    uint64_t total = 0;
+
+    for (int i = 0; i < 256; i++) {
+        if (frequency_table[i] > 0) {
+            total += frequency_table[i];
+        }
+    }
+    memset(norm, 0, 256 * sizeof(uint16_t));
+    if (total == 0) {
+        return;
+    }
+
+    int sum = 0;
+    int most_common = 0;
+    for (int i = 0; i < 256; i++) {
+        if (frequency_table[i] <= 0) {
+            continue;
+        }
+        uint64_t scaled = (uint64_t)frequency_table[i] * TANS_TABLE_SIZE / total;
+        norm[i] = scaled > 0 ? (uint16_t)scaled : 1;
+        sum += norm[i];
+        if (frequency_table[i] > frequency_table[most_common]) {
+            most_common = i;
+        }
+    }
+
+    while (sum > TANS_TABLE_SIZE) {
+        int largest = 0;
+        for (int i = 1; i < 256; i++) {
+            if (norm[i] > norm[largest]) {
+                largest = i;
+            }
+        }
+        norm[largest]--;
+        sum--;
+    }
+    norm[most_common] += TANS_TABLE_SIZE - sum;
+}
+
+/*
+ * Builds the encode and decode tables from the normalised frequencies.
+ */
+static void build_tables(tans_table *table)
+{
+    uint8_t spread[TANS_TABLE_SIZE];
+    uint32_t cumulative[257];
+    uint32_t next[256];
+
+    // Spread the bytes over the states; the step is odd, so every state is visited once
+    const uint32_t step = (TANS_TABLE_SIZE >> 1) + (TANS_TABLE_SIZE >> 3) + 3;
+    uint32_t position = 0;
+    cumulative[0] = 0;
+    for (int i = 0; i < 256; i++) {
+        for (int j = 0; j < table->norm[i]; j++) {
+            spread[position] = (uint8_t)i;
+            position = (position + step) & (TANS_TABLE_SIZE - 1);
+        }
+        cumulative[i + 1] = cumulative[i] + table->norm[i];
+        next[i] = table->norm[i];
+    }
+
+    // Decoding: a state gives its byte and how to get back to the state the encoder came from
+    for (uint32_t state = 0; state < TANS_TABLE_SIZE; state++) {
+        int symbol = spread[state];
+        uint32_t next_state = next[symbol]++;
+        int nb_bits = TANS_TABLE_LOG - highest_bit(next_state);
+        table->decode[state].symbol = (uint8_t)symbol;
+        table->decode[state].nb_bits = (uint8_t)nb_bits;
+        table->decode[state].new_state = (uint16_t)((next_state << nb_bits) - TANS_TABLE_SIZE);
+    }
+
+    // Encoding: the states of each byte, in the same order as the decoder numbers them
+    uint32_t fill[256];
+    memcpy(fill, cumulative, sizeof(fill));
+    for (uint32_t state = 0; state < TANS_TABLE_SIZE; state++) {
+        table->state_table[fill[spread[state]]++] = (uint16_t)(TANS_TABLE_SIZE + state);
+    }
+
+    for (int i = 0; i < 256; i++) {
+        tans_symbol *symbol = &table->symbols[i];
+        int norm = table->norm[i];
+        if (norm == 0) {
+            memset(symbol, 0, sizeof(*symbol));
+            continue;
+        }
+
+        uint32_t max_bits_out = norm == 1 ? TANS_TABLE_LOG : TANS_TABLE_LOG - highest_bit(norm - 1);
+        uint32_t min_state_plus = (uint32_t)norm << max_bits_out;
+        symbol->delta_nb_bits = (max_bits_out << 16) - min_state_plus;
+        symbol->delta_find_state = (int32_t)cumulative[i] - norm;
+        symbol->cost = (uint32_t)lround((TANS_TABLE_LOG - log2(norm)) * 256);
+    }
+}
+
+/*
+ * Returns the number of bits to output for a byte in a state, and the state after it.
+ */
+static inline uint32_t encode_step(const tans_table *table, const tans_symbol *symbol, uint32_t *state)
+{
+    uint32_t nb_bits = (*state + symbol->delta_nb_bits) >> 16;
+    *state = table->state_table[(int32_t)(*state >> nb_bits) + symbol->delta_find_state];
+    return nb_bits;
+}
+
+/*
+ * Reads nb_bits bits that end just before bit position pos (bits are numbered from the first byte,
+ * least significant bit first). Only bytes of the payload are read.
+ */
+static inline uint32_t read_bits_before(const unsigned char *data, size_t size, size_t pos, int nb_bits)
+{
+    size_t start = pos - nb_bits;
+    size_t byte = start >> 3;
+    uint32_t value = data[byte];
+
+    if (byte + 1 < size) {
+        value |= (uint32_t)data[byte + 1] << 8;
+    }
+    if (byte + 2 < size) {
+        value |= (uint32_t)data[byte + 2] << 16;
+    }
+    return (value >> (start & 7)) & ((1u << nb_bits) - 1);
+}
+
+/* ------------------------------------ External functions ---------------------------------------------- */
+
+tans_table *tans_table_create(const int *frequency_table)
+{
+    tans_table *table = malloc(sizeof(tans_table));
+    if (table == NULL) {
+        fprintf(stderr, "Failed to allocate memory for tANS table\n");
+        return NULL;
+    }
+
+    normalise(frequency_table, table->norm);
+    table->num_symbols = 0;
+    for (int i = 0; i < 256; i++) {
+        table->num_symbols += table->norm[i] > 0;
+    }
+
+    if (table->num_symbols > 0) {
+        build_tables(table);
+    } else {
+        memset(table->symbols, 0, sizeof(table->symbols));
+    }
+    return table;
+}
+
+void tans_table_free(tans_table *table)
+{
+    free(table);
+}
+
+size_t tans_estimate_size(const tans_table *table, const size_t *count)
+{
+    uint64_t cost = 0;
+
+    for (int i = 0; i < 256; i++) {
+        if (count[i] > 0 && table->norm[i] == 0) {
+            return SIZE_MAX;
+        }
+        cost += (uint64_t)count[i] * table->symbols[i].cost;
+    }
+    return (cost / 256 + TANS_TABLE_LOG + 1 + 7) / 8;
+}
+
+size_t tans_payload_size(const tans_table *table, const unsigned char *block, size_t block_size)
+{
+    uint32_t state = TANS_TABLE_SIZE;
+    uint64_t bits = TANS_TABLE_LOG + 1;
+
+    for (size_t i = block_size; i-- > 0;) {
+        bits += encode_step(table, &table->symbols[block[i]], &state);
+    }
+    return (bits + 7) / 8;
+}
+
+size_t tans_encode(const tans_table *table, const unsigned char *block, size_t block_size, unsigned char *payload)
+{
+    uint32_t state = TANS_TABLE_SIZE;
+    uint64_t bits = 0;
+    int count = 0;
+    size_t size = 0;
+    PROFILE_ONLY(uint64_t symbol_bits[256] = {0};)
+
+    for (size_t i = block_size; i-- > 0;) {
+        uint32_t value = state;
+        uint32_t nb_bits = encode_step(table, &table->symbols[block[i]], &state);
+        PROFILE_ONLY(symbol_bits[block[i]] += nb_bits;)
+        bits |= (uint64_t)(value & ((1u << nb_bits) - 1)) << count;
+        count += nb_bits;
+        while (count >= 8) {
+            payload[size++] = (unsigned char)bits;
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    // The final state and the end marker; the decoder starts from here
+    bits |= (uint64_t)(state - TANS_TABLE_SIZE) << count;
+    count += TANS_TABLE_LOG;
+    bits |= (uint64_t)1 << count;
+    count++;
+    while (count > 0) {
+        payload[size++] = (unsigned char)bits;
+        bits >>= 8;
+        count -= 8;
+    }
+    PROFILE_ONLY(profile_add_symbol_bits(symbol_bits);)
+    return size;
+}
+
+decode_status tans_decode(const tans_table *table, const unsigned char *payload, size_t payload_size,
+                          unsigned char *out, size_t raw_size)
+{
+    if (table->num_symbols == 0) {
+        return DECODE_INVALID_CODE;
+    }
+    if (payload_size == 0 || payload[payload_size - 1] == 0) {
+        return DECODE_TRUNCATED;
+    }
+
+    // The end marker is the highest set bit of the last byte
+    size_t pos = (payload_size - 1) * 8 + highest_bit(payload[payload_size - 1]);
+    if (pos < TANS_TABLE_LOG) {
+        return DECODE_TRUNCATED;
+    }
+    uint32_t state = read_bits_before(payload, payload_size, pos, TANS_TABLE_LOG);
+    pos -= TANS_TABLE_LOG;
+
+    for (size_t i = 0; i < raw_size; i++) {
+        const tans_decode_entry *entry = &table->decode[state];
+        if (entry->nb_bits > pos) {
+            return DECODE_TRUNCATED;
+        }
+        out[i] = entry->symbol;
+        state = entry->new_state + read_bits_before(payload, payload_size, pos, entry->nb_bits);
+        pos -= entry->nb_bits;
+    }
+
+    // The encoder started in state 0 and used every bit
+    return state == 0 && pos == 0 ? DECODE_OK : DECODE_INVALID_CODE;
+}
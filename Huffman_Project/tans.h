@@ -0,0 +1,136 @@
+/**
+ * @defgroup Tans
+ * @brief Table-based asymmetric numeral system (tANS) coding, an alternative to the Huffman codes.
+ *
+ * Huffman codes spend a whole number of bits on every byte, which wastes space when some bytes are
+ * much more common than others: a byte with a probability of 0.9 still costs a full bit instead of
+ * 0.15. tANS spends fractional bits, so it comes within a fraction of a percent of the Shannon bound,
+ * while encoding and decoding are still one table lookup and one bit read or write per byte.
+ *
+ * The tables are built from the same frequency table as the Huffman codes. The frequencies are
+ * normalised so that they sum to TANS_TABLE_SIZE, with every byte that occurs getting at least 1.
+ * Bytes with a frequency of zero can not be encoded.
+ *
+ * A payload is written by encoding the block from its last byte to its first, so that the decoder
+ * can produce the bytes in order. The payload ends with the final encoder state (TANS_TABLE_LOG bits)
+ * and a single 1 bit that marks where the bits end; the decoder reads everything backwards from
+ * there. Since the encoder always starts in the same state, the decoder must end in it too, which
+ * together with consuming exactly all bits catches most corruption.
+ *
+ * @section Author
+ *  - Author: Abdiaziz Ibrahim Adam
+ * @since Datum
+ *  - 18 October 2026
+ * @{
+ */
+
+#ifndef TANS_H
+#define TANS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "decode_table.h"
+
+#define TANS_TABLE_LOG 11                       ///< The log2 of the number of states.
+#define TANS_TABLE_SIZE (1 << TANS_TABLE_LOG)   ///< The number of states, and the sum of the normalised frequencies.
+
+/**
+ * @brief How a byte changes the encoder state.
+ */
+typedef struct tans_symbol {
+    uint32_t delta_nb_bits;    ///< Gives the number of bits to output from the state with one shift.
+    int32_t delta_find_state;  ///< Offset of the byte's next states in the state table.
+    uint32_t cost;             ///< The average cost of the byte in 1/256 bits, used for estimates.
+} tans_symbol;
+
+/**
+ * @brief One entry of the decode table, indexed by the decoder state.
+ */
+typedef struct tans_decode_entry {
+    uint16_t new_state;  ///< The next state before the read bits are added.
+    uint8_t symbol;      ///< The decoded byte.
+    uint8_t nb_bits;     ///< The number of bits to read.
+} tans_decode_entry;
+
+/**
+ * @brief The encode and decode tables built from one frequency table.
+ */
+typedef struct tans_table {
+    int num_symbols;                                   ///< The number of bytes that can be encoded.
+    uint16_t norm[256];                                ///< The normalised frequencies, 0 for bytes that can not be encoded.
+    tans_symbol symbols[256];                          ///< The encode transform of each byte.
+    uint16_t state_table[TANS_TABLE_SIZE];             ///< The next encoder state, grouped by byte.
+    tans_decode_entry decode[TANS_TABLE_SIZE];         ///< The decode table.
+} tans_table;
+
+/**
+ * @brief Normalises a frequency table and builds the tANS tables from it.
+ *
+ * @warning Memory allocation: It's the caller's responsibility to free the table with tans_table_free().
+ *
+ * @param frequency_table Array of 256 integers representing the frequency of each byte.
+ * @return Pointer to the new table, or NULL if memory allocation fails. If no byte has a frequency
+ *         above zero, the table can not encode anything.
+ */
+tans_table *tans_table_create(const int *frequency_table);
+
+/**
+ * @brief Frees a tANS table.
+ *
+ * @param table The table to free. May be NULL.
+ */
+void tans_table_free(tans_table *table);
+
+/**
+ * @brief Estimates the payload size of a block from its histogram.
+ *
+ * The estimate is the information content of the block under the normalised frequencies. The real
+ * payload is within a few bytes of it.
+ *
+ * @param table The tANS table.
+ * @param count The histogram of the block.
+ * @return The estimated payload size in bytes, or SIZE_MAX if a byte of the block can not be encoded.
+ */
+size_t tans_estimate_size(const tans_table *table, const size_t *count);
+
+/**
+ * @brief Computes the exact payload size of a block without writing it.
+ *
+ * @param table The tANS table.
+ * @param block The bytes of the block. All must be encodable, see tans_estimate_size().
+ * @param block_size The number of bytes.
+ * @return The payload size in bytes.
+ */
+size_t tans_payload_size(const tans_table *table, const unsigned char *block, size_t block_size);
+
+/**
+ * @brief Encodes a block.
+ *
+ * @param table The tANS table.
+ * @param block The bytes of the block. All must be encodable, see tans_estimate_size().
+ * @param block_size The number of bytes.
+ * @param payload Array of at least tans_payload_size() bytes where the payload is stored.
+ * @return The payload size in bytes.
+ */
+size_t tans_encode(const tans_table *table, const unsigned char *block, size_t block_size, unsigned char *payload);
+
+/**
+ * @brief Decodes a payload into exactly raw_size bytes.
+ *
+ * The payload may be arbitrary bytes; reads never leave it.
+ *
+ * @param table The tANS table.
+ * @param payload The payload.
+ * @param payload_size The number of payload bytes.
+ * @param out Array of at least raw_size bytes where the decoded bytes are stored.
+ * @param raw_size The number of bytes to decode.
+ * @return DECODE_OK, DECODE_INVALID_CODE if the bits do not decode to raw_size bytes or the table
+ *         is empty, or DECODE_TRUNCATED if the payload ends too early.
+ */
+decode_status tans_decode(const tans_table *table, const unsigned char *payload, size_t payload_size,
+                          unsigned char *out, size_t raw_size);
+
+#endif /* TANS_H */
+
+/** @} */
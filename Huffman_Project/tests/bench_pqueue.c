@@ -0,0 +1,164 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         bench_pqueue.c
+ * Description:  Micro-benchmark of the priority queue. For 10^2 up to 10^MAX elements with random
+ *               priorities it times inserting all elements and deleting them again with the sorted
+ *               list the queue used to be, with the heap through the compare function and through
+ *               integer keys, and building the heap from an array at once. The times are printed in
+ *               nanoseconds per element. The sorted list takes quadratic time and is only run up to
+ *               LIST_MAX elements.
+ *
+ *               Usage: bench_pqueue [MAX]
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "../list.h"
+#include "../pqueue.h"
+
+#define LIST_MAX 10000          // The largest queue the sorted list is timed with
+#define DEFAULT_MAX 7           // 10^DEFAULT_MAX elements at most
+
+static uint64_t rng_state = 20261018;
+static volatile uintptr_t sink; // Keeps the compiler from dropping the deletes
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+static uint64_t next_random(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ull;
+}
+
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static int compare_ints(void *a, void *b)
+{
+    int x = *(int *)a;
+    int y = *(int *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * The queue as it was before the heap: every insert walks a sorted list to the first larger value.
+ */
+static double time_list(void **pointers, size_t n)
+{
+    double start = now();
+    list *l = list_empty_pooled(64);
+
+    for (size_t i = 0; i < n; i++) {
+        list_position pos = list_first(l);
+        while (!list_is_end(l, pos) && compare_ints(pointers[i], list_inspect(l, pos)) >= 0) {
+            pos = list_next(l, pos);
+        }
+        list_insert(l, pos, pointers[i]);
+    }
+    while (!list_is_empty(l)) {
+        sink += (uintptr_t)list_inspect(l, list_first(l));
+        list_remove(l, list_first(l));
+    }
+    list_kill(l);
+    return now() - start;
+}
+
+/*
+ * Empties a queue into sink.
+ */
+static void drain(pqueue *pq)
+{
+    while (!pqueue_is_empty(pq)) {
+        sink += (uintptr_t)pqueue_inspect_first(pq);
+        pqueue_delete_first(pq);
+    }
+    pqueue_kill(pq);
+}
+
+static double time_heap(void **pointers, size_t n)
+{
+    double start = now();
+    pqueue *pq = pqueue_empty(compare_ints);
+
+    for (size_t i = 0; i < n; i++) {
+        pqueue_insert(pq, pointers[i]);
+    }
+    drain(pq);
+    return now() - start;
+}
+
+static double time_heap_keys(void **pointers, const int *values, size_t n)
+{
+    double start = now();
+    pqueue *pq = pqueue_empty(NULL);
+
+    for (size_t i = 0; i < n; i++) {
+        pqueue_insert_key(pq, values[i], pointers[i]);
+    }
+    drain(pq);
+    return now() - start;
+}
+
+static double time_heap_build(void **pointers, size_t n)
+{
+    double start = now();
+
+    drain(pqueue_build_from_array(compare_ints, pointers, n));
+    return now() - start;
+}
+
+/* ------------------------------------ Main ------------------------------------------------------------ */
+
+int main(int argc, char **argv)
+{
+    int max = argc > 1 ? atoi(argv[1]) : DEFAULT_MAX;
+    size_t max_n = 1;
+    for (int i = 0; i < max; i++) {
+        max_n *= 10;
+    }
+
+    int *values = malloc(max_n * sizeof(int));
+    void **pointers = malloc(max_n * sizeof(void *));
+    if (max < 2 || values == NULL || pointers == NULL) {
+        fprintf(stderr, "Usage: bench_pqueue [MAX], with MAX >= 2\n");
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < max_n; i++) {
+        values[i] = (int)(next_random() % 1000000);
+        pointers[i] = &values[i];
+    }
+
+    printf("%10s %12s %12s %12s %12s   (ns per element: insert and delete all)\n",
+           "elements", "sorted list", "heap", "heap keys", "heap build");
+    for (size_t n = 100; n <= max_n; n *= 10) {
+        double ns = 1e9 / n;
+        if (n <= LIST_MAX) {
+            printf("%10zu %12.1f", n, time_list(pointers, n) * ns);
+        } else {
+            printf("%10zu %12s", n, "-");
+        }
+        printf(" %12.1f", time_heap(pointers, n) * ns);
+        printf(" %12.1f", time_heap_keys(pointers, values, n) * ns);
+        printf(" %12.1f\n", time_heap_build(pointers, n) * ns);
+    }
+
+    free(pointers);
+    free(values);
+    return EXIT_SUCCESS;
+}
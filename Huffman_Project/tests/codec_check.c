@@ -0,0 +1,331 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         codec_check.c
+ * Description:  Round-trip and differential checks of the Huffman codec, used by the round-trip
+ *               test and the fuzz harness. Files are emulated with tmpfile().
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "codec_check.h"
+#include "../byte_io.h"
+#include "../frequency_table.h"
+#include "../estimate.h"
+#include "../pipeline.h"
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+/*
+ * Returns a temporary file holding a copy of an array, positioned at the start.
+ */
+static FILE *file_from(const unsigned char *data, size_t size)
+{
+    FILE *file = tmpfile();
+    if (file == NULL) {
+        return NULL;
+    }
+    if (fwrite(data, 1, size, file) != size) {
+        fclose(file);
+        return NULL;
+    }
+    rewind(file);
+    return file;
+}
+
+/*
+ * Reads the whole content of a file into a new array. The array has room for at least one byte,
+ * so that it is never NULL on success.
+ */
+static unsigned char *slurp(FILE *file, size_t *size)
+{
+    if (fseek(file, 0, SEEK_END) != 0) {
+        return NULL;
+    }
+    long length = ftell(file);
+    rewind(file);
+
+    unsigned char *data = malloc(length + 1);
+    if (data == NULL) {
+        return NULL;
+    }
+    if (fread(data, 1, length, file) != (size_t)length) {
+        free(data);
+        return NULL;
+    }
+    *size = length;
+    return data;
+}
+
+/*
+ * Runs check_decoders_agree() on every Huffman block of an encoded stream.
+ */
+static const char *check_blocks(const huff_codec *codec, const unsigned char *encoded, size_t size)
+{
+    size_t pos = HUFF_HEADER_SIZE;
+    size_t blocks = 0;
+
+    while (pos + BLOCK_HEADER_SIZE <= size) {
+        const unsigned char *header = encoded + pos;
+        int type = header[0];
+        uint32_t raw_size = get_u32(header + 1);
+        uint32_t payload_size = get_u32(header + 5);
+
+        pos += BLOCK_HEADER_SIZE;
+        if (type == BLOCK_END) {
+            if (pos + payload_size != size || payload_size != end_block_size(blocks) - BLOCK_HEADER_SIZE) {
+                return "the end block does not index every block";
+            }
+            return get_u32(encoded + size - INDEX_TRAILER_SIZE) == blocks ? NULL : "wrong block count in the index";
+        }
+        blocks++;
+        if (pos + payload_size > size) {
+            return "block payload runs past the end of the stream";
+        }
+        if (type == BLOCK_HUFFMAN) {
+            const char *failure = check_decoders_agree(codec, encoded + pos, payload_size, raw_size);
+            if (failure != NULL) {
+                return failure;
+            }
+        }
+        pos += payload_size;
+    }
+    return "stream has no end block";
+}
+
+/*
+ * Encodes and decodes an input with the three-thread pipeline, whose output must be the same as
+ * that of encode_stream() and decode_stream().
+ */
+static const char *check_pipeline(const huff_codec *codec, FILE *input, const unsigned char *data, size_t size,
+                                  const unsigned char *encoded_data, size_t encoded_size)
+{
+    const char *failure = NULL;
+    FILE *encoded = tmpfile();
+    FILE *decoded = tmpfile();
+    unsigned char *pipeline_data = NULL;
+    size_t pipeline_size = 0;
+    codec_stats stats;
+
+    if (encoded == NULL || decoded == NULL || fseek(input, 0, SEEK_SET) != 0) {
+        failure = "could not create temporary files";
+    } else if (pipeline_encode(input, encoded, codec, &stats) != 0) {
+        failure = "pipeline encoding failed";
+    } else if ((pipeline_data = slurp(encoded, &pipeline_size)) == NULL) {
+        failure = "could not read the pipeline encoded stream";
+    } else if (pipeline_size != encoded_size || memcmp(pipeline_data, encoded_data, encoded_size) != 0) {
+        failure = "pipeline encoded stream differs from encode_stream";
+    } else if (stats.bytes_in != (long)size || stats.bytes_out != (long)encoded_size) {
+        failure = "pipeline reported wrong byte counts";
+    } else if (fseek(encoded, 0, SEEK_SET) != 0 || pipeline_decode(encoded, decoded, codec, &stats) != DECODE_OK) {
+        failure = "pipeline decoding failed";
+    } else if (stats.bytes_in != (long)encoded_size) {
+        failure = "pipeline decoder did not count every encoded byte";
+    } else {
+        free(pipeline_data);
+        pipeline_data = slurp(decoded, &pipeline_size);
+        if (pipeline_data == NULL || pipeline_size != size || memcmp(pipeline_data, data, size) != 0) {
+            failure = "pipeline decoded bytes differ from the input";
+        }
+    }
+
+    free(pipeline_data);
+    if (encoded != NULL) {
+        fclose(encoded);
+    }
+    if (decoded != NULL) {
+        fclose(decoded);
+    }
+    return failure;
+}
+
+/* ------------------------------------ External functions ---------------------------------------------- */
+
+huff_codec *check_codec_for(const unsigned char *data, size_t size)
+{
+    FILE *file = file_from(data, size);
+    if (file == NULL) {
+        return NULL;
+    }
+
+    int *frequency_table = create_frequency_table(file);
+    fclose(file);
+    if (frequency_table == NULL) {
+        return NULL;
+    }
+
+    huff_codec *codec = codec_create(frequency_table);
+    free(frequency_table);
+    return codec;
+}
+
+const char *check_roundtrip(const huff_codec *codec, const unsigned char *data, size_t size)
+{
+    const char *failure = NULL;
+    FILE *input = file_from(data, size);
+    FILE *encoded = tmpfile();
+    FILE *decoded = tmpfile();
+    bit_buffer *buffer = bit_buffer_empty();
+    unsigned char *encoded_data = NULL;
+    unsigned char *decoded_data = NULL;
+    size_t encoded_size = 0;
+    size_t decoded_size = 0;
+    codec_stats stats;
+    estimate_report report;
+
+    if (input == NULL || encoded == NULL || decoded == NULL || buffer == NULL) {
+        failure = "could not create temporary files";
+    } else if (estimate_stream(input, codec, 1, &report) != 0 || fseek(input, 0, SEEK_SET) != 0) {
+        failure = "estimating failed";
+    } else if (encode_stream(input, encoded, codec, buffer, &stats) != 0) {
+        failure = "encoding failed";
+    } else if (bit_buffer_size(buffer) != 0) {
+        failure = "bit buffer not empty after encoding";
+    } else if (stats.bytes_in != (long)size) {
+        failure = "encoder did not read the whole input";
+    } else if ((encoded_data = slurp(encoded, &encoded_size)) == NULL) {
+        failure = "could not read the encoded stream";
+    } else if (encoded_size != (size_t)stats.bytes_out) {
+        failure = "encoder reported the wrong output size";
+    } else if (estimate_encoded_size(&report) != (long long)encoded_size) {
+        failure = "estimated size differs from the encoded size";
+    } else if ((failure = check_blocks(codec, encoded_data, encoded_size)) != NULL) {
+        // failure describes the block that failed
+    } else if (fseek(encoded, 0, SEEK_SET) != 0 || decode_stream(encoded, decoded, codec, &stats) != DECODE_OK) {
+        failure = "decoding failed";
+    } else if (stats.bytes_in != (long)encoded_size) {
+        failure = "decoder did not count every encoded byte";
+    } else if ((decoded_data = slurp(decoded, &decoded_size)) == NULL) {
+        failure = "could not read the decoded stream";
+    } else if (decoded_size != size || memcmp(decoded_data, data, size) != 0) {
+        failure = "decoded bytes differ from the input";
+    } else {
+        failure = check_pipeline(codec, input, data, size, encoded_data, encoded_size);
+    }
+
+    free(encoded_data);
+    free(decoded_data);
+    if (buffer != NULL) {
+        bit_buffer_free(buffer);
+    }
+    if (input != NULL) {
+        fclose(input);
+    }
+    if (encoded != NULL) {
+        fclose(encoded);
+    }
+    if (decoded != NULL) {
+        fclose(decoded);
+    }
+    return failure;
+}
+
+const char *check_decoders_agree(const huff_codec *codec, const unsigned char *payload, size_t payload_size,
+                                 size_t raw_size)
+{
+    const char *failure = NULL;
+    unsigned char *fast = malloc(raw_size + 1);
+    unsigned char *reference = malloc(raw_size + 1);
+
+    if (fast == NULL || reference == NULL) {
+        failure = "out of memory";
+    } else {
+        bit_reader fast_reader;
+        bit_reader reference_reader;
+        bit_reader_init(&fast_reader, payload, payload_size);
+        bit_reader_init(&reference_reader, payload, payload_size);
+
+        decode_status fast_status = decode_table_run(codec->decoder, &fast_reader, fast, raw_size);
+        decode_status reference_status = decode_trie_run(codec->trie, &reference_reader, reference, raw_size);
+
+        if (fast_status != reference_status) {
+            failure = "table decoder and tree walk return different status";
+        } else if (fast_reader.consumed != reference_reader.consumed) {
+            failure = "table decoder and tree walk consume different numbers of bits";
+        } else if (fast_status == DECODE_OK && memcmp(fast, reference, raw_size) != 0) {
+            failure = "table decoder and tree walk decode different bytes";
+        }
+    }
+
+    free(fast);
+    free(reference);
+    return failure;
+}
+
+const char *check_decode_safe(const huff_codec *codec, const unsigned char *data, size_t size)
+{
+    FILE *input = file_from(data, size);
+    FILE *output = tmpfile();
+    const char *failure = NULL;
+    codec_stats stats;
+
+    if (input == NULL || output == NULL) {
+        failure = "could not create temporary files";
+    } else {
+        decode_stream(input, output, codec, &stats);
+        if (stats.bytes_in > (long)size) {
+            failure = "decoder read more bytes than the input holds";
+        }
+        rewind(input);
+        pipeline_decode(input, output, codec, &stats);
+        if (stats.bytes_in > (long)size) {
+            failure = "pipeline read more bytes than the input holds";
+        }
+    }
+
+    if (input != NULL) {
+        fclose(input);
+    }
+    if (output != NULL) {
+        fclose(output);
+    }
+    return failure;
+}
+
+const char *check_failed_decode(const huff_codec *codec, const unsigned char *data, size_t size)
+{
+    FILE *input = file_from(data, size);
+    FILE *sequential = tmpfile();
+    FILE *pipelined = tmpfile();
+    unsigned char *sequential_data = NULL;
+    unsigned char *pipeline_data = NULL;
+    size_t sequential_size = 0;
+    size_t pipeline_size = 0;
+    const char *failure = NULL;
+    codec_stats stats;
+
+    if (input == NULL || sequential == NULL || pipelined == NULL) {
+        failure = "could not create temporary files";
+    } else {
+        decode_status expected = decode_stream(input, sequential, codec, &stats);
+        rewind(input);
+        decode_status status = pipeline_decode(input, pipelined, codec, &stats);
+        if (status != expected) {
+            failure = "pipeline reported another error than decode_stream";
+        } else if ((sequential_data = slurp(sequential, &sequential_size)) == NULL ||
+                   (pipeline_data = slurp(pipelined, &pipeline_size)) == NULL) {
+            failure = "could not read the decoded streams";
+        } else if (pipeline_size != sequential_size || memcmp(pipeline_data, sequential_data, pipeline_size) != 0) {
+            failure = "pipeline wrote other bytes than decode_stream";
+        }
+    }
+
+    free(sequential_data);
+    free(pipeline_data);
+    if (input != NULL) {
+        fclose(input);
+    }
+    if (sequential != NULL) {
+        fclose(sequential);
+    }
+    if (pipelined != NULL) {
+        fclose(pipelined);
+    }
+    return failure;
+}
@@ -0,0 +1,91 @@
+/**
+ * @defgroup CodecCheck
+ * @brief Checks shared by the round-trip test and the fuzz harness.
+ *
+ * Every check returns NULL if it passes, or a short description of what went wrong. The checks
+ * compare the fast paths of the codec against simple reference implementations, so that any
+ * optimisation that changes the output is caught: encoded data must decode to the original input,
+ * and the table-driven decoder must agree with the reference tree walk bit for bit, also on garbage.
+ *
+ * @section Author
+ *  - Author: Abdiaziz Ibrahim Adam
+ * @since Datum
+ *  - 18 October 2026
+ * @{
+ */
+
+#ifndef CODEC_CHECK_H
+#define CODEC_CHECK_H
+
+#include <stddef.h>
+#include "../encode_decode.h"
+
+/**
+ * @brief Builds a codec from the byte frequencies of an array, as the program does for a file.
+ *
+ * @warning Memory allocation: It's the caller's responsibility to free the codec with codec_free().
+ *
+ * @param data The bytes to count.
+ * @param size The number of bytes.
+ * @return Pointer to the new codec, or NULL if it could not be built.
+ */
+huff_codec *check_codec_for(const unsigned char *data, size_t size);
+
+/**
+ * @brief Encodes an array, decodes the result and compares it with the array.
+ *
+ * Every Huffman block of the encoded stream is also checked with check_decoders_agree(), the size
+ * predicted by estimate_stream() must equal the encoded size, and the pipeline must produce the same
+ * bytes as encode_stream() and decode_stream().
+ *
+ * @param codec The codec to encode and decode with.
+ * @param data The bytes to encode.
+ * @param size The number of bytes.
+ * @return NULL if the check passes, otherwise a description of the failure.
+ */
+const char *check_roundtrip(const huff_codec *codec, const unsigned char *data, size_t size);
+
+/**
+ * @brief Decodes a payload with both the decode table and the reference tree walk.
+ *
+ * The two decoders must return the same status, consume the same number of bits and, on success,
+ * produce the same bytes. The payload may be arbitrary bytes.
+ *
+ * @param codec The codec to decode with.
+ * @param payload The encoded bits.
+ * @param payload_size The number of payload bytes.
+ * @param raw_size The number of bytes to decode.
+ * @return NULL if the check passes, otherwise a description of the failure.
+ */
+const char *check_decoders_agree(const huff_codec *codec, const unsigned char *payload, size_t payload_size,
+                                 size_t raw_size);
+
+/**
+ * @brief Decodes arbitrary bytes as an encoded file.
+ *
+ * Any decode status is accepted; the check is that decoding returns at all, which together with the
+ * sanitizers shows that hostile input is handled safely.
+ *
+ * @param codec The codec to decode with.
+ * @param data The bytes to decode.
+ * @param size The number of bytes.
+ * @return NULL if the check passes, otherwise a description of the failure.
+ */
+const char *check_decode_safe(const huff_codec *codec, const unsigned char *data, size_t size);
+
+/**
+ * @brief Decodes a damaged encoded file with decode_stream() and with the pipeline.
+ *
+ * Both must report the same status and write the same bytes: the blocks before the damage, whatever
+ * the timing of the pipeline's threads.
+ *
+ * @param codec The codec to decode with.
+ * @param data The bytes to decode, for example an encoded file cut short.
+ * @param size The number of bytes.
+ * @return NULL if the check passes, otherwise a description of the failure.
+ */
+const char *check_failed_decode(const huff_codec *codec, const unsigned char *data, size_t size);
+
+#endif /* CODEC_CHECK_H */
+
+/** @} */
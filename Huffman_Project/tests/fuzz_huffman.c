@@ -0,0 +1,111 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         fuzz_huffman.c
+ * Description:  Fuzz harness for the Huffman codec, built for libFuzzer with "make fuzz". Each input is
+ *               decoded as an encoded file, decoded as a raw block payload by both the decode table
+ *               and the reference tree walk, and round-tripped with a codec built from its own bytes.
+ *
+ *               Built with -DFUZZ_STANDALONE ("make fuzz_standalone") the harness gets a main that
+ *               runs every file named on the command line, or stdin if there are none, which is
+ *               what AFL and crash reproduction need.
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "codec_check.h"
+
+#define FUZZ_MAX_INPUT (1 << 20)   // Larger inputs only slow the fuzzer down
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static huff_codec *flat_codec;
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+/*
+ * Stops at the first failed check, so that the fuzzer saves the input.
+ */
+static void require(const char *failure)
+{
+    if (failure != NULL) {
+        fprintf(stderr, "check failed: %s\n", failure);
+        abort();
+    }
+}
+
+/* ------------------------------------ External functions ---------------------------------------------- */
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (flat_codec == NULL) {
+        int flat_table[256];
+        for (int i = 0; i < 256; i++) {
+            flat_table[i] = 1;
+        }
+        flat_codec = codec_create(flat_table);
+    }
+    if (size > FUZZ_MAX_INPUT) {
+        return 0;
+    }
+
+    // Hostile input must be rejected or decoded, never crash
+    require(check_decode_safe(flat_codec, data, size));
+
+    // The fast decoder must agree with the tree walk, also on invalid codes and overruns
+    require(check_decoders_agree(flat_codec, data, size, size * 2));
+
+    huff_codec *own = check_codec_for(data, size);
+    if (own != NULL) {
+        require(check_decoders_agree(own, data, size, size * 2));
+        require(check_roundtrip(own, data, size));
+        codec_free(own);
+    }
+    require(check_roundtrip(flat_codec, data, size));
+
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+/*
+ * Runs one input read from a file.
+ */
+static int run_file(FILE *file)
+{
+    unsigned char *data = malloc(FUZZ_MAX_INPUT);
+    if (data == NULL) {
+        return 1;
+    }
+    size_t size = fread(data, 1, FUZZ_MAX_INPUT, file);
+    LLVMFuzzerTestOneInput(data, size);
+    free(data);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int result = 0;
+
+    if (argc < 2) {
+        result = run_file(stdin);
+    }
+    for (int i = 1; i < argc; i++) {
+        FILE *file = fopen(argv[i], "rb");
+        if (file == NULL) {
+            fprintf(stderr, "Failed to open %s\n", argv[i]);
+            result = 1;
+            continue;
+        }
+        result |= run_file(file);
+        fclose(file);
+    }
+
+    codec_free(flat_codec);
+    return result;
+}
+#endif
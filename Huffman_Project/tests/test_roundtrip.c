@@ -0,0 +1,1316 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         test_roundtrip.c
+ * Description:  Property-based round-trip test of the Huffman codec. Empty, single-symbol,
+ *               all-256-symbol, highly skewed, run-heavy and random inputs are encoded and decoded,
+ *               both with a codec built from the input itself and with one built from a flat table, and every
+ *               block is decoded by the decode table and the reference tree walk. Inputs with bytes
+ *               that the codec has no code for must survive in blocks with a tree of their own. Corrupted streams
+ *               and random payloads must be rejected or decoded without crashing. Random inputs are
+ *               generated from a fixed seed, which can be changed on the command line.
+ *
+ *               Usage: test_roundtrip [SEED]
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include "codec_check.h"
+#include "../huff_table.h"
+#include "../parallel_decode.h"
+#include "../list.h"
+#include "../pqueue.h"
+#include "../output_sink.h"
+#include "../frequency_table.h"
+#include "../table_file.h"
+#include "../train.h"
+#include "../batch.h"
+#include "../estimate.h"
+#include "../checksum.h"
+#include "../pipeline.h"
+#include "../byte_io.h"
+
+#define RANDOM_CASES 12         // The number of random inputs per kind
+#define MUTATIONS 200           // The number of corrupted copies of an encoded stream
+
+static int tests_run = 0;
+static int tests_failed = 0;
+static uint64_t rng_state;
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+/*
+ * xorshift64*, a small PRNG whose sequence only depends on the seed.
+ */
+static uint64_t next_random(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ull;
+}
+
+static size_t random_below(size_t limit)
+{
+    return (size_t)(next_random() % limit);
+}
+
+/*
+ * Records the result of one check and prints failures.
+ */
+static void expect(const char *name, size_t size, const char *failure)
+{
+    tests_run++;
+    if (failure != NULL) {
+        tests_failed++;
+        printf("FAIL %s (%zu bytes): %s\n", name, size, failure);
+    }
+}
+
+/*
+ * Round-trips an input with a codec built from the input and with the flat codec.
+ */
+static void check_input(const char *name, const huff_codec *flat, const unsigned char *data, size_t size)
+{
+    huff_codec *own = check_codec_for(data, size);
+    if (own == NULL) {
+        expect(name, size, "could not build a codec for the input");
+    } else {
+        expect(name, size, check_roundtrip(own, data, size));
+        codec_free(own);
+    }
+    expect(name, size, check_roundtrip(flat, data, size));
+}
+
+static void test_empty(const huff_codec *flat)
+{
+    check_input("empty", flat, (const unsigned char *)"", 0);
+}
+
+static void test_single_symbol(const huff_codec *flat)
+{
+    static const size_t sizes[] = {1, 2, 7, 8, 9, 1000, BLOCK_SIZE, BLOCK_SIZE + 1, 3 * BLOCK_SIZE};
+    unsigned char *data = malloc(3 * BLOCK_SIZE);
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        for (int byte = 0; byte < 256; byte += 85) {
+            memset(data, byte, sizes[i]);
+            check_input("single symbol", flat, data, sizes[i]);
+        }
+    }
+    free(data);
+}
+
+static void test_all_symbols(const huff_codec *flat)
+{
+    unsigned char *data = malloc(2 * BLOCK_SIZE + 256);
+
+    for (int i = 0; i < 2 * BLOCK_SIZE + 256; i++) {
+        data[i] = (unsigned char)i;
+    }
+    check_input("all symbols once", flat, data, 256);
+    check_input("all symbols cycled", flat, data, 2 * BLOCK_SIZE + 256);
+    free(data);
+}
+
+/*
+ * Inputs where one byte dominates, which gives the longest codes the tree can have.
+ */
+static void test_skewed(const huff_codec *flat)
+{
+    unsigned char *data = malloc(4 * BLOCK_SIZE);
+
+    for (int i = 0; i < RANDOM_CASES; i++) {
+        size_t size = 1 + random_below(3 * BLOCK_SIZE);
+        unsigned int rare = 1 + (unsigned int)random_below(1000);
+        for (size_t j = 0; j < size; j++) {
+            data[j] = random_below(1000) < rare ? (unsigned char)next_random() : 'e';
+        }
+        check_input("skewed", flat, data, size);
+    }
+
+    // Fibonacci-like counts give the deepest possible tree
+    size_t size = 0;
+    size_t count = 1;
+    size_t previous = 1;
+    for (int byte = 0; byte < 256 && size + count <= 4 * BLOCK_SIZE; byte++) {
+        memset(data + size, byte, count);
+        size += count;
+        size_t next = count + previous;
+        previous = count;
+        count = next;
+    }
+    check_input("fibonacci", flat, data, size);
+    free(data);
+}
+
+/*
+ * A block where one byte has a probability far above 1/2 costs Huffman a whole bit per byte, so tANS
+ * must be chosen for it, and its payload must round-trip.
+ */
+static void test_tans(void)
+{
+    unsigned char *data = malloc(BLOCK_SIZE);
+    unsigned char *decoded = malloc(BLOCK_SIZE);
+    unsigned char *payload = malloc(BLOCK_SIZE);
+    size_t count[256];
+    size_t runs;
+    size_t payload_size;
+
+    for (size_t j = 0; j < BLOCK_SIZE; j++) {
+        data[j] = random_below(100) < 5 ? (unsigned char)('a' + random_below(4)) : 'e';
+    }
+    huff_codec *own = check_codec_for(data, BLOCK_SIZE);
+
+    block_histogram(data, BLOCK_SIZE, count, &runs);
+    int type = block_choose_type(own, data, count, runs, BLOCK_SIZE, &payload_size);
+    expect("tans chosen", BLOCK_SIZE, type == BLOCK_TANS ? NULL : "a skewed block was not tANS coded");
+    expect("tans chosen", BLOCK_SIZE, payload_size < BLOCK_SIZE / 8 ? NULL : "tANS payload is not below 1 bit per byte");
+
+    size_t size = tans_encode(own->tans, data, BLOCK_SIZE, payload);
+    expect("tans size", size, size == tans_payload_size(own->tans, data, BLOCK_SIZE) ? NULL :
+           "tans_payload_size() differs from the encoded size");
+    decode_status status = tans_decode(own->tans, payload, size, decoded, BLOCK_SIZE);
+    expect("tans roundtrip", size, status == DECODE_OK && memcmp(data, decoded, BLOCK_SIZE) == 0 ? NULL :
+           "tANS payload did not decode to the block");
+
+    codec_free(own);
+    free(data);
+    free(decoded);
+    free(payload);
+}
+
+static void test_random(const huff_codec *flat)
+{
+    unsigned char *data = malloc(4 * BLOCK_SIZE);
+
+    for (int i = 0; i < RANDOM_CASES; i++) {
+        size_t size = random_below(3 * BLOCK_SIZE);
+        size_t alphabet = 1 + random_below(256);
+        for (size_t j = 0; j < size; j++) {
+            data[j] = (unsigned char)random_below(alphabet);
+        }
+        check_input("random", flat, data, size);
+    }
+    free(data);
+}
+
+/*
+ * Inputs made of runs of equal bytes, from runs of one byte to runs longer than a block.
+ */
+static void test_runs(const huff_codec *flat)
+{
+    unsigned char *data = malloc(3 * BLOCK_SIZE);
+
+    for (int i = 0; i < RANDOM_CASES; i++) {
+        size_t size = random_below(3 * BLOCK_SIZE);
+        size_t longest = 1 + random_below(i % 2 == 0 ? 16 : 2 * BLOCK_SIZE);
+        size_t pos = 0;
+        while (pos < size) {
+            size_t run = 1 + random_below(longest);
+            run = run < size - pos ? run : size - pos;
+            memset(data + pos, (int)random_below(8), run);
+            pos += run;
+        }
+        check_input("runs", flat, data, size);
+    }
+    free(data);
+}
+
+/*
+ * Inputs of several blocks through a pipeline with a single slot, as under the smallest memory limit,
+ * and a block header that asks for more payload than a slot holds, which must be refused before
+ * anything is allocated for it.
+ */
+static void test_memory_limit(huff_codec *flat)
+{
+    unsigned char *data = malloc(4 * BLOCK_SIZE);
+
+    expect("memory limit slots", PIPELINE_MIN_MEMORY,
+           pipeline_slots(PIPELINE_MIN_MEMORY) == 1 ? NULL : "the smallest limit has more than one slot");
+    expect("memory limit sink", PIPELINE_MIN_MEMORY,
+           pipeline_sink_capacity(PIPELINE_MIN_MEMORY) == BLOCK_SIZE ? NULL : "the smallest limit has a larger sink");
+    expect("memory limit slots", 64 * 1024 * 1024,
+           pipeline_slots(64 * 1024 * 1024) == PIPELINE_SLOTS ? NULL : "a large limit has fewer slots");
+
+    flat->memory_limit = PIPELINE_MIN_MEMORY;
+    for (int i = 0; i < 3; i++) {
+        size_t size = random_below(4 * BLOCK_SIZE);
+        for (size_t j = 0; j < size; j++) {
+            data[j] = (unsigned char)random_below(64);
+        }
+        check_input("memory limit", flat, data, size);
+    }
+
+    // The file header of an empty input, then a Huffman block of the largest payload its header may claim
+    FILE *input = tmpfile();
+    FILE *encoded = tmpfile();
+    FILE *output = tmpfile();
+    bit_buffer *buffer = bit_buffer_empty();
+    codec_stats stats;
+    unsigned char header[HUFF_HEADER_SIZE + BLOCK_HEADER_SIZE] = {0};
+    encode_stream(input, encoded, flat, buffer, &stats);
+    rewind(encoded);
+    size_t header_size = fread(header, 1, HUFF_HEADER_SIZE, encoded);
+    header[HUFF_HEADER_SIZE] = BLOCK_HUFFMAN;
+    put_u32(header + HUFF_HEADER_SIZE + 1, BLOCK_SIZE);
+    put_u32(header + HUFF_HEADER_SIZE + 5, BLOCK_SIZE * 32);
+    fclose(encoded);
+    encoded = tmpfile();
+    fwrite(header, 1, header_size + BLOCK_HEADER_SIZE, encoded);
+
+    rewind(encoded);
+    decode_status status = decode_stream(encoded, output, flat, &stats);
+    expect("memory limit oversized block", BLOCK_SIZE * 32,
+           status == DECODE_OVER_LIMIT ? NULL : "the sequential decoder did not refuse the block");
+    rewind(encoded);
+    status = pipeline_decode(encoded, output, flat, &stats);
+    expect("memory limit oversized block", BLOCK_SIZE * 32,
+           status == DECODE_OVER_LIMIT ? NULL : "the pipeline did not refuse the block");
+    flat->memory_limit = 0;
+
+    bit_buffer_free(buffer);
+    fclose(output);
+    fclose(encoded);
+    fclose(input);
+    free(data);
+}
+
+/*
+ * Encodes inputs with a codec that lacks codes for some of their bytes, so that blocks need a tree of their own.
+ */
+static void test_missing_symbols(void)
+{
+    unsigned char *data = malloc(3 * BLOCK_SIZE);
+    huff_codec *text = check_codec_for((const unsigned char *)"abracadabra", 11);
+
+    for (int i = 0; i < RANDOM_CASES; i++) {
+        size_t size = random_below(3 * BLOCK_SIZE);
+        for (size_t j = 0; j < size; j++) {
+            data[j] = random_below(100) == 0 ? (unsigned char)next_random() : "abcdr"[random_below(5)];
+        }
+        expect("missing symbols", size, check_roundtrip(text, data, size));
+    }
+
+    codec_free(text);
+    free(data);
+}
+
+/*
+ * A block the shared tree codes except for one byte must still be compressed, with a tree of its own.
+ */
+static void test_unknown_byte_size(void)
+{
+    unsigned char *data = malloc(BLOCK_SIZE);
+    huff_codec *text = check_codec_for((const unsigned char *)"abracadabra", 11);
+
+    for (size_t j = 0; j < BLOCK_SIZE; j++) {
+        data[j] = "abcdr"[random_below(5)];
+    }
+    data[BLOCK_SIZE / 2] = 'z';
+
+    size_t count[256];
+    size_t runs;
+    size_t payload_size;
+    block_histogram(data, BLOCK_SIZE, count, &runs);
+    int type = block_choose_type(text, data, count, runs, BLOCK_SIZE, &payload_size);
+
+    // Five equally common bytes take less than three bits each
+    expect("unknown byte type", BLOCK_SIZE, type == BLOCK_STORED ? "block with one unknown byte was stored" : NULL);
+    expect("unknown byte size", BLOCK_SIZE,
+           payload_size > LOCAL_LENGTHS_SIZE + BLOCK_SIZE * 3 / 8 ? "block with one unknown byte is too large" : NULL);
+    expect("unknown byte", BLOCK_SIZE, check_roundtrip(text, data, BLOCK_SIZE));
+
+    codec_free(text);
+    free(data);
+}
+
+/*
+ * The table-driven CRC32C must give the check value and agree with crc32c(), which uses the crc32
+ * instruction where there is one, on random buffers of any length and alignment.
+ */
+static void test_checksum(void)
+{
+    unsigned char data[4096 + 8];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (unsigned char)next_random();
+    }
+
+    expect("crc32c check value", 9, crc32c("123456789", 9) != 0xE3069283u ? "wrong checksum" : NULL);
+    expect("crc32c software check value", 9,
+           crc32c_software("123456789", 9) != 0xE3069283u ? "wrong checksum" : NULL);
+
+    for (int i = 0; i < 200; i++) {
+        size_t offset = random_below(8);
+        size_t size = i < 64 ? (size_t)i : random_below(4096);
+        expect("crc32c software", size,
+               crc32c_software(data + offset, size) != crc32c(data + offset, size) ? "versions differ" : NULL);
+    }
+}
+
+/*
+ * Cuts an encoded file of several blocks short at random points. The pipeline must keep the blocks
+ * before the cut, like the sequential decoder, however far its reader got ahead of the other stages.
+ */
+static void test_truncated(void)
+{
+    size_t size = 12 * BLOCK_SIZE + 1000;
+    unsigned char *data = malloc(size);
+    for (size_t j = 0; j < size; j++) {
+        data[j] = (unsigned char)(random_below(8) == 0 ? next_random() : "etaoin "[random_below(7)]);
+    }
+    huff_codec *own = check_codec_for(data, size);
+
+    FILE *input = tmpfile();
+    FILE *encoded = tmpfile();
+    bit_buffer *buffer = bit_buffer_empty();
+    codec_stats stats;
+    fwrite(data, 1, size, input);
+    rewind(input);
+    encode_stream(input, encoded, own, buffer, &stats);
+
+    unsigned char *stream = malloc(stats.bytes_out);
+    rewind(encoded);
+    size_t stream_size = fread(stream, 1, stats.bytes_out, encoded);
+
+    for (int i = 0; i < RANDOM_CASES * 4; i++) {
+        size_t cut = HUFF_HEADER_SIZE + random_below(stream_size - HUFF_HEADER_SIZE);
+        expect("truncated pipeline", cut, check_failed_decode(own, stream, cut));
+    }
+
+    free(stream);
+    bit_buffer_free(buffer);
+    fclose(encoded);
+    fclose(input);
+    codec_free(own);
+    free(data);
+}
+
+/*
+ * A report whose sampled blocks turned out empty, as when the file shrinks between sizing and reading it,
+ * must not divide by the zero sampled bytes.
+ */
+static void test_estimate_unsampled(void)
+{
+    estimate_report report;
+    memset(&report, 0, sizeof(report));
+    report.bytes_in = 3 * BLOCK_SIZE;
+    report.blocks = 3;
+    report.codable = true;
+
+    long long size = estimate_encoded_size(&report);
+    expect("estimate without samples", 0,
+           size < HUFF_HEADER_SIZE + 3 * BLOCK_HEADER_SIZE ? "encoded size is not a valid size" : NULL);
+    expect("estimate without samples", 0, estimate_shannon_bound(&report) != 0 ? "bound is not 0" : NULL);
+}
+
+/*
+ * Corrupts single bytes of an encoded stream. The decoder may report any error, but must not crash.
+ */
+static void test_corrupted(const huff_codec *flat)
+{
+    unsigned char data[4096];
+    for (size_t j = 0; j < sizeof(data); j++) {
+        data[j] = (unsigned char)random_below(64);
+    }
+
+    FILE *input = tmpfile();
+    FILE *encoded = tmpfile();
+    bit_buffer *buffer = bit_buffer_empty();
+    codec_stats stats;
+
+    fwrite(data, 1, sizeof(data), input);
+    rewind(input);
+    encode_stream(input, encoded, flat, buffer, &stats);
+
+    unsigned char *stream = malloc(stats.bytes_out);
+    rewind(encoded);
+    size_t size = fread(stream, 1, stats.bytes_out, encoded);
+
+    for (int i = 0; i < MUTATIONS; i++) {
+        size_t pos = random_below(size);
+        unsigned char saved = stream[pos];
+        stream[pos] ^= (unsigned char)(1 + random_below(255));
+        expect("corrupted stream", size, check_decode_safe(flat, stream, size));
+        expect("truncated stream", pos, check_decode_safe(flat, stream, pos));
+        stream[pos] = saved;
+    }
+
+    free(stream);
+    bit_buffer_free(buffer);
+    fclose(input);
+    fclose(encoded);
+}
+
+/*
+ * Encodes the first bytes of data into an archive, appends the next second bytes and decodes the
+ * archive, which must give both parts in order and index every block. Without indexed the archive
+ * first ends like older version 3 files, with an end block without an index.
+ */
+static const char *check_append(const huff_codec *codec, const unsigned char *data, size_t first, size_t second,
+                                bool indexed)
+{
+    FILE *archive = tmpfile();
+    FILE *input = tmpfile();
+    FILE *decoded = tmpfile();
+    bit_buffer *buffer = bit_buffer_empty();
+    unsigned char *encoded = malloc(BLOCK_HEADER_SIZE + BLOCK_SIZE);
+    unsigned char *out = malloc(first + second + 1);
+    block_index index = {NULL, 0, 0};
+    codec_stats stats;
+    long end_offset;
+    const char *failure = NULL;
+
+    if (indexed) {
+        fwrite(data, 1, first, input);
+        rewind(input);
+        encode_stream(input, archive, codec, buffer, &stats);
+    } else {
+        unsigned char end[BLOCK_HEADER_SIZE] = {BLOCK_END};
+        write_file_header(archive, codec);
+        for (size_t pos = 0; pos < first; pos += BLOCK_SIZE) {
+            size_t size = first - pos < BLOCK_SIZE ? first - pos : BLOCK_SIZE;
+            fwrite(encoded, 1, encode_block(codec, buffer, data + pos, size, encoded), archive);
+        }
+        fwrite(end, 1, sizeof(end), archive);
+    }
+    fclose(input);
+    input = tmpfile();
+    fwrite(data + first, 1, second, input);
+    rewind(input);
+
+    size_t num_blocks = (first + BLOCK_SIZE - 1) / BLOCK_SIZE + (second + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    if (append_stream(input, archive, codec, &stats) != DECODE_OK || stats.bytes_in != (long)second) {
+        failure = "append failed";
+    } else if (read_block_index(archive, codec, &index, &end_offset) != DECODE_OK || index.count != num_blocks) {
+        failure = "the end block does not index every block";
+    } else {
+        rewind(archive);
+        if (decode_stream(archive, decoded, codec, &stats) != DECODE_OK) {
+            failure = "appended archive does not decode";
+        } else {
+            rewind(decoded);
+            if (fread(out, 1, first + second + 1, decoded) != first + second ||
+                memcmp(out, data, first + second) != 0) {
+                failure = "appended archive decodes to other bytes";
+            }
+        }
+    }
+
+    block_index_free(&index);
+    free(out);
+    free(encoded);
+    bit_buffer_free(buffer);
+    fclose(decoded);
+    fclose(input);
+    fclose(archive);
+    return failure;
+}
+
+/*
+ * Reads a whole file into a new array of at least one byte.
+ */
+static unsigned char *read_whole(FILE *file, size_t *size)
+{
+    fseek(file, 0, SEEK_END);
+    *size = (size_t)ftell(file);
+    unsigned char *bytes = malloc(*size + 1);
+    rewind(file);
+    if (bytes != NULL && fread(bytes, 1, *size, file) != *size) {
+        free(bytes);
+        return NULL;
+    }
+    return bytes;
+}
+
+/*
+ * Appends to an archive while the file size limit lets only part of the new blocks be written, as
+ * when the disk fills up. The append must fail and leave the archive as it was, end block included.
+ */
+static const char *check_failed_append(const huff_codec *codec, const unsigned char *data, size_t first,
+                                       size_t second)
+{
+    FILE *archive = tmpfile();
+    FILE *input = tmpfile();
+    FILE *decoded = tmpfile();
+    bit_buffer *buffer = bit_buffer_empty();
+    codec_stats stats;
+    const char *failure = NULL;
+
+    fwrite(data, 1, first, input);
+    rewind(input);
+    encode_stream(input, archive, codec, buffer, &stats);
+    fflush(archive);
+    fclose(input);
+    input = tmpfile();
+    fwrite(data + first, 1, second, input);
+    rewind(input);
+
+    size_t before_size;
+    unsigned char *before = read_whole(archive, &before_size);
+
+    // Writes past the limit fail with EFBIG instead of killing the process
+    struct rlimit old_limit;
+    struct rlimit limit;
+    getrlimit(RLIMIT_FSIZE, &old_limit);
+    limit = old_limit;
+    limit.rlim_cur = before_size + BLOCK_SIZE;
+    void (*old_handler)(int) = signal(SIGXFSZ, SIG_IGN);
+    setrlimit(RLIMIT_FSIZE, &limit);
+    decode_status status = append_stream(input, archive, codec, &stats);
+    setrlimit(RLIMIT_FSIZE, &old_limit);
+    signal(SIGXFSZ, old_handler);
+
+    size_t after_size;
+    unsigned char *after = read_whole(archive, &after_size);
+    rewind(archive);
+    if (status == DECODE_OK) {
+        failure = "append past the file size limit succeeded";
+    } else if (before == NULL || after == NULL || after_size != before_size ||
+               memcmp(after, before, before_size) != 0) {
+        failure = "failed append changed the archive";
+    } else if (decode_stream(archive, decoded, codec, &stats) != DECODE_OK) {
+        failure = "archive does not decode after a failed append";
+    }
+
+    free(before);
+    free(after);
+    bit_buffer_free(buffer);
+    fclose(decoded);
+    fclose(input);
+    fclose(archive);
+    return failure;
+}
+
+/*
+ * Appends to archives with and without an index, and to one encoded with another table.
+ */
+static void test_append(const huff_codec *flat)
+{
+    static const size_t sizes[][2] = {
+        {0, 0}, {0, 100}, {100, 0}, {100, 5000}, {2 * BLOCK_SIZE + 7, BLOCK_SIZE + 1}, {BLOCK_SIZE, BLOCK_SIZE}
+    };
+    size_t max_size = 4 * BLOCK_SIZE;
+    unsigned char *data = malloc(max_size);
+    for (size_t i = 0; i < max_size; i++) {
+        data[i] = (unsigned char)random_below(64);
+    }
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        size_t size = sizes[i][0] + sizes[i][1];
+        expect("append", size, check_append(flat, data, sizes[i][0], sizes[i][1], true));
+        expect("append without index", size, check_append(flat, data, sizes[i][0], sizes[i][1], false));
+    }
+    expect("failed append", max_size, check_failed_append(flat, data, BLOCK_SIZE / 2, max_size - BLOCK_SIZE / 2));
+
+    // Blocks of another table must not be mixed in
+    huff_codec *other = check_codec_for(data, 4096);
+    FILE *archive = tmpfile();
+    FILE *input = tmpfile();
+    bit_buffer *buffer = bit_buffer_empty();
+    codec_stats stats;
+    fwrite(data, 1, 4096, input);
+    rewind(input);
+    encode_stream(input, archive, flat, buffer, &stats);
+    rewind(input);
+    expect("append with another table", 4096, other != NULL &&
+           append_stream(input, archive, other, &stats) == DECODE_TABLE_MISMATCH ? NULL :
+           "appended with another table");
+
+    bit_buffer_free(buffer);
+    fclose(input);
+    fclose(archive);
+    codec_free(other);
+    free(data);
+}
+
+static int values_freed = 0;
+
+static void count_free(void *value)
+{
+    (void)value;
+    values_freed++;
+}
+
+/*
+ * Inserts into and removes from random positions of a pooled and a plain list alike. Both must hold
+ * the same values, and killing the pooled list must hand every value to the memory handler.
+ */
+static const char *check_list_pool(size_t slab_nodes, int operations)
+{
+    static int values[64];
+    list *pooled = list_empty_pooled(slab_nodes);
+    list *plain = list_empty();
+    size_t length = 0;
+    int removed = 0;
+    const char *failure = NULL;
+
+    values_freed = 0;
+    list_set_memhandler(pooled, count_free);
+    list_reserve(pooled, 16);
+    for (int i = 0; i < operations && failure == NULL; i++) {
+        size_t index = random_below(length + 1);
+        list_position p = list_first(pooled);
+        list_position q = list_first(plain);
+        for (size_t j = 0; j < index; j++) {
+            p = list_next(pooled, p);
+            q = list_next(plain, q);
+        }
+        if (index < length && random_below(2) == 0) {
+            list_remove(pooled, p);
+            list_remove(plain, q);
+            length--;
+            removed++;
+        } else {
+            int *value = &values[random_below(64)];
+            list_insert(pooled, p, value);
+            list_insert(plain, q, value);
+            length++;
+        }
+
+        list_position a = list_first(pooled);
+        list_position b = list_first(plain);
+        while (!list_is_end(pooled, a) && !list_is_end(plain, b)) {
+            if (list_inspect(pooled, a) != list_inspect(plain, b)) {
+                failure = "pooled list holds other values than a plain list";
+            }
+            a = list_next(pooled, a);
+            b = list_next(plain, b);
+        }
+        if (!list_is_end(pooled, a) || !list_is_end(plain, b)) {
+            failure = "pooled list has another length than a plain list";
+        }
+    }
+
+    list_kill(pooled);
+    list_kill(plain);
+    if (failure == NULL && values_freed != removed + (int)length) {
+        failure = "the memory handler was not called once for every value";
+    }
+    return failure;
+}
+
+static void test_list_pool(void)
+{
+    expect("pooled list", 1, check_list_pool(1, 500));
+    expect("pooled list", 7, check_list_pool(7, 2000));
+    expect("pooled list", 64, check_list_pool(64, 2000));
+}
+
+static int compare_ints(void *a, void *b)
+{
+    int x = *(int *)a;
+    int y = *(int *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Empties a queue and checks that the values come out in the order of a stable sort of the n values
+ * by key, which is the order of the sorted list the queue used to be.
+ */
+static const char *check_pqueue_order(pqueue *pq, int *values, size_t n)
+{
+    const char *failure = NULL;
+
+    for (size_t i = 0; i < n && failure == NULL; i++) {
+        size_t expected = SIZE_MAX;
+        for (size_t j = 0; j < n; j++) {
+            if (values[j] >= 0 && (expected == SIZE_MAX || values[j] < values[expected])) {
+                expected = j;
+            }
+        }
+        if (pqueue_is_empty(pq) || pqueue_inspect_first(pq) != &values[expected]) {
+            failure = "priority queue returned another element than a stable sort";
+        } else {
+            pqueue_delete_first(pq);
+            values[expected] = -1;
+        }
+    }
+    if (failure == NULL && !pqueue_is_empty(pq)) {
+        failure = "priority queue holds more elements than were inserted";
+    }
+    pqueue_kill(pq);
+    return failure;
+}
+
+/*
+ * Fills a queue with values with many equal keys in each of the ways a queue can be filled.
+ */
+static void test_pqueue(void)
+{
+    enum { N = 300 };
+    static int values[N];
+    static void *pointers[N];
+
+    for (int way = 0; way < 4; way++) {
+        for (int round = 0; round < 5; round++) {
+            size_t n = random_below(N);
+            for (size_t i = 0; i < n; i++) {
+                values[i] = (int)random_below(20);
+                pointers[i] = &values[i];
+            }
+
+            pqueue *pq;
+            if (way == 0) {
+                pq = pqueue_empty(compare_ints);
+                for (size_t i = 0; i < n; i++) {
+                    pqueue_insert(pq, pointers[i]);
+                }
+            } else if (way == 1) {
+                pq = pqueue_empty(NULL);
+                for (size_t i = 0; i < n; i++) {
+                    pqueue_insert_key(pq, values[i], pointers[i]);
+                }
+            } else if (way == 2) {
+                pq = pqueue_build_from_array(compare_ints, pointers, n);
+            } else {
+                // A few single inserts, then batches both smaller and larger than the queue
+                size_t first = n / 8;
+                size_t second = first + (n - first) / 2;
+                pq = pqueue_empty(compare_ints);
+                for (size_t i = 0; i < first; i++) {
+                    pqueue_insert(pq, pointers[i]);
+                }
+                pqueue_insert_many(pq, pointers + first, second - first);
+                pqueue_insert_many(pq, pointers + second, n - second);
+            }
+            expect("priority queue", n, check_pqueue_order(pq, values, n));
+        }
+    }
+}
+
+/*
+ * Writes chunks of random sizes through a sink with a small buffer, and reads the file back. An
+ * aligned sink must write its buffer whole every time it fills up and nothing more.
+ */
+static const char *check_output_sink(const unsigned char *data, size_t size, size_t capacity, bool aligned)
+{
+    FILE *file = tmpfile();
+    output_sink *sink = sink_create(fileno(file), capacity, aligned);
+    unsigned char *written = malloc(size + 1);
+    const char *failure = NULL;
+
+    for (size_t pos = 0; pos < size && failure == NULL; ) {
+        size_t chunk = random_below(3 * capacity);
+        chunk = chunk < size - pos ? chunk : size - pos;
+        if (sink_write(sink, data + pos, chunk) != 0) {
+            failure = "sink_write failed";
+        }
+        pos += chunk;
+    }
+    size_t syscalls = sink_syscalls(sink);
+    if (failure == NULL && sink_flush(sink) != 0) {
+        failure = "sink_flush failed";
+    }
+
+    rewind(file);
+    if (failure == NULL && (fread(written, 1, size + 1, file) != size || memcmp(written, data, size) != 0)) {
+        failure = "the sink wrote other bytes";
+    }
+    size_t page = (capacity + SINK_ALIGNMENT - 1) / SINK_ALIGNMENT * SINK_ALIGNMENT;
+    if (failure == NULL && aligned && syscalls != size / page) {
+        failure = "an aligned sink wrote something else than whole buffers";
+    }
+
+    sink_free(sink);
+    free(written);
+    fclose(file);
+    return failure;
+}
+
+static void test_output_sink(void)
+{
+    size_t size = 3 * BLOCK_SIZE;
+    unsigned char *data = malloc(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (unsigned char)next_random();
+    }
+
+    for (int i = 0; i < 4; i++) {
+        size_t part = random_below(size);
+        expect("output sink", part, check_output_sink(data, part, 1000, false));
+        expect("aligned output sink", part, check_output_sink(data, part, 5000, true));
+    }
+    free(data);
+}
+
+/*
+ * Trains on a directory of sample files and on the files one by one with a number of workers. The
+ * totals must be the same as the frequency tables of the files summed up.
+ */
+static const char *check_train(char **paths, int num_paths, const char *dir, int num_workers)
+{
+    long long expected[256] = {0};
+    long long from_dir[256] = {0};
+    long long from_files[256] = {0};
+    int dir_files, listed_files;
+
+    for (int i = 0; i < num_paths; i++) {
+        FILE *sample = fopen(paths[i], "rb");
+        int *frequency_table = create_frequency_table(sample);
+        table_file_accumulate(expected, frequency_table);
+        free(frequency_table);
+        fclose(sample);
+    }
+
+    if (train_count(&dir, 1, num_workers, from_dir, &dir_files) != 0
+        || train_count((const char *const *)paths, num_paths, num_workers, from_files, &listed_files) != 0) {
+        return "train_count failed";
+    }
+    if (dir_files != num_paths || listed_files != num_paths) {
+        return "train_count counted the wrong number of files";
+    }
+    if (memcmp(from_dir, expected, sizeof(expected)) != 0 || memcmp(from_files, expected, sizeof(expected)) != 0) {
+        return "train_count totals differ from the summed frequency tables";
+    }
+    return NULL;
+}
+
+static void test_train(void)
+{
+    char dir[] = "/tmp/test_train_XXXXXX";
+    char *paths[12];
+    int num_paths = 0;
+
+    if (mkdtemp(dir) == NULL) {
+        expect("train", 0, "mkdtemp failed");
+        return;
+    }
+    for (int i = 0; i < 12; i++) {
+        // An empty file, a file larger than one read, and skewed files of random sizes
+        size_t size = i == 0 ? 0 : i == 1 ? TRAIN_READ_SIZE + 3 : random_below(20000);
+        paths[i] = malloc(strlen(dir) + 16);
+        sprintf(paths[i], "%s/sample%02d", dir, i);
+        FILE *file = fopen(paths[i], "wb");
+        if (file == NULL) {
+            free(paths[i]);
+            break;
+        }
+        for (size_t j = 0; j < size; j++) {
+            fputc((int)(next_random() % (8 + 31 * i)), file);
+        }
+        fclose(file);
+        num_paths++;
+    }
+
+    for (int workers = 1; workers <= 4; workers += 3) {
+        expect("train", (size_t)num_paths, check_train(paths, num_paths, dir, workers));
+    }
+    long long totals[256] = {0};
+    int num_files;
+    const char *missing = "/nonexistent/sample";
+    expect("train missing sample", 0,
+           train_count(&missing, 1, 2, totals, &num_files) == 0 ? "a missing sample was accepted" : NULL);
+
+    for (int i = 0; i < num_paths; i++) {
+        remove(paths[i]);
+        free(paths[i]);
+    }
+    rmdir(dir);
+}
+
+/*
+ * Joins a directory and a file name into path, an array of PATH_MAX bytes. The test directories are
+ * short, so a path that does not fit ends the test run.
+ */
+static const char *join_path(char *path, const char *dir, const char *name)
+{
+    if (snprintf(path, PATH_MAX, "%s/%s", dir, name) >= PATH_MAX) {
+        fprintf(stderr, "Path too long: %s/%s\n", dir, name);
+        exit(EXIT_FAILURE);
+    }
+    return path;
+}
+
+/*
+ * Runs a batch whose manifest names a/x.txt and b/x.txt, which both map to x.txt.huf, next to
+ * c/y.txt. The two must fail without writing x.txt.huf, and y.txt must still be encoded.
+ */
+static void test_batch_duplicates(const huff_codec *flat)
+{
+    char dir[] = "/tmp/test_batch_XXXXXX";
+    const char *files[] = {"a/x.txt", "b/x.txt", "c/y.txt"};
+    char path[PATH_MAX];
+    char out_dir[PATH_MAX];
+
+    if (mkdtemp(dir) == NULL) {
+        expect("batch duplicates", 0, "mkdtemp failed");
+        return;
+    }
+    const char *subdirs[] = {"a", "b", "c", "out"};
+    for (int i = 0; i < 4; i++) {
+        mkdir(join_path(path, dir, subdirs[i]), 0700);
+    }
+
+    FILE *manifest = fopen(join_path(path, dir, "manifest"), "w");
+    for (int i = 0; i < 3; i++) {
+        char file_path[PATH_MAX];
+        FILE *file = fopen(join_path(file_path, dir, files[i]), "w");
+        fprintf(file, "contents of %s\n", files[i]);
+        fclose(file);
+        fprintf(manifest, "%s\n", file_path);
+    }
+    fclose(manifest);
+
+    join_path(out_dir, dir, "out");
+    int result = batch_run(true, path, out_dir, 3, flat);
+
+    bool wrote_duplicate = access(join_path(path, out_dir, "x.txt.huf"), F_OK) == 0;
+    remove(path);
+    bool wrote_other = access(join_path(path, out_dir, "y.txt.huf"), F_OK) == 0;
+    remove(path);
+
+    expect("batch duplicates", 3, result == 0 ? "a batch with clashing outputs succeeded"
+                                  : wrote_duplicate ? "a clashing output was written"
+                                  : !wrote_other ? "the file without a clash was not encoded" : NULL);
+
+    for (int i = 0; i < 3; i++) {
+        remove(join_path(path, dir, files[i]));
+    }
+    for (int i = 0; i < 4; i++) {
+        rmdir(join_path(path, dir, subdirs[i]));
+    }
+    remove(join_path(path, dir, "manifest"));
+    rmdir(dir);
+}
+
+/*
+ * Encodes a directory holding x.txt and x.txt.huf into itself. Encoding x.txt would overwrite the
+ * input x.txt.huf, so it must fail and leave x.txt.huf as it was, while x.txt.huf is still encoded.
+ */
+static void test_batch_output_is_input(const huff_codec *flat)
+{
+    char dir[] = "/tmp/test_batch_XXXXXX";
+    const char *contents = "not an encoded file\n";
+    char path[PATH_MAX];
+
+    if (mkdtemp(dir) == NULL) {
+        expect("batch output is input", 0, "mkdtemp failed");
+        return;
+    }
+    const char *files[] = {"x.txt", "x.txt.huf"};
+    for (int i = 0; i < 2; i++) {
+        FILE *file = fopen(join_path(path, dir, files[i]), "w");
+        fputs(contents, file);
+        fclose(file);
+    }
+
+    int result = batch_run(true, dir, dir, 2, flat);
+
+    char kept[64] = "";
+    FILE *input = fopen(join_path(path, dir, "x.txt.huf"), "r");
+    if (input != NULL) {
+        if (fgets(kept, sizeof(kept), input) == NULL) {
+            kept[0] = '\0';
+        }
+        fclose(input);
+    }
+    bool encoded_other = access(join_path(path, dir, "x.txt.huf.huf"), F_OK) == 0;
+
+    expect("batch output is input", 2, result == 0 ? "a batch overwriting one of its inputs succeeded"
+                                       : strcmp(kept, contents) != 0 ? "an input was overwritten"
+                                       : !encoded_other ? "the other input was not encoded" : NULL);
+
+    remove(join_path(path, dir, "x.txt.huf.huf"));
+    for (int i = 0; i < 2; i++) {
+        remove(join_path(path, dir, files[i]));
+    }
+    rmdir(dir);
+}
+
+/*
+ * Writes data as a legacy bitstream: the codes of the tree of all 256 bytes, an EOT and zero padding.
+ */
+static size_t write_legacy_stream(char **table, const unsigned char *data, size_t size, unsigned char *stream)
+{
+    size_t bits = 0;
+
+    for (size_t i = 0; i <= size; i++) {
+        const char *code = table[i < size ? data[i] : PARALLEL_EOT];
+        for (; *code != '\0'; code++, bits++) {
+            if (bits % 8 == 0) {
+                stream[bits / 8] = 0;
+            }
+            if (*code == '1') {
+                stream[bits / 8] |= (unsigned char)(0x80 >> (bits % 8));
+            }
+        }
+    }
+    return (bits + 7) / 8;
+}
+
+/*
+ * Decodes a stream sequentially and on several threads; both must give the same status and bytes.
+ */
+static const char *check_parallel_decode(const decode_table *decoder, const unsigned char *stream, size_t size,
+                                         const unsigned char *data, size_t data_size)
+{
+    unsigned char *sequential = NULL;
+    unsigned char *parallel = NULL;
+    size_t sequential_size = 0;
+    size_t parallel_size = 0;
+    const char *failure = NULL;
+
+    decode_status expected = parallel_decode_bitstream(decoder, stream, size, 1, &sequential, &sequential_size);
+    decode_status status = parallel_decode_bitstream(decoder, stream, size, 7, &parallel, &parallel_size);
+    if (status != expected) {
+        failure = "parallel decoding returned another status";
+    } else if (parallel_size != sequential_size ||
+               (parallel_size > 0 && memcmp(parallel, sequential, parallel_size) != 0)) {
+        failure = "parallel decoding produced other bytes";
+    } else if (data != NULL && (status != DECODE_OK || parallel_size != data_size ||
+                                memcmp(parallel, data, data_size) != 0)) {
+        failure = "parallel decoding did not reproduce the input";
+    }
+
+    free(sequential);
+    free(parallel);
+    return failure;
+}
+
+/*
+ * Decodes a legacy stream through decode_stream() with a memory limit, which reads it through a
+ * window of one block instead of all at once. Status and bytes must be those of the sequential decoder.
+ */
+static const char *check_bounded_decode(huff_codec *codec, const decode_table *decoder,
+                                        const unsigned char *stream, size_t size)
+{
+    unsigned char *expected = NULL;
+    size_t expected_size = 0;
+    FILE *input = tmpfile();
+    FILE *output = tmpfile();
+    codec_stats stats;
+    const char *failure = NULL;
+
+    decode_status expected_status = parallel_decode_bitstream(decoder, stream, size, 1, &expected, &expected_size);
+    fwrite(stream, 1, size, input);
+    rewind(input);
+    codec->memory_limit = 1;
+    decode_status status = decode_stream(input, output, codec, &stats);
+    codec->memory_limit = 0;
+
+    unsigned char *decoded = malloc(expected_size + 1);
+    rewind(output);
+    size_t decoded_size = fread(decoded, 1, expected_size + 1, output);
+    if (status != expected_status) {
+        failure = "bounded decoding returned another status";
+    } else if (decoded_size != expected_size || (expected_size > 0 && memcmp(decoded, expected, expected_size) != 0)) {
+        failure = "bounded decoding produced other bytes";
+    }
+
+    free(decoded);
+    free(expected);
+    fclose(output);
+    fclose(input);
+    return failure;
+}
+
+/*
+ * Legacy single-bitstream files are decoded on several threads by speculative decoders that must
+ * synchronise with the true code boundaries, also on corrupted and truncated streams.
+ */
+static void test_parallel_legacy(void)
+{
+    size_t size = 12 * PARALLEL_MIN_SEGMENT;
+    unsigned char *data = malloc(size);
+    unsigned char *stream = malloc(size * 4);
+    int frequency[256];
+
+    for (size_t j = 0; j < size; j++) {
+        // Text-like bytes with no EOT among them
+        unsigned char byte = (unsigned char)(random_below(100) < 80 ? 'a' + random_below(26) : random_below(256));
+        data[j] = byte == PARALLEL_EOT ? ' ' : byte;
+    }
+    for (int i = 0; i < 256; i++) {
+        frequency[i] = 1;
+    }
+    for (size_t j = 0; j < size; j++) {
+        frequency[data[j]]++;
+    }
+    Trie *trie = build_legacy_huff_trie(frequency);
+    char **table = huff_table(trie);
+    decode_table *decoder = decode_table_create(trie);
+    huff_codec *codec = codec_create(frequency);
+
+    size_t stream_size = write_legacy_stream(table, data, size, stream);
+    expect("parallel legacy", stream_size, check_parallel_decode(decoder, stream, stream_size, data, size));
+    expect("bounded legacy", stream_size, check_bounded_decode(codec, decoder, stream, stream_size));
+
+    for (int i = 0; i < 12; i++) {
+        size_t pos = random_below(stream_size);
+        unsigned char saved = stream[pos];
+        stream[pos] ^= (unsigned char)(1 + random_below(255));
+        expect("parallel corrupted", stream_size, check_parallel_decode(decoder, stream, stream_size, NULL, 0));
+        stream[pos] = saved;
+        expect("parallel truncated", pos, check_parallel_decode(decoder, stream, pos, NULL, 0));
+        stream[pos] ^= (unsigned char)(1 + random_below(255));
+        expect("bounded corrupted", stream_size, check_bounded_decode(codec, decoder, stream, stream_size));
+        stream[pos] = saved;
+        expect("bounded truncated", pos, check_bounded_decode(codec, decoder, stream, pos));
+    }
+
+    codec_free(codec);
+    decode_table_free(decoder);
+    free_huff_table(table);
+    trie_kill(trie);
+    free(data);
+    free(stream);
+}
+
+/*
+ * Compares the bulk bit buffer operations with the same bits handled one at a time: views at every
+ * bit offset, appending at every alignment, and copies of buffers whose bits wrap around the array.
+ */
+static const char *check_bit_buffer(const unsigned char *bytes, int offset, int bits)
+{
+    const char *failure = NULL;
+    bit_buffer *view = bit_buffer_view((const char *)bytes, offset, bits);
+    bit_buffer *expected = bit_buffer_empty();
+    bit_buffer *appended = bit_buffer_empty();
+
+    // A prefix of odd length and a removed bit misalign and rotate the target
+    for (int i = 0; i < offset % 13; i++) {
+        bit_buffer_insert_bit(expected, i % 3 == 0);
+        bit_buffer_insert_bit(appended, i % 3 == 0);
+    }
+    bit_buffer_insert_bit(expected, 1);
+    bit_buffer_insert_bit(appended, 1);
+    bit_buffer_remove_bit(expected);
+    bit_buffer_remove_bit(appended);
+    for (int i = 0; i < bits; i++) {
+        bit_buffer_insert_bit(expected, (bytes[(offset + i) / 8] >> (7 - (offset + i) % 8)) & 1);
+    }
+    bit_buffer_append(appended, view);
+    bit_buffer *copy = bit_buffer_copy(appended);
+
+    int expected_size = bit_buffer_size(expected);
+    if (bit_buffer_size(appended) != expected_size || bit_buffer_size(copy) != expected_size) {
+        failure = "appended bit buffer has the wrong size";
+    }
+    for (int i = 0; failure == NULL && i < expected_size; i++) {
+        int bit = bit_buffer_inspect_bit(expected, i);
+        if (bit_buffer_inspect_bit(appended, i) != bit || bit_buffer_inspect_bit(copy, i) != bit) {
+            failure = "appended or copied bits differ from the inserted bits";
+        }
+    }
+
+    char *array = bit_buffer_to_byte_array(expected);
+    char *copied = bit_buffer_to_byte_array(copy);
+    if (failure == NULL && memcmp(array, copied, (expected_size + 7) / 8) != 0) {
+        failure = "bit_buffer_to_byte_array() differs between equal buffers";
+    }
+    if (failure == NULL && bits > 0 && bit_buffer_remove_bit(view) != bit_buffer_inspect_bit(expected, offset % 13)) {
+        failure = "removing from a view gives the wrong bit";
+    }
+
+    free(array);
+    free(copied);
+    bit_buffer_free(view);
+    bit_buffer_free(expected);
+    bit_buffer_free(appended);
+    bit_buffer_free(copy);
+    return failure;
+}
+
+static void test_bit_buffer(void)
+{
+    unsigned char bytes[64];
+
+    for (int i = 0; i < MUTATIONS; i++) {
+        for (size_t j = 0; j < sizeof(bytes); j++) {
+            bytes[j] = (unsigned char)next_random();
+        }
+        int offset = (int)random_below(64);
+        int bits = (int)random_below(sizeof(bytes) * 8 - offset + 1);
+        expect("bit buffer", bits, check_bit_buffer(bytes, offset, bits));
+    }
+}
+
+/*
+ * Feeds random payloads to both decoders, so that invalid codes and overruns are compared as well.
+ */
+static void test_random_payloads(const huff_codec *flat)
+{
+    unsigned char payload[512];
+    unsigned char skewed_data[1024];
+    unsigned char decoded[4 * sizeof(payload)];
+
+    for (size_t j = 0; j < sizeof(skewed_data); j++) {
+        skewed_data[j] = j % 7 == 0 ? (unsigned char)j : 'x';
+    }
+    huff_codec *skewed = check_codec_for(skewed_data, sizeof(skewed_data));
+
+    for (int i = 0; i < MUTATIONS; i++) {
+        size_t size = random_below(sizeof(payload));
+        for (size_t j = 0; j < size; j++) {
+            payload[j] = (unsigned char)next_random();
+        }
+        size_t raw_size = random_below(4 * sizeof(payload));
+        expect("random payload", size, check_decoders_agree(flat, payload, size, raw_size));
+        expect("random payload", size, check_decoders_agree(skewed, payload, size, raw_size));
+        // tANS reads must stay inside the payload whatever it holds
+        tans_decode(skewed->tans, payload, size, decoded, raw_size);
+    }
+    codec_free(skewed);
+}
+
+/* ------------------------------------ Main ------------------------------------------------------------ */
+
+int main(int argc, char **argv)
+{
+    rng_state = argc > 1 ? strtoull(argv[1], NULL, 0) : 20261018;
+    if (rng_state == 0) {
+        rng_state = 1;
+    }
+
+    int flat_table[256];
+    for (int i = 0; i < 256; i++) {
+        flat_table[i] = 1;
+    }
+    huff_codec *flat = codec_create(flat_table);
+    if (flat == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    test_empty(flat);
+    test_single_symbol(flat);
+    test_all_symbols(flat);
+    test_skewed(flat);
+    test_tans();
+    test_random(flat);
+    test_runs(flat);
+    test_memory_limit(flat);
+    test_missing_symbols();
+    test_unknown_byte_size();
+    test_estimate_unsampled();
+    test_checksum();
+    test_corrupted(flat);
+    test_truncated();
+    test_random_payloads(flat);
+    test_bit_buffer();
+    test_parallel_legacy();
+    test_append(flat);
+    test_list_pool();
+    test_pqueue();
+    test_output_sink();
+    test_train();
+    test_batch_duplicates(flat);
+    test_batch_output_is_input(flat);
+
+    codec_free(flat);
+    printf("%d checks run, %d failed.\n", tests_run, tests_failed);
+    return tests_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
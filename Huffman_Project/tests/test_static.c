@@ -0,0 +1,199 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         test_static.c
+ * Description:  Checks the codec compiled against the tables of "huffman -emit-c" against the codec
+ *               built at runtime from the same frequency file. Payloads of random blocks must be
+ *               byte-identical to the runtime Huffman codes, and random payloads must decode with the
+ *               same status, output and consumed bits as decode_table_run().
+ *
+ *               Usage: test_static FILE0 [SEED], where FILE0 is the file the tables were emitted from.
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "codec_check.h"
+#include "../static_codec.h"
+
+#define CASES 200               // The number of random blocks and payloads
+#define MAX_BLOCK 4096          // The largest random block
+
+static int tests_run = 0;
+static int tests_failed = 0;
+static uint64_t rng_state;
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+/*
+ * xorshift64*, the same PRNG as in test_roundtrip.c.
+ */
+static uint64_t next_random(void)
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ull;
+}
+
+static size_t random_below(size_t limit)
+{
+    return (size_t)(next_random() % limit);
+}
+
+static void expect(const char *name, size_t size, const char *failure)
+{
+    tests_run++;
+    if (failure != NULL) {
+        tests_failed++;
+        printf("FAIL %s (%zu bytes): %s\n", name, size, failure);
+    }
+}
+
+/*
+ * Writes the Huffman payload of a block from the code strings of the runtime codec.
+ */
+static size_t reference_payload(const huff_codec *codec, const unsigned char *block, size_t size,
+                                unsigned char *payload)
+{
+    size_t bits = 0;
+
+    for (size_t i = 0; i < size; i++) {
+        for (const char *bit = codec->table[block[i]]; *bit != '\0'; bit++, bits++) {
+            if (bits % 8 == 0) {
+                payload[bits / 8] = 0;
+            }
+            if (*bit == '1') {
+                payload[bits / 8] |= (unsigned char)(0x80 >> (bits % 8));
+            }
+        }
+    }
+    return (bits + 7) / 8;
+}
+
+static const char *check_encode(const huff_codec *codec, const unsigned char *block, size_t size)
+{
+    static unsigned char expected[MAX_BLOCK * 8];
+    static unsigned char payload[MAX_BLOCK * 8];
+    size_t count[256] = {0};
+
+    for (size_t i = 0; i < size; i++) {
+        count[block[i]]++;
+    }
+    size_t expected_size = reference_payload(codec, block, size, expected);
+    if (static_codec_payload_size(count) != expected_size) {
+        return "static_codec_payload_size() differs from the runtime codes";
+    }
+    if (static_codec_encode(block, size, payload) != expected_size) {
+        return "static payload has another size than the runtime payload";
+    }
+    return memcmp(payload, expected, expected_size) == 0 ? NULL : "static payload differs from the runtime payload";
+}
+
+static const char *check_decode(const huff_codec *codec, const unsigned char *payload, size_t size, size_t raw_size)
+{
+    static unsigned char expected[4 * MAX_BLOCK];
+    static unsigned char out[4 * MAX_BLOCK];
+    bit_reader reader;
+    size_t consumed;
+
+    bit_reader_init(&reader, payload, size);
+    decode_status expected_status = decode_table_run(codec->decoder, &reader, expected, raw_size);
+    decode_status status = static_codec_decode(payload, size, out, raw_size, &consumed);
+
+    if (status != expected_status) {
+        return "static decoder returned another status";
+    }
+    if (consumed != reader.consumed) {
+        return "static decoder consumed another number of bits";
+    }
+    if (status == DECODE_OK && memcmp(out, expected, raw_size) != 0) {
+        return "static decoder produced other bytes";
+    }
+    return NULL;
+}
+
+/* ------------------------------------ Main ------------------------------------------------------------ */
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "Usage: test_static FILE0 [SEED]\n");
+        return EXIT_FAILURE;
+    }
+    rng_state = argc > 2 ? strtoull(argv[2], NULL, 0) : 20261018;
+    if (rng_state == 0) {
+        rng_state = 1;
+    }
+
+    // The whole file is counted, as "huffman -emit-c" did
+    FILE *file = fopen(argv[1], "rb");
+    unsigned char *data = NULL;
+    size_t size = 0;
+    if (file != NULL && fseek(file, 0, SEEK_END) == 0 && ftell(file) >= 0) {
+        size = (size_t)ftell(file);
+        data = malloc(size + 1);
+        rewind(file);
+    }
+    if (data == NULL || fread(data, 1, size, file) != size) {
+        fprintf(stderr, "Failed to read %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    fclose(file);
+
+    huff_codec *codec = check_codec_for(data, size);
+    if (codec == NULL) {
+        return EXIT_FAILURE;
+    }
+    expect("table id", 0, static_codec_table_id() == codec->table_id ? NULL :
+           "the tables were emitted from another frequency file");
+
+    // Random blocks of the bytes that have codes
+    unsigned char codable[256];
+    int num_codable = 0;
+    for (int i = 0; i < 256; i++) {
+        if (codec->code_length[i] > 0) {
+            codable[num_codable++] = (unsigned char)i;
+        }
+    }
+    unsigned char block[MAX_BLOCK];
+    for (int i = 0; i < CASES && num_codable > 0; i++) {
+        size_t block_size = random_below(MAX_BLOCK);
+        for (size_t j = 0; j < block_size; j++) {
+            block[j] = codable[random_below(num_codable)];
+        }
+        expect("encode", block_size, check_encode(codec, block, block_size));
+        expect("decode", block_size, check_decode(codec, block, block_size, random_below(4 * MAX_BLOCK)));
+    }
+    size_t head = size < MAX_BLOCK ? size : MAX_BLOCK;
+    expect("encode file", head, check_encode(codec, data, head));
+
+    // A byte without a code can not be encoded
+    for (int i = 0; i < 256; i++) {
+        if (codec->code_length[i] == 0) {
+            unsigned char byte = (unsigned char)i;
+            expect("no code", 1, static_codec_encode(&byte, 1, block) == SIZE_MAX ? NULL :
+                   "a byte without a code was encoded");
+            break;
+        }
+    }
+
+    // Random payloads, including invalid codes and overruns
+    for (int i = 0; i < CASES; i++) {
+        size_t payload_size = random_below(MAX_BLOCK);
+        for (size_t j = 0; j < payload_size; j++) {
+            block[j] = (unsigned char)next_random();
+        }
+        expect("random payload", payload_size, check_decode(codec, block, payload_size, random_below(4 * MAX_BLOCK)));
+    }
+
+    codec_free(codec);
+    free(data);
+    printf("%d checks run, %d failed.\n", tests_run, tests_failed);
+    return tests_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,216 @@
+/*
+ * Programming in C
+ * Spring 2024
+ *
+ * File:         train.c
+ * Description:  Counts the bytes of a corpus of sample files on a pool of worker threads, each with its
+ *               own 64-bit counters, and adds the counters up when all files are counted.
+ *
+ * Author:       Abdiaziz Ibrahim Adam
+ * CS username:  dv23aam
+ * Date:         18 October 2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "train.h"
+#include "batch.h"
+
+#define EOT 4  // Counted once per file, as create_frequency_table() does
+
+/*
+ * State shared by all workers. next_file is protected by file_mut; every worker writes only its own
+ * counts until it is done.
+ */
+typedef struct train_pool {
+    char **paths;
+    int num_paths;
+    int next_file;
+    bool failed;
+    pthread_mutex_t file_mut;
+} train_pool;
+
+/*
+ * One worker and its counters.
+ */
+typedef struct train_worker {
+    train_pool *pool;
+    pthread_t thread;
+    uint64_t counts[256];
+} train_worker;
+
+/* ------------------------------------ Internal functions ---------------------------------------------- */
+
+/*
+ * Counts the bytes of one file. Four sub-counters let consecutive equal bytes be counted without
+ * waiting for each other's increments.
+ */
+static int count_file(const char *path, unsigned char *buffer, uint64_t *counts)
+{
+    uint64_t sub[4][256] = {{0}};
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    size_t n;
+    while ((n = fread(buffer, 1, TRAIN_READ_SIZE, file)) > 0) {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            sub[0][buffer[i]]++;
+            sub[1][buffer[i + 1]]++;
+            sub[2][buffer[i + 2]]++;
+            sub[3][buffer[i + 3]]++;
+        }
+        for (; i < n; i++) {
+            sub[0][buffer[i]]++;
+        }
+    }
+    int result = ferror(file) ? -1 : 0;
+    if (result != 0) {
+        fprintf(stderr, "Failed to read %s\n", path);
+    }
+    fclose(file);
+
+    for (int c = 0; c < 256; c++) {
+        counts[c] += sub[0][c] + sub[1][c] + sub[2][c] + sub[3][c];
+    }
+    counts[EOT]++;
+    return result;
+}
+
+/*
+ * Worker thread: counts files until there are none left.
+ */
+static void *train_worker_main(void *arg)
+{
+    train_worker *worker = arg;
+    train_pool *pool = worker->pool;
+    unsigned char *buffer = malloc(TRAIN_READ_SIZE);
+
+    if (buffer == NULL) {
+        pthread_mutex_lock(&pool->file_mut);
+        pool->failed = true;
+        pthread_mutex_unlock(&pool->file_mut);
+        return NULL;
+    }
+
+    while (true) {
+        pthread_mutex_lock(&pool->file_mut);
+        int index = pool->next_file++;
+        pthread_mutex_unlock(&pool->file_mut);
+
+        if (index >= pool->num_paths) {
+            break;
+        }
+        if (count_file(pool->paths[index], buffer, worker->counts) != 0) {
+            pthread_mutex_lock(&pool->file_mut);
+            pool->failed = true;
+            pthread_mutex_unlock(&pool->file_mut);
+        }
+    }
+
+    free(buffer);
+    return NULL;
+}
+
+/*
+ * Collects the sample files: a directory contributes its regular files, anything else is a file.
+ */
+static int collect_samples(const char *const *sources, int num_sources, char ***paths, int *count)
+{
+    int capacity = 0;
+
+    for (int i = 0; i < num_sources; i++) {
+        struct stat s;
+        if (stat(sources[i], &s) != 0) {
+            perror(sources[i]);
+            return -1;
+        }
+        if (S_ISDIR(s.st_mode)) {
+            if (batch_list_directory(sources[i], paths, count, &capacity) != 0) {
+                return -1;
+            }
+            continue;
+        }
+
+        if (*count == capacity) {
+            capacity = capacity == 0 ? 64 : capacity * 2;
+            char **grown = realloc(*paths, capacity * sizeof(char *));
+            if (grown == NULL) {
+                return -1;
+            }
+            *paths = grown;
+        }
+        (*paths)[*count] = strdup(sources[i]);
+        if ((*paths)[*count] == NULL) {
+            return -1;
+        }
+        (*count)++;
+    }
+    return 0;
+}
+
+/* ------------------------------------ External functions ---------------------------------------------- */
+
+int train_count(const char *const *sources, int num_sources, int num_workers, long long *totals, int *num_files)
+{
+    train_pool pool = {NULL, 0, 0, false, PTHREAD_MUTEX_INITIALIZER};
+
+    *num_files = 0;
+    if (collect_samples(sources, num_sources, &pool.paths, &pool.num_paths) != 0) {
+        pool.failed = true;
+    }
+
+    if (num_workers > pool.num_paths) {
+        num_workers = pool.num_paths;
+    }
+    if (num_workers < 1) {
+        num_workers = 1;
+    }
+    train_worker *workers = pool.failed ? NULL : calloc(num_workers, sizeof(train_worker));
+    if (workers != NULL) {
+        int started = 0;
+        for (; started < num_workers; started++) {
+            workers[started].pool = &pool;
+            if (pthread_create(&workers[started].thread, NULL, train_worker_main, &workers[started]) != 0) {
+                break;
+            }
+        }
+        if (started == 0) {
+            // No threads could be started, count in this thread instead
+            train_worker_main(&workers[0]);
+            started = 1;
+        } else {
+            for (int i = 0; i < started; i++) {
+                pthread_join(workers[i].thread, NULL);
+            }
+        }
+
+        for (int i = 0; i < started; i++) {
+            for (int c = 0; c < 256; c++) {
+                totals[c] += (long long)workers[i].counts[c];
+            }
+        }
+        free(workers);
+    } else {
+        pool.failed = true;
+    }
+
+    for (int i = 0; i < pool.num_paths; i++) {
+        free(pool.paths[i]);
+    }
+    free(pool.paths);
+    pthread_mutex_destroy(&pool.file_mut);
+    *num_files = pool.num_paths;
+    return pool.failed ? -1 : 0;
+}
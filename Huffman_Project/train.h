@@ -0,0 +1,40 @@
+/**
+ * @defgroup Train
+ * @brief Counts the byte frequencies of many sample files on several threads.
+ *
+ * A table file is trained on a corpus of representative files, given as files or as directories
+ * whose regular files are all used. The files are handed out one at a time to a pool of worker
+ * threads. Every worker counts into its own 64-bit counters, so the workers never share a cache
+ * line while counting, and the counters are only added up once all files are done. Files larger
+ * than 4 GiB and corpora of any size can not overflow the counts.
+ *
+ * Every file counts one EOT as well, like create_frequency_table(), so the trained table is the same
+ * as one aggregated from the frequency tables of the files one by one.
+ *
+ * @section Author
+ *  - Author: Abdiaziz Ibrahim Adam
+ * @since Datum
+ *  - 18 October 2026
+ * @{
+ */
+
+#ifndef TRAIN_H
+#define TRAIN_H
+
+#define TRAIN_READ_SIZE (256 * 1024)  ///< The bytes a worker reads at a time.
+
+/**
+ * @brief Adds up the byte counts of all sample files.
+ *
+ * @param sources Paths to sample files or directories of sample files.
+ * @param num_sources The number of paths.
+ * @param num_workers The number of worker threads. Fewer are started if there are fewer files.
+ * @param totals Array of 256 totals the counts of all files are added to, as by table_file_accumulate().
+ * @param num_files Pointer to where the number of sample files is stored.
+ * @return 0 on success, -1 if a source could not be read or memory allocation failed.
+ */
+int train_count(const char *const *sources, int num_sources, int num_workers, long long *totals, int *num_files);
+
+#endif /* TRAIN_H */
+
+/** @} */
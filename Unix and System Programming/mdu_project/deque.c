@@ -0,0 +1,144 @@
+/*
+ * Module       : deque.c
+ * Description  : This module implements a Chase–Lev work-stealing deque. The owning thread pushes and
+ *                pops at the bottom, other threads steal from the top, and only the race for the last
+ *                element needs a compare-and-swap.
+ *
+ * Dependencies : Requires `deque.h` for the deque data structure and function prototypes.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "deque.h"
+
+/* ------------------------------- Helper Functions ------------------------------------------------------------------------------------------------ */
+
+static Deque_Array *create_array(long capacity) {
+    Deque_Array *array = malloc(sizeof(Deque_Array) + capacity * sizeof(_Atomic(void *)));
+    if (array == NULL) {
+        perror("Failed to allocate memory for deque array");
+        return NULL;
+    }
+    array->capacity = capacity;
+    array->retired = NULL;
+    return array;
+}
+
+// Copies the elements from top to bottom into an array twice the size. Only the owner grows the array.
+static Deque_Array *grow_array(Deque *deque, Deque_Array *old, long top, long bottom) {
+    Deque_Array *array = create_array(old->capacity * 2);
+    if (array == NULL) {
+        return NULL;
+    }
+    for (long i = top; i < bottom; i++) {
+        void *data = atomic_load_explicit(&old->slots[i & (old->capacity - 1)], memory_order_relaxed);
+        atomic_store_explicit(&array->slots[i & (array->capacity - 1)], data, memory_order_relaxed);
+    }
+    array->retired = old;
+    atomic_store_explicit(&deque->array, array, memory_order_release);
+    return array;
+}
+
+/* ------------------------------- Function Implementations ------------------------------------------------------------------------------------------------ */
+
+Deque *create_deque(void) {
+    Deque *deque = malloc(sizeof(Deque));
+    if (deque == NULL) {
+        perror("Failed to create deque");
+        return NULL;
+    }
+    Deque_Array *array = create_array(DEQUE_INITIAL_CAPACITY);
+    if (array == NULL) {
+        free(deque);
+        return NULL;
+    }
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+    atomic_init(&deque->array, array);
+    return deque;
+}
+
+bool push_bottom(Deque *deque, void *data) {
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    Deque_Array *array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+
+    if (bottom - top > array->capacity - 1) {
+        array = grow_array(deque, array, top, bottom);
+        if (array == NULL) {
+            return false;
+        }
+    }
+    atomic_store_explicit(&array->slots[bottom & (array->capacity - 1)], data, memory_order_relaxed);
+
+    // The element must be visible before thieves can see the new bottom
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+    return true;
+}
+
+void *pop_bottom(Deque *deque) {
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    Deque_Array *array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+
+    // Claim the bottom slot before looking at top, so a thief and the owner cannot both take it
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        // Empty
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    void *data = atomic_load_explicit(&array->slots[bottom & (array->capacity - 1)], memory_order_relaxed);
+    if (top == bottom) {
+        // Last element, race the thieves for it
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                     memory_order_seq_cst, memory_order_relaxed)) {
+            data = NULL;
+        }
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return data;
+}
+
+void *steal_top(Deque *deque) {
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+    if (top >= bottom) {
+        return NULL;
+    }
+
+    Deque_Array *array = atomic_load_explicit(&deque->array, memory_order_acquire);
+    void *data = atomic_load_explicit(&array->slots[top & (array->capacity - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        // Lost the race to the owner or another thief
+        return NULL;
+    }
+    return data;
+}
+
+bool deque_has_work(Deque *deque) {
+    long top = atomic_load(&deque->top);
+    long bottom = atomic_load(&deque->bottom);
+    return top < bottom;
+}
+
+void free_deque(Deque *deque) {
+    if (deque == NULL) {
+        return;
+    }
+    Deque_Array *array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+    while (array != NULL) {
+        Deque_Array *retired = array->retired;
+        free(array);
+        array = retired;
+    }
+    free(deque);
+}
+
+/* --------------------------------------------------------------------------------------------------------------------------------------------------------------------------- */
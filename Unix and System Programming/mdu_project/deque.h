@@ -0,0 +1,122 @@
+/**
+ * @file deque.h
+ * @brief Chase–Lev work-stealing deque for generic pointers.
+ *
+ * Each worker thread owns one deque. The owner pushes and pops at the bottom without taking any
+ * lock, so a worker that keeps finding subdirectories works through them depth first on its own.
+ * Idle threads steal from the top of other threads' deques, which hands them the oldest, and usually
+ * largest, pending subtrees. Only the last element is contended, and it is settled with a single
+ * compare-and-swap on `top`.
+ *
+ * The elements live in a circular array that the owner doubles when it is full. Thieves may still be
+ * reading from the old array, so replaced arrays are kept until the deque is freed.
+ *
+ * The implementation follows the C11 version of the algorithm by Lê, Pop, Cohen and Zappa Nardelli,
+ * "Correct and Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+ *
+ * @section Author
+ * - Author: Abdiaziz Ibrahim Adam
+ * - Date: 2024-11-18
+ *
+ * @warning `push_bottom` and `pop_bottom` may only be called by the thread owning the deque.
+ *          `steal_top` may be called by any thread.
+ */
+
+#ifndef DEQUE_H
+#define DEQUE_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#define DEQUE_INITIAL_CAPACITY 64   /**< Number of slots of a new deque, always a power of two. */
+
+/* ------------------------------- Structures ------------------------------------------------------------------------------------------------ */
+
+/**
+ * @struct Deque_Array
+ * @brief Circular array holding the elements of a deque.
+ *
+ * @param capacity Number of slots, a power of two.
+ * @param retired The array this one replaced, kept until the deque is freed.
+ * @param slots The elements, indexed by position modulo capacity.
+ */
+typedef struct Deque_Array {
+    long capacity;                    /**< Number of slots, a power of two. */
+    struct Deque_Array *retired;      /**< Previous, smaller array still readable by thieves. */
+    _Atomic(void *) slots[];          /**< The elements. */
+} Deque_Array;
+
+/**
+ * @struct Deque
+ * @brief A work-stealing deque.
+ *
+ * Positions only grow. The deque holds the elements at positions `top` up to but not including
+ * `bottom`.
+ *
+ * @param top Position of the oldest element, advanced by thieves and by the owner's last pop.
+ * @param bottom Position after the newest element, only written by the owner.
+ * @param array The current array.
+ */
+typedef struct Deque {
+    atomic_long top;                  /**< Position of the oldest element. */
+    atomic_long bottom;               /**< Position after the newest element. */
+    _Atomic(Deque_Array *) array;     /**< The current array. */
+} Deque;
+
+/* ------------------------------- Function Prototypes ------------------------------------------------------------------------------------------------------- */
+
+/**
+ * @brief Creates a new empty deque.
+ *
+ * @return Deque* Pointer to the new deque, or NULL on failure.
+ *
+ * @warning The caller is responsible for deallocating the deque by calling `free_deque`.
+ */
+Deque *create_deque(void);
+
+/**
+ * @brief Pushes an element onto the bottom of the deque. Owner only.
+ *
+ * Doubles the array if it is full.
+ *
+ * @param deque Pointer to the deque.
+ * @param data The element, must not be NULL.
+ * @return bool True on success, false if the array could not be grown.
+ */
+bool push_bottom(Deque *deque, void *data);
+
+/**
+ * @brief Pops the newest element from the bottom of the deque. Owner only.
+ *
+ * @param deque Pointer to the deque.
+ * @return void* The element, or NULL if the deque is empty or a thief took the last element.
+ */
+void *pop_bottom(Deque *deque);
+
+/**
+ * @brief Steals the oldest element from the top of the deque.
+ *
+ * @param deque Pointer to the deque.
+ * @return void* The element, or NULL if the deque is empty or another thread got it first.
+ */
+void *steal_top(Deque *deque);
+
+/**
+ * @brief Checks whether the deque looks non-empty.
+ *
+ * The answer can be outdated as soon as it is returned. It is only meant for deciding whether to
+ * try stealing again or to go to sleep.
+ *
+ * @param deque Pointer to the deque.
+ * @return bool True if the deque held elements when it was checked.
+ */
+bool deque_has_work(Deque *deque);
+
+/**
+ * @brief Frees the deque and all its arrays. The elements are not freed.
+ *
+ * @param deque Pointer to the deque. No other thread may use it any more.
+ */
+void free_deque(Deque *deque);
+
+#endif // DEQUE_H
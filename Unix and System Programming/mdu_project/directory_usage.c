@@ -1,102 +1,206 @@
 #include "directory_usage.h"
 
+// Buffer for the entries read by getdents64, one per worker thread
+static _Thread_local char *dirent_buffer = NULL;
+
+// Ring for batched statx calls, one per worker thread, set up once stats turn out to be slow
+static _Thread_local Stat_Ring *stat_ring = NULL;
+static _Thread_local bool stat_ring_tried = false;
+
+// Time and number of the entries stat'ed synchronously lately, and the batches since the last of them
+static _Thread_local long stat_time_ns = 0;
+static _Thread_local long stat_entries = 0;
+static _Thread_local int ring_batches = 0;
+
+/* ------------------------------- Helper Functions ------------------------------------------------------------------------------------------------ */
+
+// Prints the error for an entry that could not be stat'ed, the full path is only built for the message
+static void report_entry_error(Path *current_path_task, const char *name, int error) {
+    char *full_path = concatenate_dir_path(current_path_task->path_name, name);
+    fprintf(stderr, "du: cannot open directory '%s': %s\n", full_path ? full_path : name, strerror(error));
+    free(full_path);
+}
+
+// Adds a subdirectory as a new task, `counted` tells whether its own blocks are already added
+static int queue_subdirectory(Dir_Handle *directory, const char *name, bool counted, Path *current_path_task,
+                              ThreadPool *thread_pool) {
+    Path *new_subdir_task = create_subdir_path(current_path_task, directory, name, counted);
+    if (!new_subdir_task) {
+        return EXIT_FAILURE;  // Return failure if path creation fails
+    }
+
+    if (submit_task(thread_pool, new_subdir_task) != 0) {
+        cleanup_path(new_subdir_task);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// Stats a batch with one blocking call per entry, and adds the time it took to the latency measurement
+static void stat_batch_timed(int dirfd, const char *const *names, int count, Stat_Result *results) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    stat_batch_sync(dirfd, names, count, results);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    stat_time_ns += (end.tv_sec - start.tv_sec) * 1000000000L + (end.tv_nsec - start.tv_nsec);
+    stat_entries += count;
+
+    // Halving both keeps the average weighted towards the latest entries
+    if (stat_entries > STAT_LATENCY_WINDOW) {
+        stat_time_ns /= 2;
+        stat_entries /= 2;
+    }
+}
+
+// Whether the stats measured so far are slow enough for the ring, a few entries are not enough to tell
+static bool stats_are_slow(void) {
+    return stat_entries >= STAT_RING_ENTRIES && stat_time_ns / stat_entries >= STAT_RING_MIN_LATENCY_NS;
+}
+
 /* ------------------------------- Function Implementations ------------------------------------------------------------------------------------------------ */
 
 int calculate_directory_usage(ThreadPool *thread_pool, Path *current_path_task) {
     int exit_code = EXIT_SUCCESS;
     char *base_path = current_path_task->path_name;
+    const char *name = base_path + current_path_task->name_offset;
+    int parent_fd = current_path_task->parent != NULL ? current_path_task->parent->fd : AT_FDCWD;
+    bool counted = current_path_task->counted;
+    long directory_size = 0;
     struct stat s;
 
-    // Get base path stats
-    if (lstat(base_path, &s) < 0) {
-        perror(base_path);
-        return EXIT_FAILURE; 
+    // The user's paths are stat'ed here, they may be files
+    if (current_path_task->parent == NULL) {
+        if (lstat(base_path, &s) < 0) {
+            perror(base_path);
+            return EXIT_FAILURE;
+        }
+        directory_size = s.st_blocks;
+        counted = true;
+
+        if (!S_ISDIR(s.st_mode)) {
+            update_directory_size(thread_pool, current_path_task, directory_size);
+            return EXIT_SUCCESS;
+        }
     }
 
-    long directory_size = s.st_blocks;
+    // Open the directory relative to its parent, so the kernel only resolves the last component
+    int fd = openat(parent_fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    int open_error = errno;
 
-    // If it’s a directory, traverse it
-    if (S_ISDIR(s.st_mode)) {
-        int traversal_result = traverse_directory(base_path, current_path_task->path_id, thread_pool, &directory_size);
-        if (traversal_result != 0) {
-            exit_code = EXIT_FAILURE; 
+    // A subdirectory the parent only knew by its d_type counts its own blocks
+    if (!counted) {
+        int stat_result = fd >= 0 ? fstat(fd, &s) : fstatat(parent_fd, name, &s, AT_SYMLINK_NOFOLLOW);
+        if (stat_result == 0) {
+            directory_size += s.st_blocks;
         }
     }
 
+    Dir_Handle *directory = fd >= 0 ? open_dir_handle(fd) : NULL;
+    if (directory == NULL) {
+        fprintf(stderr, "du: cannot read directory '%s': %s\n", base_path, strerror(fd >= 0 ? errno : open_error));
+        exit_code = EXIT_FAILURE;
+    } else {
+        if (traverse_directory(directory, current_path_task, thread_pool, &directory_size) != 0) {
+            exit_code = EXIT_FAILURE;
+        }
+        release_dir_handle(directory);
+    }
+
     // Update the shared directory size
     update_directory_size(thread_pool, current_path_task, directory_size);
 
     return exit_code; // Return status indicating success or failure
 }
 
-int traverse_directory(const char *base_path, int path_id, ThreadPool *thread_pool, long *directory_size) {
-    DIR *directory = opendir(base_path);
-    if (!directory) {
-        fprintf(stderr, "du: cannot read directory '%s': %s\n", base_path, strerror(errno));
-        return EXIT_FAILURE; 
-    }
-
-    struct dirent *directory_entry;
-    while ((directory_entry = readdir(directory)) != NULL) {
-        if (strcmp(directory_entry->d_name, ".") == 0 || strcmp(directory_entry->d_name, "..") == 0) {
-            continue;
+int traverse_directory(Dir_Handle *directory, Path *current_path_task, ThreadPool *thread_pool, long *directory_size) {
+    // Each worker reuses one large buffer, so a directory of any size takes few system calls
+    if (dirent_buffer == NULL) {
+        dirent_buffer = malloc(DIRENT_BUFFER_SIZE);
+        if (dirent_buffer == NULL) {
+            perror("Failed to allocate memory for directory entries");
+            return EXIT_FAILURE;
         }
-
-        char *full_path = concatenate_dir_path(base_path, directory_entry->d_name); 
-        if (!full_path) {
-            closedir(directory); 
-            return EXIT_FAILURE; 
+    }
+    // Names of the entries waiting to be stat'ed, they point into the buffer until the next read
+    const char *names[STAT_RING_ENTRIES];
+    int count = 0;
+
+    long bytes;
+    while ((bytes = syscall(SYS_getdents64, directory->fd, dirent_buffer, DIRENT_BUFFER_SIZE)) > 0) {
+        for (long offset = 0; offset < bytes; ) {
+            Dirent64 *directory_entry = (Dirent64 *)(dirent_buffer + offset);
+            offset += directory_entry->d_reclen;
+
+            if (strcmp(directory_entry->d_name, ".") == 0 || strcmp(directory_entry->d_name, "..") == 0) {
+                continue;
+            }
+
+            // A subdirectory is opened by its own task anyway, which can stat the descriptor instead
+            if (directory_entry->d_type == DT_DIR) {
+                if (queue_subdirectory(directory, directory_entry->d_name, false, current_path_task, thread_pool) != 0) {
+                    return EXIT_FAILURE;
+                }
+                continue;
+            }
+
+            names[count++] = directory_entry->d_name;
+            if (count == STAT_RING_ENTRIES) {
+                if (process_path_entries(directory, names, count, current_path_task, thread_pool, directory_size) != 0) {
+                    return EXIT_FAILURE;
+                }
+                count = 0;
+            }
         }
 
-        // Process each path entry
-        if (process_path_entry(full_path, path_id, thread_pool, directory_size) != 0) {
-            free(full_path); 
-            closedir(directory); 
-            return EXIT_FAILURE; 
+        // The next read overwrites the names
+        if (count > 0) {
+            if (process_path_entries(directory, names, count, current_path_task, thread_pool, directory_size) != 0) {
+                return EXIT_FAILURE;
+            }
+            count = 0;
         }
-
-        free(full_path); 
     }
 
-    closedir(directory); 
-    return EXIT_SUCCESS; 
+    if (bytes < 0) {
+        fprintf(stderr, "du: cannot read directory '%s': %s\n", current_path_task->path_name, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
 }
 
-int process_path_entry(char *full_path, int path_id, ThreadPool *thread_pool, long *directory_size) {
-    struct stat s;
-    if (lstat(full_path, &s) < 0) {
-        fprintf(stderr, "du: cannot open directory '%s': %s\n", full_path, strerror(errno));  // Print error if lstat fails
-        return EXIT_FAILURE;
+int process_path_entries(Dir_Handle *directory, const char *const *names, int count, Path *current_path_task,
+                         ThreadPool *thread_pool, long *directory_size) {
+    Stat_Result results[STAT_RING_ENTRIES];
+
+    bool slow = stats_are_slow();
+
+    // The ring only pays off when the file system is slow, so it is set up once the stats are
+    if (!stat_ring_tried && slow) {
+        stat_ring = create_stat_ring();
+        stat_ring_tried = true;
     }
 
-    // Add size if it’s a file
-    if (!S_ISDIR(s.st_mode)) {
-        *directory_size += s.st_blocks;
-    } else {
-        // Add subdirectory as a new task
-        Path *new_subdir_task = create_path(full_path, path_id);
-        if (!new_subdir_task) {
-            return EXIT_FAILURE;  // Return failure if path creation fails
-        }
+    // On the ring, every STAT_RING_PROBE_INTERVAL-th batch is still timed synchronously, in case the caches warmed up
+    bool use_ring = stat_ring != NULL && slow && ++ring_batches % STAT_RING_PROBE_INTERVAL != 0;
+    if (!use_ring) {
+        stat_batch_timed(directory->fd, names, count, results);
+    } else if (stat_batch(stat_ring, directory->fd, names, count, results) != 0) {
+        // The results are complete, but the next batches go without the ring
+        free_stat_ring(stat_ring);
+        stat_ring = NULL;
+    }
 
-        if (pthread_mutex_lock(&thread_pool->stack_mut) != 0) {
-            perror("pthread_mutex_lock failed");  
-            cleanup_path(new_subdir_task);  
-            return EXIT_FAILURE;
-        }
-        
-        push(thread_pool->stack, new_subdir_task);  // Push new subdir task
-
-        // Signal condition variable 
-        if (pthread_cond_signal(&thread_pool->cond) != 0) {
-            perror("pthread_cond_signal failed");
-            cleanup_path(new_subdir_task);
-            pthread_mutex_unlock(&thread_pool->stack_mut);  // Unlock mutex before returning
+    for (int i = 0; i < count; i++) {
+        if (results[i].error != 0) {
+            report_entry_error(current_path_task, names[i], results[i].error);
             return EXIT_FAILURE;
         }
+        *directory_size += results[i].blocks;
 
-        if (pthread_mutex_unlock(&thread_pool->stack_mut) != 0) {
-            perror("pthread_mutex_unlock failed");  // Handle mutex unlock error
+        // File systems without d_type report DT_UNKNOWN, and the stat tells
+        if (results[i].is_directory &&
+            queue_subdirectory(directory, names[i], true, current_path_task, thread_pool) != 0) {
             return EXIT_FAILURE;
         }
     }
@@ -104,6 +208,17 @@ int process_path_entry(char *full_path, int path_id, ThreadPool *thread_pool, lo
     return EXIT_SUCCESS;
 }
 
+void free_traversal_buffers(void) {
+    free(dirent_buffer);
+    dirent_buffer = NULL;
+    free_stat_ring(stat_ring);
+    stat_ring = NULL;
+    stat_ring_tried = false;
+    stat_time_ns = 0;
+    stat_entries = 0;
+    ring_batches = 0;
+}
+
 void update_directory_size(ThreadPool *thread_pool, Path *current_path_task, long directory_size) {
     // Lock mutex for thread-safe update
     if (pthread_mutex_lock(&thread_pool->dir_details->size_count_mut[current_path_task->path_id]) != 0) {
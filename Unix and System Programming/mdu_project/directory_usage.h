@@ -15,17 +15,50 @@
 #ifndef DIRECTORY_USAGE_H
 #define DIRECTORY_USAGE_H
 
+#include <fcntl.h>
+#include <time.h>
+#include <sys/syscall.h>
 #include "mdu.h"
 #include "paths.h"
 #include "threads.h"
-#include "stack.h"
+#include "deque.h"
+#include "stat_ring.h"
+
+#define DIRENT_BUFFER_SIZE (256 * 1024)  /**< Bytes of directory entries read by one getdents64 call. */
+#define STAT_RING_MIN_LATENCY_NS 100000  /**< Mean stat latency per entry from which on the stat ring is used. */
+#define STAT_RING_PROBE_INTERVAL 32      /**< On the stat ring, every this many batches are timed synchronously. */
+#define STAT_LATENCY_WINDOW 4096         /**< About the number of recent entries the mean stat latency covers. */
+
+/* ------------------------------- Structures --------------------------------------------------------------------------------------------------- */
+
+/**
+ * @struct Dirent64
+ * @brief A directory entry as the getdents64 system call returns it.
+ *
+ * The entries follow each other in the buffer, each `d_reclen` bytes long.
+ *
+ * @param d_ino Inode number.
+ * @param d_off Offset of the next entry in the directory.
+ * @param d_reclen Size of this entry.
+ * @param d_type File type, DT_DIR for a directory, DT_UNKNOWN if the file system does not tell.
+ * @param d_name Null-terminated name.
+ */
+typedef struct Dirent64 {
+    unsigned long long d_ino;   /**< Inode number. */
+    long long d_off;            /**< Offset of the next entry. */
+    unsigned short d_reclen;    /**< Size of this entry. */
+    unsigned char d_type;       /**< File type. */
+    char d_name[];              /**< Null-terminated name. */
+} Dirent64;
+
+/* ------------------------------- Function Prototypes ------------------------------------------------------------------------------------------------ */
 
 /**
  * @brief Calculates the disk usage of a specified path and its subdirectories.
  *
- * Determines if the path is a file or directory. For directories, recursively traverses
- * subdirectories and calculates disk usage. Adds the block count to the pool’s shared directory
- * size structure.
+ * Determines if the path is a file or directory. Directories are opened with `openat` relative to
+ * their parent's handle and traversed, and their subdirectories queued as new tasks. Adds the
+ * block count to the pool’s shared directory size structure.
  *
  * @param thread_pool Pointer to the ThreadPool structure managing tasks.
  * @param current_path_task Pointer to the current Path being processed.
@@ -34,32 +67,53 @@
 int calculate_directory_usage(ThreadPool *thread_pool, Path *current_path_task);
 
 /**
- * @brief Traverses a directory and enqueues subdirectories as tasks.
+ * @brief Traverses an open directory and enqueues subdirectories as tasks.
  *
- * Opens the specified directory, iterates over each entry, and processes it by either updating
- * the size (if it’s a file) or adding it to the thread pool’s task stack (if it’s a subdirectory).
+ * Reads the entries with the getdents64 system call into a buffer of DIRENT_BUFFER_SIZE bytes that
+ * each worker thread allocates once and reuses, so even directories with millions of entries take
+ * few calls. Entries the directory reports as DT_DIR are added to the calling worker’s deque right
+ * away: the task opens the subdirectory and counts its blocks with `fstat` on the new descriptor.
+ * The other entries are gathered in batches of up to STAT_RING_ENTRIES, at most one batch per read,
+ * and handed to `process_path_entries`.
  *
- * @param base_path Base directory path to traverse.
- * @param path_id Unique identifier of the path being processed.
+ * @param directory Handle of the open directory to traverse.
+ * @param current_path_task The task of the directory.
  * @param thread_pool Pointer to the ThreadPool structure managing tasks.
  * @param directory_size Pointer to a long integer where the directory size will be accumulated.
  * @return int Returns 0 on success, or non-zero on failure.
  */
-int traverse_directory(const char *base_path, int path_id, ThreadPool *thread_pool, long *directory_size);
+int traverse_directory(Dir_Handle *directory, Path *current_path_task, ThreadPool *thread_pool, long *directory_size);
 
 /**
- * @brief Processes an individual directory entry, updating size or enqueuing if it’s a subdirectory.
+ * @brief Stats a batch of directory entries, adding their sizes and enqueuing the subdirectories.
+ *
+ * The entries are stat'ed relative to the directory without following symbolic links. Each worker
+ * measures the mean time a synchronous `fstatat` takes over its last STAT_LATENCY_WINDOW or so
+ * entries. While it stays below STAT_RING_MIN_LATENCY_NS the entries are stat'ed one by one, since
+ * the inode cache answers them faster than io_uring can. Above it, as on cold caches and network
+ * file systems, the worker sets up a stat ring and submits the whole batch with one
+ * `io_uring_enter`, so the file system works on all of it at once. Every STAT_RING_PROBE_INTERVAL-th batch is still stat'ed synchronously to keep
+ * the average current. Without io_uring the entries are always stat'ed synchronously.
  *
- * This function is used by `traverse_directory` to handle each entry within a directory.
- * It updates the size if the entry is a file and enqueues a new task for subdirectories.
+ * Entries of type DT_UNKNOWN that turn out to be directories are queued as new tasks.
  *
- * @param full_path Full path of the directory entry being processed.
- * @param path_id Unique identifier of the path being processed.
+ * @param directory Handle of the directory containing the entries.
+ * @param names Names of the entries within the directory.
+ * @param count Number of entries, at most STAT_RING_ENTRIES.
+ * @param current_path_task The task of the directory.
  * @param thread_pool Pointer to the ThreadPool structure managing tasks.
- * @param directory_size Pointer to a long integer where the entry's size will be accumulated.
+ * @param directory_size Pointer to a long integer where the entries' sizes will be accumulated.
  * @return int Returns 0 on success, or non-zero on failure.
  */
-int process_path_entry(char *full_path, int path_id, ThreadPool *thread_pool, long *directory_size);
+int process_path_entries(Dir_Handle *directory, const char *const *names, int count, Path *current_path_task,
+                         ThreadPool *thread_pool, long *directory_size);
+
+/**
+ * @brief Frees the calling thread's buffer for directory entries and its stat ring.
+ *
+ * Each worker calls this before it exits.
+ */
+void free_traversal_buffers(void);
 
 /**
  * @brief Updates the total size for a directory in the thread pool.
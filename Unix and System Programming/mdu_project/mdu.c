@@ -28,9 +28,10 @@
  * Output       : Prints the size of each directory or file in 512-byte blocks.
  * 
  * Dependencies : 
- *               - `stack.h`, `stack.c`: Provides stack-based storage for managing directory paths as tasks.
+ *               - `deque.h`, `deque.c`: Provides the work-stealing deques holding directory paths as tasks.
  *               - `threads.h`, `threads.c`: Manages thread pool initialization, task dispatching, and synchronization.
  *               - `directory_usage.h`, `directory_usage.c`: Implements directory traversal and disk usage calculations.
+ *               - `stat_ring.h`, `stat_ring.c`: Stats batches of directory entries through io_uring.
  *               - `paths.h`, `paths.c`: Defines and manages path-related functions.
  * 
  * Usage        : 
@@ -7,8 +7,8 @@
  * improve performance. The user can specify the number of threads to use for traversing directories.
  * Disk usage of directories is recursively calculated, including any subdirectories and files within.
  * 
- * The main data structures used include a stack for task management, path information structures,
- * and a thread pool for handling multiple paths concurrently.
+ * The main data structures used include per-thread work-stealing deques for task management, path
+ * information structures, and a thread pool for handling multiple paths concurrently.
  * 
  * @section Author
  * - Author: Abdiaziz Ibrahim Adam
@@ -19,9 +19,10 @@
  * - mdu.c: Main implementation file for the program.
  * 
  * @section Dependencies Dependencies
- * - `stack.h`, `stack.c`: Provides stack-based storage for managing directory paths as tasks.
+ * - `deque.h`, `deque.c`: Provides the work-stealing deques holding directory paths as tasks.
  * - `threads.h`, `threads.c`: Manages thread pool initialization, task dispatching, and synchronization.
  * - `directory_usage.h`, `directory_usage.c`: Implements directory traversal and disk usage calculations.
+ * - `stat_ring.h`, `stat_ring.c`: Stats batches of directory entries through io_uring.
  * - `paths.h`, `paths.c`: Defines and manages path-related functions.
  * 
 */
@@ -38,23 +39,49 @@
 #include <sys/stat.h>
 #include <string.h>
 #include <errno.h>
-#include "stack.h"
+#include <stdatomic.h>
+#include "deque.h"
 
 /* ------------------------------- Structures --------------------------------------------------------------------------------------------------- */
 
+/**
+ * @struct Dir_Handle
+ * @brief An open directory shared by the tasks of its subdirectories.
+ *
+ * The task that reads a directory opens it once and keeps it as a handle. Entries are examined with
+ * `fstatat` and subdirectories opened with `openat` relative to the handle's descriptor, so the kernel
+ * never walks the full path again. Every queued subdirectory task holds a reference, and the
+ * directory is closed when the last reference is released.
+ *
+ * @param fd The descriptor of the directory, also used to read its entries.
+ * @param refs Number of tasks using the handle.
+ */
+typedef struct Dir_Handle {
+    int fd;            /**< Descriptor of the open directory. */
+    atomic_int refs;   /**< Number of references. */
+} Dir_Handle;
+
 /**
  * @struct Path
  * @brief Represents an individual path or directory for processing.
  *
  * This structure holds information about a single path (directory or file), including its name
- * and a unique identifier used for tracking.
+ * and a unique identifier used for tracking. The paths given by the user have no parent and are
+ * opened by name. Subdirectories found while traversing are opened relative to their parent's
+ * handle, using the last component of the path.
  *
- * @param path_name The name or path string of the directory or file.
+ * @param path_name The full path string of the directory or file, used in messages.
  * @param path_id Unique identifier associated with each path.
+ * @param parent Handle of the directory containing the path, or NULL for the paths given by the user.
+ * @param name_offset Offset of the name relative to `parent` in `path_name`.
+ * @param counted Whether the blocks of the directory itself have already been counted.
  */
 typedef struct Path {
-    char *path_name;  /**< Base path of the directory or file. */
+    char *path_name;  /**< Full path of the directory or file. */
     int path_id;      /**< Unique identifier for each path. */
+    Dir_Handle *parent; /**< Handle of the containing directory, or NULL. */
+    size_t name_offset; /**< Offset of the name relative to the parent. */
+    bool counted;     /**< The directory's own blocks are already counted. */
 } Path;
 
 /**
@@ -81,27 +108,34 @@ typedef struct Dir_details {
  * @struct ThreadPool
  * @brief Manages a pool of worker threads for parallel processing.
  *
- * This structure manages synchronization for multithreaded traversal, including the stack of tasks,
- * thread and path counts, exit code, and mutexes. A condition variable is used for coordinating
- * thread activity.
+ * Every worker thread owns a work-stealing deque of tasks. Workers push the subdirectories they find
+ * onto their own deque and pop from it without locking, and steal from the other deques when theirs
+ * runs empty. Workers that find nothing to steal sleep on a condition variable. `pending_tasks`
+ * counts the tasks that are queued or being processed, and the work is finished when it drops to 0.
  *
- * @param stack Stack used for managing paths to be processed.
+ * @param deques One deque per worker thread.
  * @param path_num Total number of paths to process.
  * @param num_threads Number of threads available in the pool.
  * @param exit_code Program's exit code.
- * @param stack_mut Mutex for synchronizing stack access.
+ * @param next_worker Index handed to the next worker thread that starts.
+ * @param pending_tasks Number of tasks queued or being processed.
+ * @param sleeping_threads Number of workers waiting on `idle_cond`.
  * @param exit_code_mut Mutex for controlling access to the exit code.
- * @param cond Condition variable for coordinating thread activity.
+ * @param idle_mut Mutex protecting the sleep and wake-up of idle workers.
+ * @param idle_cond Condition variable idle workers sleep on.
  * @param path_details Pointer to a `Dir_details` structure holding metadata for paths.
  */
 typedef struct ThreadPool {
-    Stack *stack;               /**< Stack of tasks for path processing. */
+    Deque **deques;             /**< One work-stealing deque per worker thread. */
     int path_num;               /**< Total number of paths. */
     int num_threads;            /**< Number of available threads. */
     int exit_code;              /**< Program's return code. */
-    pthread_mutex_t stack_mut;  /**< Mutex for stack access. */
+    atomic_int next_worker;     /**< Index of the next worker thread to start. */
+    atomic_long pending_tasks;  /**< Tasks queued or being processed. */
+    atomic_int sleeping_threads; /**< Workers waiting for work. */
     pthread_mutex_t exit_code_mut; /**< Mutex for return code access. */
-    pthread_cond_t cond;        /**< Condition variable for stack processing. */
+    pthread_mutex_t idle_mut;   /**< Mutex for idle workers. */
+    pthread_cond_t idle_cond;   /**< Condition variable idle workers wait on. */
     Dir_details *dir_details;  /**< Pointer to Dir_details structure. */
 } ThreadPool;
 
@@ -26,27 +26,20 @@ void initialize_paths(int path_num, char *argv[], ThreadPool *thread_pool) {
             continue;
         }
 
-        // Assign unique identifier and push task to the stack
+        // Assign unique identifier and submit the task
         if (give_path_identity(thread_pool, path_task->path_name, i) != EXIT_SUCCESS) {
             cleanup_path(path_task);  // Cleanup and continue on failure
             perror("Failed to assign path identity");
             continue;
         }
 
-        if (pthread_mutex_lock(&thread_pool->stack_mut) != 0) {
-            handle_error("pthread_mutex_lock");  // Exit if mutex lock fails
-        }
-        push(thread_pool->stack, (char *)path_task);
-        if (pthread_cond_signal(&thread_pool->cond) != 0) {
-            handle_error("pthread_cond_signal");  // Exit if signaling fails
-        }
-        if (pthread_mutex_unlock(&thread_pool->stack_mut) != 0) {
-            handle_error("pthread_mutex_unlock");  // Exit if mutex unlock fails
+        if (submit_task(thread_pool, path_task) != 0) {
+            handle_error("Failed to queue path task");  // Exit if the task could not be queued
         }
     }
 
     // If no paths are available to process, clean up and exit
-    if (is_empty(thread_pool->stack)) {
+    if (atomic_load(&thread_pool->pending_tasks) == 0) {
         cleanup_ThreadPool(thread_pool);
         handle_error("No valid paths to process");
     }
@@ -72,10 +65,65 @@ Path *create_path(char *path_name, int path_id) {
     // Assign fields to the path_task structure
     path_task->path_name = new_path;
     path_task->path_id = path_id;
+    path_task->parent = NULL;
+    path_task->name_offset = 0;
+    path_task->counted = false;
 
     return path_task;
 }
 
+// Creates the task of a subdirectory, opened later relative to its parent's handle
+Path *create_subdir_path(Path *parent_task, Dir_Handle *parent, const char *name, bool counted) {
+    Path *path_task = calloc(1, sizeof(Path));
+    if (path_task == NULL) {
+        perror("Failed to allocate memory for Path");
+        return NULL;
+    }
+
+    // The full path is only built once per subdirectory, and only read in messages
+    path_task->path_name = concatenate_dir_path(parent_task->path_name, name);
+    if (path_task->path_name == NULL) {
+        free(path_task);
+        return NULL;
+    }
+    path_task->path_id = parent_task->path_id;
+    path_task->name_offset = strlen(path_task->path_name) - strlen(name);
+    path_task->counted = counted;
+
+    acquire_dir_handle(parent);
+    path_task->parent = parent;
+
+    return path_task;
+}
+
+// Wraps an open directory descriptor in a handle with one reference
+Dir_Handle *open_dir_handle(int fd) {
+    Dir_Handle *handle = malloc(sizeof(Dir_Handle));
+    if (handle == NULL) {
+        perror("Failed to allocate memory for directory handle");
+        close(fd);
+        return NULL;
+    }
+
+    handle->fd = fd;
+    atomic_init(&handle->refs, 1);
+
+    return handle;
+}
+
+// Adds a reference to a directory handle
+void acquire_dir_handle(Dir_Handle *handle) {
+    atomic_fetch_add_explicit(&handle->refs, 1, memory_order_relaxed);
+}
+
+// Drops a reference, closing the directory with the last one
+void release_dir_handle(Dir_Handle *handle) {
+    if (atomic_fetch_sub_explicit(&handle->refs, 1, memory_order_acq_rel) == 1) {
+        close(handle->fd);
+        free(handle);
+    }
+}
+
 // Assigns a unique identity to each path
 int give_path_identity(ThreadPool *Pool, char *path_name, int path_id) {
     char *new_id;
@@ -113,6 +161,9 @@ char *concatenate_dir_path(const char *base_path, const char *filename) {
 
 // Cleans up memory allocated for a Path structure
 void cleanup_path(Path *path_task) {
+    if (path_task->parent != NULL) {
+        release_dir_handle(path_task->parent);
+    }
     free(path_task->path_name);
     free(path_task);
 }
@@ -29,11 +29,11 @@
 /* ------------------------------- Function Prototypes ------------------------------------------------------------------------------------------------ */
 
 /**
- * @brief Initializes the path tasks for processing and pushes them to the task stack.
+ * @brief Initializes the path tasks for processing and submits them to the thread pool.
  *
  * This function prepares each specified path by creating a corresponding `Path` structure
- * and assigning a unique identifier. Each path task is then added to the stack in the 
- * thread pool for processing.
+ * and assigning a unique identifier. Each path task is then submitted with `submit_task`,
+ * which deals them out over the workers' deques before the workers start.
  *
  * @param path_num The number of paths specified by the user.
  * @param argv Argument vector containing paths to process.
@@ -55,6 +55,47 @@ void initialize_paths(int path_num, char *argv[], ThreadPool *thread_pool);
  */
 Path *create_path(char *path_name, int path_id);
 
+/**
+ * @brief Creates the task of a subdirectory found while traversing its parent.
+ *
+ * The task takes a reference to the parent's handle and is later opened relative to it. Its full
+ * path is built from the parent task's path and the name, and is only used in messages.
+ *
+ * @param parent_task The task of the directory being traversed.
+ * @param parent Handle of the directory being traversed.
+ * @param name Name of the subdirectory within the parent.
+ * @param counted True if the parent already counted the subdirectory's own blocks.
+ * @return Path* Pointer to the new `Path` structure, or NULL on failure.
+ *
+ * @note The caller is responsible for freeing the memory by calling `cleanup_path`.
+ */
+Path *create_subdir_path(Path *parent_task, Dir_Handle *parent, const char *name, bool counted);
+
+/**
+ * @brief Wraps an open directory descriptor in a handle with one reference.
+ *
+ * @param fd Descriptor of a directory opened for reading. The handle takes it over, and it is
+ *           closed on failure and with the last reference.
+ * @return Dir_Handle* The handle, or NULL on failure.
+ *
+ * @note The reference is dropped with `release_dir_handle`.
+ */
+Dir_Handle *open_dir_handle(int fd);
+
+/**
+ * @brief Adds a reference to a directory handle.
+ *
+ * @param handle The handle.
+ */
+void acquire_dir_handle(Dir_Handle *handle);
+
+/**
+ * @brief Drops a reference to a directory handle, closing the directory with the last one.
+ *
+ * @param handle The handle.
+ */
+void release_dir_handle(Dir_Handle *handle);
+
 /**
  * @brief Assigns a unique identity to each path within the thread pool.
  *
@@ -72,7 +113,8 @@ int give_path_identity(ThreadPool *data, char *path_name, int path_id);
  * @brief Concatenates a base path with a specified filename.
  *
  * Constructs a new path by combining a base directory path with a filename, ensuring correct path 
- * separators. This function is used to build full paths during recursive traversal.
+ * separators. This function is used to build the full paths of subdirectories and of entries in
+ * error messages.
  *
  * @param base_path Base directory path.
  * @param filename Filename to append to the base path.
@@ -85,8 +127,9 @@ char *concatenate_dir_path(const char *base_path, const char *filename);
 /**
  * @brief Releases memory associated with a `Path` structure.
  *
- * Frees the memory allocated for the path name and the `Path` structure itself. This function 
- * should be called when a path task is no longer needed.
+ * Frees the memory allocated for the path name and the `Path` structure itself, and releases the
+ * task's reference to its parent's handle. This function should be called when a path task is no
+ * longer needed.
  *
  * @param path_task Pointer to the `Path` structure to free.
  */
@@ -0,0 +1,214 @@
+/*
+ * Module       : stat_ring.c
+ * Description  : This module submits batches of statx calls through io_uring, using the raw system
+ *                calls, or stats them one by one. Entries the ring cannot handle are stat'ed
+ *                synchronously, so every batch yields a result for every entry.
+ *
+ * Dependencies : Requires `stat_ring.h` and the kernel's `linux/io_uring.h`.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include "stat_ring.h"
+
+/* ------------------------------- Helper Functions ------------------------------------------------------------------------------------------------ */
+
+static int io_uring_setup(unsigned entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+// Stats one entry the blocking way, for entries the ring could not take
+static void stat_entry(int dirfd, const char *name, Stat_Result *result) {
+    struct stat s;
+    if (fstatat(dirfd, name, &s, AT_SYMLINK_NOFOLLOW) < 0) {
+        result->error = errno;
+        return;
+    }
+    result->blocks = s.st_blocks;
+    result->is_directory = S_ISDIR(s.st_mode);
+    result->error = 0;
+}
+
+// Takes the completions off the queue, returns how many there were
+static int reap_completions(Stat_Ring *ring, int dirfd, const char *const *names, Stat_Result *results) {
+    unsigned head = *ring->cq_head;
+    unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    int reaped = 0;
+
+    while (head != tail) {
+        struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+        int i = (int)cqe->user_data;
+        Stat_Result *result = &results[i];
+
+        if (cqe->res == -EINVAL) {
+            // Kernels before 5.6 know io_uring but not IORING_OP_STATX
+            stat_entry(dirfd, names[i], result);
+        } else if (cqe->res < 0) {
+            result->error = -cqe->res;
+        } else {
+            result->blocks = (long)ring->buffers[i].stx_blocks;
+            result->is_directory = S_ISDIR(ring->buffers[i].stx_mode);
+            result->error = 0;
+        }
+        head++;
+        reaped++;
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    return reaped;
+}
+
+/* ------------------------------- Function Implementations ------------------------------------------------------------------------------------------------ */
+
+Stat_Ring *create_stat_ring(void) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int ring_fd = io_uring_setup(STAT_RING_ENTRIES, &params);
+    if (ring_fd < 0) {
+        return NULL;  // No io_uring, the caller stats synchronously
+    }
+
+    Stat_Ring *ring = calloc(1, sizeof(Stat_Ring));
+    struct statx *buffers = calloc(STAT_RING_ENTRIES, sizeof(struct statx));
+    if (ring == NULL || buffers == NULL) {
+        perror("Failed to allocate memory for stat ring");
+        free(ring);
+        free(buffers);
+        close(ring_fd);
+        return NULL;
+    }
+    ring->ring_fd = ring_fd;
+    ring->buffers = buffers;
+    ring->sq_ring = MAP_FAILED;
+    ring->cq_ring = MAP_FAILED;
+    ring->sqes = MAP_FAILED;
+
+    // Newer kernels map both rings with one mmap
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap && ring->cq_ring_size > ring->sq_ring_size) {
+        ring->sq_ring_size = ring->cq_ring_size;
+    }
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         ring_fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring != MAP_FAILED) {
+        ring->cq_ring = single_mmap ? ring->sq_ring
+                                    : mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                                           MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        ring->sqes = mmap(NULL, params.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    }
+    if (ring->sq_ring == MAP_FAILED || ring->cq_ring == MAP_FAILED || ring->sqes == MAP_FAILED) {
+        free_stat_ring(ring);
+        return NULL;
+    }
+
+    char *sq = ring->sq_ring;
+    char *cq = ring->cq_ring;
+    ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    return ring;
+}
+
+int stat_batch(Stat_Ring *ring, int dirfd, const char *const *names, int count, Stat_Result *results) {
+    unsigned tail = *ring->sq_tail;
+
+    // Queue one statx per name, its index as user data
+    for (int i = 0; i < count; i++) {
+        unsigned index = (tail + i) & *ring->sq_mask;
+        struct io_uring_sqe *sqe = &ring->sqes[index];
+
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_STATX;
+        sqe->fd = dirfd;
+        sqe->addr = (unsigned long)names[i];
+        sqe->len = STATX_TYPE | STATX_BLOCKS;
+        sqe->off = (unsigned long)&ring->buffers[i];
+        sqe->statx_flags = AT_SYMLINK_NOFOLLOW;
+        sqe->user_data = (unsigned)i;
+        ring->sq_array[index] = index;
+    }
+    __atomic_store_n(ring->sq_tail, tail + count, __ATOMIC_RELEASE);
+
+    // Submit the batch and wait for all of it with as few calls as the kernel allows
+    int submitted = 0;
+    int completed = 0;
+    bool broken = false;
+    while (submitted < count) {
+        int result = io_uring_enter(ring->ring_fd, count - submitted, count - submitted, IORING_ENTER_GETEVENTS);
+        if (result < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            // The kernel took the first entries in order, take the rest back and stat them here
+            __atomic_store_n(ring->sq_tail, tail + submitted, __ATOMIC_RELEASE);
+            for (int i = submitted; i < count; i++) {
+                stat_entry(dirfd, names[i], &results[i]);
+            }
+            count = submitted;
+            broken = true;
+            break;
+        }
+        submitted += result;
+    }
+
+    completed += reap_completions(ring, dirfd, names, results);
+    while (completed < count) {
+        if (io_uring_enter(ring->ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR && errno != EAGAIN) {
+            // The statx buffers are still in use by the kernel, so there is no way back
+            perror("io_uring_enter failed");
+            exit(EXIT_FAILURE);
+        }
+        completed += reap_completions(ring, dirfd, names, results);
+    }
+
+    return broken ? -1 : 0;
+}
+
+void stat_batch_sync(int dirfd, const char *const *names, int count, Stat_Result *results) {
+    for (int i = 0; i < count; i++) {
+        stat_entry(dirfd, names[i], &results[i]);
+    }
+}
+
+void free_stat_ring(Stat_Ring *ring) {
+    if (ring == NULL) {
+        return;
+    }
+    if (ring->sqes != MAP_FAILED) {
+        munmap(ring->sqes, STAT_RING_ENTRIES * sizeof(struct io_uring_sqe));
+    }
+    if (ring->cq_ring != MAP_FAILED && ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring != MAP_FAILED) {
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+    close(ring->ring_fd);
+    free(ring->buffers);
+    free(ring);
+}
+
+/* --------------------------------------------------------------------------------------------------------------------------------------------------------------------------- */
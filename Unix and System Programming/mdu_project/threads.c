@@ -1,29 +1,117 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <sched.h>
+#include <sys/resource.h>
 #include "threads.h"
 
+#define STEAL_ROUNDS 4   // Rounds of stealing an idle worker tries before it sleeps
+
+/* ------------------------------- Helper Functions ------------------------------------------------------------------------------------------------ */
+
+// Index of the deque owned by the calling thread, -1 for threads that are not workers
+static _Thread_local int current_worker = -1;
+
+// Checks every deque for tasks
+static bool work_available(ThreadPool *thread_pool) {
+    for (int i = 0; i < thread_pool->num_threads; i++) {
+        if (deque_has_work(thread_pool->deques[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Tries to steal a task from the other workers, starting with the next one
+static Path *steal_task(ThreadPool *thread_pool) {
+    for (int i = 1; i < thread_pool->num_threads; i++) {
+        int victim = (current_worker + i) % thread_pool->num_threads;
+        Path *task = steal_top(thread_pool->deques[victim]);
+        if (task != NULL) {
+            return task;
+        }
+    }
+    return NULL;
+}
+
+// Sleeps until a task is submitted or all work is done, unless there already is work
+static void wait_for_work(ThreadPool *thread_pool) {
+    if (pthread_mutex_lock(&thread_pool->idle_mut) != 0) {
+        handle_error("pthread_mutex_lock failed");
+    }
+    atomic_fetch_add(&thread_pool->sleeping_threads, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if (atomic_load(&thread_pool->pending_tasks) > 0 && !work_available(thread_pool)) {
+        if (pthread_cond_wait(&thread_pool->idle_cond, &thread_pool->idle_mut) != 0) {
+            handle_error("pthread_cond_wait failed");
+        }
+    }
+
+    atomic_fetch_sub(&thread_pool->sleeping_threads, 1);
+    if (pthread_mutex_unlock(&thread_pool->idle_mut) != 0) {
+        handle_error("pthread_mutex_unlock failed");
+    }
+}
+
+// Returns the next task for the calling worker: its own newest task, or a stolen one. NULL when all work is done.
+static Path *find_task(ThreadPool *thread_pool) {
+    while (true) {
+        Path *task = pop_bottom(thread_pool->deques[current_worker]);
+        if (task != NULL) {
+            return task;
+        }
+
+        // Steal a few rounds before going to sleep, since new subdirectories tend to turn up soon
+        for (int round = 0; round < STEAL_ROUNDS; round++) {
+            task = steal_task(thread_pool);
+            if (task != NULL) {
+                return task;
+            }
+            if (atomic_load(&thread_pool->pending_tasks) == 0) {
+                return NULL;
+            }
+            sched_yield();
+        }
+        wait_for_work(thread_pool);
+    }
+}
+
+// Directory handles stay open while their subdirectories are queued, so allow as many descriptors as permitted
+static void raise_file_limit(void) {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
 /* ------------------------------- Function Implementations ------------------------------------------------------------------------------------------------ */
 
 ThreadPool *init_ThreadPool(int path_num, int num_threads) {
-    Stack *stack = create_stack();
-    if (stack == NULL) {
-        handle_error("Failed to create stack");  // Exit if stack creation fails
+    raise_file_limit();
+
+    Deque **deques = calloc(num_threads, sizeof(Deque *));
+    if (deques == NULL) {
+        handle_error("Failed to allocate memory for deques");  // Exit if allocation fails
+    }
+    for (int i = 0; i < num_threads; i++) {
+        deques[i] = create_deque();
+        if (deques[i] == NULL) {
+            handle_error("Failed to create deque");  // Exit if deque creation fails
+        }
     }
 
     // Allocate memory for the ThreadPool structure
     ThreadPool *thread_pool = calloc(1, sizeof(ThreadPool));
     if (thread_pool == NULL) {
         handle_error("Failed to allocate memory for ThreadPool");  // Exit on memory allocation failure
-        free_stack(stack);
     }
 
     // Allocate memory for the Dir_details structure within the pool
     Dir_details *dir_details = calloc(1, sizeof(Dir_details));
     if (dir_details == NULL) {
         handle_error("Failed to allocate memory for Dir_details");
-        free_stack(stack);
-        free(thread_pool);
     }
 
     // Allocate memory for dir_size, path_identity, and size_count_mut arrays
@@ -33,25 +121,22 @@ ThreadPool *init_ThreadPool(int path_num, int num_threads) {
 
     if (!dir_details->dir_size || !dir_details->path_identity || !dir_details->size_count_mut) {
         handle_error("Failed to allocate memory for Dir_details fields");
-        free(dir_details->dir_size);
-        free(dir_details->path_identity);
-        free(dir_details->size_count_mut);
-        free(dir_details);
-        free_stack(stack);
-        free(thread_pool);
     }
 
     // Initialize ThreadPool fields
-    thread_pool->stack = stack;
+    thread_pool->deques = deques;
     thread_pool->dir_details = dir_details;
     thread_pool->path_num = path_num;
     thread_pool->num_threads = num_threads;
     thread_pool->exit_code = EXIT_SUCCESS;
+    atomic_init(&thread_pool->next_worker, 0);
+    atomic_init(&thread_pool->pending_tasks, 0);
+    atomic_init(&thread_pool->sleeping_threads, 0);
 
     // Initialize mutexes and condition variables in the ThreadPool
-    if (pthread_mutex_init(&thread_pool->stack_mut, NULL) != 0 ||
-        pthread_mutex_init(&thread_pool->exit_code_mut, NULL) != 0 ||
-        pthread_cond_init(&thread_pool->cond, NULL) != 0) {
+    if (pthread_mutex_init(&thread_pool->exit_code_mut, NULL) != 0 ||
+        pthread_mutex_init(&thread_pool->idle_mut, NULL) != 0 ||
+        pthread_cond_init(&thread_pool->idle_cond, NULL) != 0) {
         handle_error("Failed to initialize thread pool synchronization primitives");
     }
 
@@ -65,6 +150,37 @@ ThreadPool *init_ThreadPool(int path_num, int num_threads) {
     return thread_pool;
 }
 
+// Queues a task on the calling worker's deque and wakes a sleeping worker to steal it
+int submit_task(ThreadPool *thread_pool, Path *task) {
+    // Before the workers start, the tasks are dealt out over all deques
+    int index = current_worker;
+    if (index < 0) {
+        index = (int)(atomic_load(&thread_pool->pending_tasks) % thread_pool->num_threads);
+    }
+
+    // Counted before it is visible, so the count cannot reach 0 while the task is queued
+    atomic_fetch_add(&thread_pool->pending_tasks, 1);
+    if (!push_bottom(thread_pool->deques[index], task)) {
+        atomic_fetch_sub(&thread_pool->pending_tasks, 1);
+        return EXIT_FAILURE;
+    }
+
+    // Pairs with the fence in wait_for_work: either the sleeper sees the task or we see the sleeper
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(&thread_pool->sleeping_threads) > 0) {
+        if (pthread_mutex_lock(&thread_pool->idle_mut) != 0) {
+            handle_error("pthread_mutex_lock failed");
+        }
+        if (pthread_cond_signal(&thread_pool->idle_cond) != 0) {
+            handle_error("pthread_cond_signal failed");
+        }
+        if (pthread_mutex_unlock(&thread_pool->idle_mut) != 0) {
+            handle_error("pthread_mutex_unlock failed");
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
 // Initializes and dispatches threads in the thread pool
 void initialize_dispatch_threads(int num_threads, pthread_t **thread_id, ThreadPool *thread_pool) {
     *thread_id = calloc(num_threads - 1, sizeof(pthread_t));
@@ -88,65 +204,37 @@ void initialize_dispatch_threads(int num_threads, pthread_t **thread_id, ThreadP
 // Worker function for each thread in the pool
 void *thread_worker(void *args) {
     ThreadPool *thread_pool = (ThreadPool *)args;
+    current_worker = atomic_fetch_add(&thread_pool->next_worker, 1);
 
-    static int waiting_threads_count = 0;
-    static bool work_finished = false;
-    static bool error_occurred = false;
-
-    if (pthread_mutex_lock(&thread_pool->stack_mut) != 0) {
-        handle_error("pthread_mutex_lock failed");
-    }
-
-    while (!work_finished) {
-        if (is_empty(thread_pool->stack)) {
-            waiting_threads_count++;
-            if (waiting_threads_count == thread_pool->num_threads) {
-                work_finished = true;
-                if (pthread_cond_broadcast(&thread_pool->cond) != 0) {
-                    handle_error("pthread_cond_broadcast failed");
-                }
-                if (pthread_mutex_unlock(&thread_pool->stack_mut) != 0) {
-                    handle_error("pthread_mutex_unlock failed");
-                }
-                break;
-            }
-
-            if (pthread_cond_wait(&thread_pool->cond, &thread_pool->stack_mut) != 0) {
-                handle_error("pthread_cond_wait failed");
-            }
-            waiting_threads_count--;
-
-            if (work_finished) {
-                if (pthread_mutex_unlock(&thread_pool->stack_mut) != 0) {
-                    handle_error("pthread_mutex_unlock failed");
-                }
-                break;
+    Path *current_task;
+    while ((current_task = find_task(thread_pool)) != NULL) {
+        if (calculate_directory_usage(thread_pool, current_task)) {
+            if (pthread_mutex_lock(&thread_pool->exit_code_mut) != 0) {
+                handle_error("pthread_mutex_lock failed");
             }
-        }
-        if (!is_empty(thread_pool->stack)) {
-            Path *current_task = (Path *)pop(thread_pool->stack);
-            if (pthread_mutex_unlock(&thread_pool->stack_mut) != 0) {
+            thread_pool->exit_code = EXIT_FAILURE;
+            if (pthread_mutex_unlock(&thread_pool->exit_code_mut) != 0) {
                 handle_error("pthread_mutex_unlock failed");
             }
+        }
 
-            if (calculate_directory_usage(thread_pool, current_task) && !error_occurred) {
-                if (pthread_mutex_lock(&thread_pool->exit_code_mut) != 0) {
-                    handle_error("pthread_mutex_lock failed");
-                }
-                error_occurred = true;
-                thread_pool->exit_code = EXIT_FAILURE;
-                if (pthread_mutex_unlock(&thread_pool->exit_code_mut) != 0) {
-                    handle_error("pthread_mutex_unlock failed");
-                }
-            }
-
-            cleanup_path(current_task);
+        cleanup_path(current_task);
 
-            if (pthread_mutex_lock(&thread_pool->stack_mut) != 0) {
+        // The last task is done, wake everyone so they can exit
+        if (atomic_fetch_sub(&thread_pool->pending_tasks, 1) == 1) {
+            if (pthread_mutex_lock(&thread_pool->idle_mut) != 0) {
                 handle_error("pthread_mutex_lock failed");
             }
+            if (pthread_cond_broadcast(&thread_pool->idle_cond) != 0) {
+                handle_error("pthread_cond_broadcast failed");
+            }
+            if (pthread_mutex_unlock(&thread_pool->idle_mut) != 0) {
+                handle_error("pthread_mutex_unlock failed");
+            }
         }
     }
+
+    free_traversal_buffers();
     return NULL;
 }
 
@@ -169,16 +257,19 @@ void cleanup_ThreadPool(ThreadPool *Pool) {
     }
     free(Pool->dir_details->path_identity);
 
-    while (!is_empty(Pool->stack)) {
-        Path *t = pop(Pool->stack);
-        cleanup_path(t);
+    for (int i = 0; i < Pool->num_threads; i++) {
+        Path *t;
+        while ((t = steal_top(Pool->deques[i])) != NULL) {
+            cleanup_path(t);
+        }
+        free_deque(Pool->deques[i]);
     }
-    free_stack(Pool->stack);
+    free(Pool->deques);
 
-    if (pthread_cond_destroy(&Pool->cond) != 0) {
+    if (pthread_cond_destroy(&Pool->idle_cond) != 0) {
         handle_error("pthread_cond_destroy failed");
     }
-    if (pthread_mutex_destroy(&Pool->stack_mut) != 0) {
+    if (pthread_mutex_destroy(&Pool->idle_mut) != 0) {
         handle_error("pthread_mutex_destroy failed");
     }
     if (pthread_mutex_destroy(&Pool->exit_code_mut) != 0) {
@@ -34,8 +34,8 @@
  * @brief Initializes the ThreadPool structure, setting up paths and threading components.
  *
  * Allocates memory for the `ThreadPool` and its components, including mutexes, condition variables,
- * and the stack for task management. The thread pool is essential for handling concurrent 
- * directory traversal.
+ * and one work-stealing deque per thread for task management. The thread pool is essential for
+ * handling concurrent directory traversal.
  *
  * @param num_paths Number of paths to process.
  * @param num_threads Number of threads to initialize in the pool.
@@ -47,10 +47,25 @@
 ThreadPool *init_ThreadPool(int num_paths, int num_threads);
 
 /**
- * @brief Dispatches threads in the pool to start processing tasks from the stack.
+ * @brief Queues a path task for processing.
+ *
+ * Called by a worker, the task goes onto the worker's own deque, where it is popped next unless an
+ * idle worker steals it first, and a sleeping worker is woken. Called before the workers start, the
+ * tasks are dealt out over the deques in turn.
+ *
+ * @param thread_pool Pointer to the ThreadPool.
+ * @param task The task. The pool takes ownership of it on success.
+ * @return int Returns 0 on success, or non-zero if the deque could not grow.
+ *
+ * @warning Threads other than the workers may only submit tasks before `initialize_dispatch_threads`.
+ */
+int submit_task(ThreadPool *thread_pool, Path *task);
+
+/**
+ * @brief Dispatches threads in the pool to start processing tasks from the deques.
  *
  * This function creates the specified number of threads and assigns them to process tasks
- * in the stack concurrently. The threads work until all paths are processed or an error occurs.
+ * from the deques concurrently. The threads work until all paths are processed or an error occurs.
  *
  * @param num_threads Number of threads to launch.
  * @param thread_id A pointer to an array that stores thread identifiers.
@@ -64,9 +79,9 @@ void initialize_dispatch_threads(int num_threads, pthread_t **thread_id, ThreadP
 /**
  * @brief Function executed by each worker thread in the pool.
  *
- * Each thread repeatedly pulls tasks from the stack and processes paths, handling files
- * and directories until no tasks remain. It synchronizes access to shared resources
- * and exits when processing is complete.
+ * Each thread takes an index and the deque with it, then repeatedly pops tasks from its own deque
+ * and processes paths, handling files and directories. When its deque is empty it steals from the
+ * others, and sleeps when there is nothing to steal. It exits when no tasks remain anywhere.
  *
  * @param args A pointer to the ThreadPool managing the thread’s tasks.
  * @return void* Returns NULL upon completion.
@@ -89,7 +104,7 @@ void join_threads(int num_threads, pthread_t *thread_id);
  * @brief Cleans up the ThreadPool, freeing allocated memory and resources.
  *
  * Deallocates memory for the `ThreadPool` structure and its components, including
- * mutexes, condition variables, and stack resources. This function should be called 
+ * mutexes, condition variables, and the deques with any tasks left in them. This function should be called 
  * once all threads have completed processing.
  *
  * @param Pool Pointer to the ThreadPool to be cleaned up.